@@ -0,0 +1,239 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "mesh_cache.h"
+#include "model.h"
+#include "text_renderer.h"
+#include "texture_loading.h"
+
+namespace fs = std::filesystem;
+
+// returns the files below a directory with one of the extensions, sorted so the order is the same on every run
+static std::vector<fs::path> findFiles(const std::string &directory, const std::vector<std::string> &extensions)
+{
+    std::vector<fs::path> files;
+    if (!fs::exists(directory))
+    {
+        return files;
+    }
+    for (const auto &entry : fs::recursive_directory_iterator(directory))
+    {
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (entry.is_regular_file() && std::find(extensions.begin(), extensions.end(), extension) != extensions.end())
+        {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// creates an invisible window, so the benchmarks have an OpenGL context without showing anything
+static GLFWwindow *createHiddenWindow()
+{
+    if (!glfwInit())
+    {
+        std::cout << "ERROR::BENCH::Failed to initialize GLFW" << std::endl;
+        return nullptr;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    GLFWwindow *window = glfwCreateWindow(1280, 720, "drone-bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "ERROR::BENCH::Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return nullptr;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "ERROR::BENCH::Failed to initialize GLAD" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return nullptr;
+    }
+    return window;
+}
+
+static void benchmarkModelImport(BenchmarkReport &report, bool quick)
+{
+    bool import = report.enabled("model/import");
+    bool cached = report.enabled("model/cached");
+    if (!import && !cached)
+    {
+        return;
+    }
+
+    // Every model is only loaded a few times (the big ones take seconds through Assimp).
+    // The first load imports with Assimp (its mesh cache is deleted first) and writes the cache, the others map it.
+    const int runs = quick ? 1 : 3;
+    for (const fs::path &file : findFiles("resources/models", {".obj", ".fbx", ".dae"}))
+    {
+        fs::remove(file.generic_string() + MeshCache::EXTENSION);
+        double importSeconds;
+        std::string meshCount;
+        {
+            // destroyed before the cached runs, otherwise they would find its textures in the resource registry
+            auto start = std::chrono::steady_clock::now();
+            Model imported(file.generic_string(), false);
+            glFinish();
+            importSeconds = secondsSince(start);
+            meshCount = std::to_string(imported.meshes.size());
+        }
+        if (import)
+        {
+            report.add({"model/import", "ms", importSeconds * 1000.0, 1, {{"file", file.generic_string()}, {"meshes", meshCount}}});
+        }
+        if (!cached)
+        {
+            continue;
+        }
+
+        double total = 0.0;
+        for (int run = 0; run < runs; run++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            Model model(file.generic_string(), false);
+            glFinish();
+            total += secondsSince(start);
+        }
+        report.add({"model/cached", "ms", total * 1000.0 / runs, runs, {{"file", file.generic_string()}, {"meshes", meshCount}}});
+    }
+}
+
+static void benchmarkTextures(BenchmarkReport &report, bool quick)
+{
+    bool decode = report.enabled("texture/decode");
+    bool upload = report.enabled("texture/from_file");
+    if (!decode && !upload)
+    {
+        return;
+    }
+
+    std::vector<fs::path> files = findFiles("resources", {".png", ".jpg", ".jpeg"});
+    if (quick && files.size() > 8)
+    {
+        files.resize(8);
+    }
+    const int runs = quick ? 1 : 3;
+    for (const fs::path &file : files)
+    {
+        std::string path = file.generic_string();
+        int width = 0, height = 0, nrComponents = 0;
+
+        if (decode)
+        {
+            // decoding only (stb_image), no OpenGL
+            stbi_set_flip_vertically_on_load(false);
+            auto start = std::chrono::steady_clock::now();
+            for (int run = 0; run < runs; run++)
+            {
+                unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrComponents, 0);
+                stbi_image_free(data);
+            }
+            report.add({"texture/decode", "ms", secondsSince(start) * 1000.0 / runs, runs,
+                        {{"file", path}, {"size", std::to_string(width) + "x" + std::to_string(height)}}});
+        }
+
+        if (upload)
+        {
+            // what the game does: decode, upload and generate mipmaps
+            auto start = std::chrono::steady_clock::now();
+            for (int run = 0; run < runs; run++)
+            {
+                unsigned int texture = TextureFromFile(file.filename().generic_string().c_str(), file.parent_path().generic_string(), false);
+                glFinish();
+                glDeleteTextures(1, &texture);
+            }
+            report.add({"texture/from_file", "ms", secondsSince(start) * 1000.0 / runs, runs, {{"file", path}}});
+        }
+    }
+}
+
+static void benchmarkText(BenchmarkReport &report, bool quick)
+{
+    bool layout = report.enabled("text/measure");
+    bool render = report.enabled("text/render");
+    bool bordered = report.enabled("text/render_bordered");
+    if (!layout && !render && !bordered)
+    {
+        return;
+    }
+
+    TextRenderer tr("resources/font/theboldfont.ttf", "shaders/text.vert", "shaders/text.frag");
+    tr.projection = glm::ortho(0.0f, 1280.0f, 0.0f, 720.0f);
+    const std::string line = "KILLS: 1234   HEALTH: 100   PRESS ENTER TO START";
+    const double chars = static_cast<double>(line.size());
+    double minSeconds = quick ? 0.1 : 0.5;
+    long long iterations;
+    volatile float sink = 0.0f; // keeps the compiler from dropping the layout
+
+    if (layout)
+    {
+        double seconds = timePerCall([&]()
+                                     { sink = sink + tr.MeasureText(line, 1.0f); },
+                                     minSeconds, iterations);
+        report.add({"text/measure", "ns/char", seconds * 1e9 / chars, iterations, {{"chars", std::to_string(line.size())}}});
+    }
+
+    // a line is added to the batch and drawn (Flush), including the time the GPU needs (glFinish)
+    if (render)
+    {
+        double seconds = timePerCall([&]()
+                                     {
+                                         tr.RenderText(line, 20.0f, 20.0f, 1.0f, glm::vec3(1.0f));
+                                         tr.Flush();
+                                         glFinish(); },
+                                     minSeconds, iterations);
+        report.add({"text/render", "us/line", seconds * 1e6, iterations, {{"chars", std::to_string(line.size())}}});
+    }
+    if (bordered)
+    {
+        double seconds = timePerCall([&]()
+                                     {
+                                         tr.RenderTextBordered(line, 20.0f, 20.0f, 1.0f, glm::vec3(1.0f), glm::vec3(0.0f));
+                                         tr.Flush();
+                                         glFinish(); },
+                                     minSeconds, iterations);
+        report.add({"text/render_bordered", "us/line", seconds * 1e6, iterations, {{"chars", std::to_string(line.size())}}});
+    }
+}
+
+void runGraphicsBenchmarks(BenchmarkReport &report, bool quick)
+{
+    // only create a window if at least one of the benchmarks below is selected
+    const std::vector<std::string> names = {"model/import", "model/cached", "texture/decode", "texture/from_file",
+                                            "text/measure", "text/render", "text/render_bordered"};
+    if (std::none_of(names.begin(), names.end(), [&](const std::string &name)
+                     { return report.enabled(name); }))
+    {
+        return;
+    }
+
+    GLFWwindow *window = createHiddenWindow();
+    if (window == nullptr)
+    {
+        return;
+    }
+
+    benchmarkModelImport(report, quick);
+    benchmarkTextures(report, quick);
+    benchmarkText(report, quick);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
@@ -0,0 +1,165 @@
+#include "benchmark.h"
+
+#include <random>
+#include <thread>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "box.h"
+#include "frustum_culling.h"
+#include "job_system.h"
+#include "ray_batch.h"
+#include "ray_scene.h"
+#include "simulation.h"
+#include "world_layout.h"
+
+static void benchmarkBoxIntersect(BenchmarkReport &report, bool quick)
+{
+    const int boxCount = 4096;
+    const int rayCount = 64;
+    const float length = 40.0f;
+    std::vector<AABBox> boxes;
+    std::vector<float> bounds;
+    std::vector<Ray> rays;
+    createBoxesAndRays(boxCount, rayCount, boxes, bounds, rays);
+    const BoxArrays arrays = {&bounds[0], &bounds[boxCount], &bounds[2 * boxCount],
+                              &bounds[3 * boxCount], &bounds[4 * boxCount], &bounds[5 * boxCount]};
+    double minSeconds = quick ? 0.1 : 0.5;
+    volatile int sink = 0; // keeps the compiler from dropping the tests
+
+    if (report.enabled("box/intersect"))
+    {
+        long long iterations;
+        double seconds = timePerCall([&]()
+                                     {
+                                         int hits = 0;
+                                         for (const Ray &ray : rays)
+                                         {
+                                             for (const AABBox &box : boxes)
+                                             {
+                                                 hits += box.intersect(ray, length);
+                                             }
+                                         }
+                                         sink = sink + hits; },
+                                     minSeconds, iterations);
+        report.add({"box/intersect", "ns/test", seconds * 1e9 / (boxCount * rayCount), iterations * boxCount * rayCount,
+                    {{"boxes", std::to_string(boxCount)}}});
+    }
+
+    if (report.enabled("box/nearest_batch"))
+    {
+        long long iterations;
+        double seconds = timePerCall([&]()
+                                     {
+                                         int hits = 0;
+                                         float distance;
+                                         for (const Ray &ray : rays)
+                                         {
+                                             hits += nearestRayHit(ray, arrays, 0, boxCount, length, distance);
+                                         }
+                                         sink = sink + hits; },
+                                     minSeconds, iterations);
+        report.add({"box/nearest_batch", "ns/test", seconds * 1e9 / (boxCount * rayCount), iterations * boxCount * rayCount,
+                    {{"boxes", std::to_string(boxCount)}, {"simd", rayBatchInstructionSet()}}});
+    }
+}
+
+static void benchmarkFrustumCulling(BenchmarkReport &report, bool quick)
+{
+    if (!report.enabled("cull/spheres"))
+    {
+        return;
+    }
+
+    // tree sized spheres spread over a large map, seen from the middle with the game's projection
+    const int sphereCount = 65536;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+    BoundingSpheres spheres;
+    for (int i = 0; i < sphereCount; i++)
+    {
+        spheres.add(glm::vec3(position(rng), 3.0f, position(rng)), 4.0f);
+    }
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(1.0f, 2.0f, 0.5f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Frustum frustum = Frustum::fromMatrix(projection * view);
+    std::vector<unsigned int> visible;
+    visible.reserve(sphereCount);
+
+    double minSeconds = quick ? 0.1 : 0.5;
+    long long iterations;
+    volatile int sink = 0; // keeps the compiler from dropping the tests
+    double seconds = timePerCall([&]()
+                                 { sink = sink + cullSpheres(frustum, spheres, visible); },
+                                 minSeconds, iterations);
+    report.add({"cull/spheres", "ns/sphere", seconds * 1e9 / sphereCount, iterations * sphereCount,
+                {{"spheres", std::to_string(sphereCount)}, {"visible", std::to_string(visible.size())}, {"simd", frustumCullingInstructionSet()}}});
+}
+
+static void benchmarkSimulationStep(BenchmarkReport &report, bool quick)
+{
+    if (!report.enabled("sim/step"))
+    {
+        return;
+    }
+
+    std::vector<int> droneCounts = {3, 100, 1000, 10000, 100000};
+    if (quick)
+    {
+        droneCounts.pop_back();
+    }
+    std::vector<int> threadCounts = {1};
+    if (std::thread::hardware_concurrency() > 1)
+    {
+        threadCounts.push_back(0); // one per core
+    }
+    const std::vector<AABBox> obstacles = WorldLayout("forest", 1).getObstacles();
+
+    for (int threads : threadCounts)
+    {
+        JobSystem jobs(threads);
+        for (int drones : droneCounts)
+        {
+            // all drones join at once, so every tick has the same number of drones
+            Simulation sim(drones, 0.0f);
+            sim.setJobSystem(&jobs);
+            sim.setObstacles(obstacles);
+            sim.setSeed(1);
+
+            // the player turns slowly and keeps shooting, so bullets, lasers and respawns are part of the workload
+            PlayerInput input;
+            input.shoot = true;
+            input.mouseDX = 20.0f;
+
+            // run for a fixed time, restarting the game (untimed) when the player dies
+            double minSeconds = quick ? 0.2 : 1.0;
+            std::chrono::duration<double> stepTime(0);
+            long long ticks = 0;
+            int restarts = 0;
+            auto start = std::chrono::steady_clock::now();
+            while (secondsSince(start) < minSeconds || ticks < 10)
+            {
+                if (!sim.player.isAlive)
+                {
+                    sim.reset();
+                    restarts++;
+                }
+                auto stepStart = std::chrono::steady_clock::now();
+                sim.step(input);
+                stepTime += std::chrono::steady_clock::now() - stepStart;
+                sim.clearEvents();
+                ticks++;
+            }
+            report.add({"sim/step", "ms/tick", stepTime.count() * 1000.0 / ticks, ticks,
+                        {{"drones", std::to_string(drones)}, {"threads", std::to_string(jobs.getThreadCount())},
+                         {"restarts", std::to_string(restarts)}}});
+        }
+    }
+}
+
+void runSimBenchmarks(BenchmarkReport &report, bool quick)
+{
+    benchmarkBoxIntersect(report, quick);
+    benchmarkFrustumCulling(report, quick);
+    benchmarkSimulationStep(report, quick);
+}
@@ -0,0 +1,96 @@
+#include "benchmark.h"
+
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+#include "ray_batch.h"
+
+// escapes the characters that may not appear in a JSON string
+static std::string jsonString(const std::string &text)
+{
+    std::string out = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            out += ' ';
+        }
+        else
+        {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+BenchmarkReport::BenchmarkReport(const std::string &filter)
+{
+    this->filter = filter;
+}
+
+bool BenchmarkReport::enabled(const std::string &name) const
+{
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+void BenchmarkReport::add(const BenchmarkResult &result)
+{
+    results.push_back(result);
+
+    std::cerr << result.name;
+    for (const auto &param : result.params)
+    {
+        std::cerr << " " << param.first << "=" << param.second;
+    }
+    std::cerr << ": " << result.value << " " << result.unit << " (" << result.iterations << " iterations)" << std::endl;
+}
+
+void BenchmarkReport::writeJson(std::ostream &out) const
+{
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+#ifdef NDEBUG
+    const char *buildType = "release";
+#else
+    const char *buildType = "debug";
+#endif
+#ifdef __VERSION__
+    const char *compiler = __VERSION__;
+#else
+    const char *compiler = "unknown";
+#endif
+
+    out << "{\n";
+    out << "  \"date\": " << jsonString(date) << ",\n";
+    out << "  \"build_type\": " << jsonString(buildType) << ",\n";
+    out << "  \"compiler\": " << jsonString(compiler) << ",\n";
+    out << "  \"simd\": " << jsonString(rayBatchInstructionSet()) << ",\n";
+    out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult &result = results[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"name\": " << jsonString(result.name) << ", \"unit\": " << jsonString(result.unit)
+            << ", \"value\": " << result.value << ", \"iterations\": " << result.iterations << ", \"params\": {";
+        for (size_t p = 0; p < result.params.size(); p++)
+        {
+            out << (p == 0 ? "" : ", ") << jsonString(result.params[p].first) << ": " << jsonString(result.params[p].second);
+        }
+        out << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,102 @@
+/**
+ * benchmark.h
+ *
+ * This file contains the small harness used by drone-bench: timing helpers and a report
+ * that collects the results and writes them as JSON, so they can be compared between commits.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// One measurement.
+struct BenchmarkResult
+{
+    std::string name;                                        // e.g. "sim/step"
+    std::string unit;                                        // unit of value, e.g. "ns/test" or "ms"
+    double value = 0.0;                                      // measured value (lower is better)
+    long long iterations = 0;                                // number of iterations the value is averaged over
+    std::vector<std::pair<std::string, std::string>> params; // parameters of the run, e.g. {"drones", "1000"}
+};
+
+class BenchmarkReport
+{
+public:
+    /**
+     * @brief Constructs an empty report.
+     *
+     * @param filter only benchmarks whose name contains this text are run (empty = all).
+     */
+    BenchmarkReport(const std::string &filter);
+
+    /// Returns true if the benchmark with this name should run.
+    bool enabled(const std::string &name) const;
+
+    /// Adds a result (and prints it to std::cerr as progress).
+    void add(const BenchmarkResult &result);
+
+    /// Writes all results and some information about the build as JSON.
+    void writeJson(std::ostream &out) const;
+
+private:
+    std::string filter;                  // name filter
+    std::vector<BenchmarkResult> results; // results in the order they were added
+};
+
+/// Returns the seconds passed since start.
+double secondsSince(std::chrono::steady_clock::time_point start);
+
+/**
+ * @brief Calls a function repeatedly until at least minSeconds have passed (doubling the batch size,
+ * so the clock is read rarely for fast functions) and returns the average time per call.
+ *
+ * @param fn function to time.
+ * @param minSeconds minimum total time.
+ * @param iterations set to the number of calls.
+ * @return double seconds per call.
+ */
+template <typename Function>
+double timePerCall(Function fn, double minSeconds, long long &iterations)
+{
+    iterations = 0;
+    long long batch = 1;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    while (elapsed < minSeconds)
+    {
+        for (long long i = 0; i < batch; i++)
+        {
+            fn();
+        }
+        iterations += batch;
+        batch *= 2;
+        elapsed = secondsSince(start);
+    }
+    return elapsed / iterations;
+}
+
+/**
+ * @brief Runs the benchmarks of the game logic (bounding box tests, simulation step), see bench_sim.cpp.
+ *
+ * @param report report the results are added to.
+ * @param quick use smaller sizes and shorter runs.
+ */
+void runSimBenchmarks(BenchmarkReport &report, bool quick);
+
+/**
+ * @brief Runs the benchmarks that need an OpenGL context (model import, texture decode, text layout), see bench_graphics.cpp.
+ * Must be called from the directory that contains resources/ and shaders/.
+ *
+ * @param report report the results are added to.
+ * @param quick use fewer assets and shorter runs.
+ */
+void runGraphicsBenchmarks(BenchmarkReport &report, bool quick);
+
+#endif /*__BENCHMARK__*/
@@ -0,0 +1,59 @@
+/// === drone-bench === ///
+/// Benchmarks the hot paths of the game (bounding box tests, simulation step per drone count, model import,
+/// texture decoding and text rendering) and writes the results as JSON, so runs can be compared between commits.
+/// The graphics benchmarks are only part of the build when the game itself is built (see CMakeLists.txt).
+/// Run it from the repository root, the assets are loaded with relative paths.
+/// Usage: drone-bench [--out <file>] [--filter <text>] [--quick]
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "benchmark.h"
+
+int main(int argc, char *argv[])
+{
+    std::string outPath;
+    std::string filter;
+    bool quick = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+        {
+            outPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--quick") == 0)
+        {
+            quick = true;
+        }
+        else
+        {
+            std::cout << "Usage: drone-bench [--out <file>] [--filter <text>] [--quick]" << std::endl;
+            return 1;
+        }
+    }
+
+    BenchmarkReport report(filter);
+    runSimBenchmarks(report, quick);
+#ifdef DRONE_BENCH_GRAPHICS
+    runGraphicsBenchmarks(report, quick);
+#endif
+
+    if (outPath.empty())
+    {
+        report.writeJson(std::cout);
+        return 0;
+    }
+    std::ofstream out(outPath);
+    if (!out)
+    {
+        std::cout << "ERROR::BENCH::Could not open " << outPath << std::endl;
+        return 1;
+    }
+    report.writeJson(out);
+    return 0;
+}
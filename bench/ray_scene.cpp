@@ -0,0 +1,33 @@
+#include "ray_scene.h"
+
+#include <random>
+
+void createBoxesAndRays(int boxCount, int rayCount, std::vector<AABBox> &boxes, std::vector<float> &bounds, std::vector<Ray> &rays)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-40.0f, 40.0f);
+    std::uniform_real_distribution<float> size(0.2f, 1.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    boxes.clear();
+    bounds.assign(6 * boxCount, 0.0f);
+    for (int i = 0; i < boxCount; i++)
+    {
+        glm::vec3 center(position(rng), position(rng) * 0.1f + 4.0f, position(rng));
+        glm::vec3 halfSize(size(rng), size(rng) * 0.5f, size(rng));
+        boxes.push_back(AABBox(center - halfSize, center + halfSize));
+        for (int axis = 0; axis < 3; axis++)
+        {
+            bounds[axis * boxCount + i] = boxes[i].bounds[0][axis];
+            bounds[(axis + 3) * boxCount + i] = boxes[i].bounds[1][axis];
+        }
+    }
+
+    rays.clear();
+    rays.reserve(rayCount);
+    for (int i = 0; i < rayCount; i++)
+    {
+        glm::vec3 dir(unit(rng), unit(rng) * 0.2f, unit(rng));
+        rays.push_back(Ray(glm::vec3(position(rng), 4.0f, position(rng)), glm::normalize(dir)));
+    }
+}
@@ -0,0 +1,30 @@
+/**
+ * ray_scene.h
+ *
+ * This file contains the random boxes and rays that the ray vs box benchmarks (ray-bench and drone-bench)
+ * test against each other, so both measure the same scene.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __RAY_SCENE_H__
+#define __RAY_SCENE_H__
+
+#include <vector>
+
+#include "box.h"
+#include "ray.h"
+
+/**
+ * @brief Creates drone sized boxes scattered over the map and rays from random points in random directions
+ * (always the same ones for the same counts).
+ *
+ * @param boxCount number of boxes.
+ * @param rayCount number of rays.
+ * @param boxes set to the boxes.
+ * @param bounds set to the boxes as arrays: minX, minY, minZ, maxX, maxY, maxZ (boxCount floats each).
+ * @param rays set to the rays.
+ */
+void createBoxesAndRays(int boxCount, int rayCount, std::vector<AABBox> &boxes, std::vector<float> &bounds, std::vector<Ray> &rays);
+
+#endif /*__RAY_SCENE__*/
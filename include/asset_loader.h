@@ -0,0 +1,176 @@
+/**
+ * asset_loader.h
+ *
+ * This file contains an AssetLoader class that loads models, textures and cubemaps without blocking the render loop.
+ * Worker threads do the CPU work: reading the models (mesh cache or Assimp, see model.h) and decoding the images
+ * with stb_image. The results go into an upload queue that update() works through on the main thread, which owns
+ * the OpenGL context, a bounded amount per frame (UPLOAD_BUDGET), so a loading screen keeps rendering meanwhile.
+ * Images are copied into a ring of pixel buffer objects (PBOs) and uploaded from there, so glTexImage2D does not
+ * have to copy them before it returns; a fence per PBO tells when the GPU has read it and it can be filled again.
+ * Finished resources are handed to the resource registry (so World::load finds them there) and held by the loader
+ * until releaseLoaded is called.
+ * Resources that will probably be needed soon can be prefetched: they are only decoded and kept in a cache of
+ * at most PREFETCH_BUDGET bytes (the least recently prefetched are dropped first), so loading them later only
+ * has to upload them. Prefetches that did not start yet are cancelled with cancelPrefetches.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __ASSET_LOADER_H__
+#define __ASSET_LOADER_H__
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "job_system.h"
+
+class AssetLoader
+{
+public:
+    static const std::size_t UPLOAD_BUDGET;   // bytes uploaded per update (at least one image or mesh is always uploaded)
+    static const unsigned int PBO_COUNT;      // number of pixel buffer objects in the upload ring
+    static const std::size_t PREFETCH_BUDGET; // bytes of decoded resources kept in the prefetch cache
+
+    /// Starts the worker threads, the PBOs are created on the first upload.
+    AssetLoader();
+
+    /**
+     * @brief Cancels the prefetches, waits for the workers and deletes the PBOs (resources that were not uploaded yet are
+     * dropped and their partial uploads deleted). Needs the OpenGL context, so destroy the loader before glfwTerminate.
+     */
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader &) = delete;
+    AssetLoader &operator=(const AssetLoader &) = delete;
+
+    /**
+     * @brief Queues a model (see ResourceRegistry::getModel). Nothing happens if it is alive or queued already.
+     *
+     * @param path filepath to the model.
+     * @param flipVertically flip the textures vertically on load or not?
+     */
+    void loadModel(const std::string &path, bool flipVertically);
+
+    /**
+     * @brief Queues a 2D texture (see ResourceRegistry::getTexture). Nothing happens if it is alive or queued already.
+     *
+     * @param filename filename.
+     * @param directory directory where filename is located.
+     * @param flipVertically flip texture vertically on load or not?
+     */
+    void loadTexture(const std::string &filename, const std::string &directory, bool flipVertically);
+
+    /**
+     * @brief Queues a cubemap (see ResourceRegistry::getCubemap). Nothing happens if it is alive or queued already.
+     *
+     * @param faces paths to the 6 faces of the cubemap (+X, -X, +Y, -Y, +Z, -Z).
+     */
+    void loadCubemap(const std::vector<std::string> &faces);
+
+    /// Decodes a model ahead without uploading it (see loadModel). Nothing happens if it is alive, queued or prefetched already.
+    void prefetchModel(const std::string &path, bool flipVertically);
+
+    /// Decodes a 2D texture ahead without uploading it (see loadTexture and prefetchModel).
+    void prefetchTexture(const std::string &filename, const std::string &directory, bool flipVertically);
+
+    /// Decodes a cubemap ahead without uploading it (see loadCubemap and prefetchModel).
+    void prefetchCubemap(const std::vector<std::string> &faces);
+
+    /// Cancels the prefetches that did not start decoding yet (what was decoded already stays in the cache).
+    void cancelPrefetches();
+
+    /// Returns the number of bytes in the prefetch cache.
+    std::size_t getPrefetchedBytes() const;
+
+    /// Uploads decoded resources, at most UPLOAD_BUDGET bytes. Call once per frame on the thread that owns the OpenGL context.
+    void update();
+
+    /// Returns the part of the queued work that is done (0 to 1, 1 if nothing is queued).
+    float getProgress() const;
+
+    /// Returns true if every queued resource is in the registry.
+    bool isIdle() const;
+
+    /// Lets go of the loaded resources: from now on they live as long as somebody else holds them.
+    void releaseLoaded();
+
+private:
+    enum class AssetType
+    {
+        MODEL,
+        TEXTURE,
+        CUBEMAP
+    };
+
+    struct Image;
+    struct Asset;
+
+    std::vector<std::shared_ptr<Asset>> pending;     // queued and not in the registry yet (main thread only)
+    std::deque<std::shared_ptr<Asset>> decoded;      // decoded by a worker, waiting for update to pick them up
+    std::mutex decodedMutex;                         // guards decoded
+    std::vector<std::shared_ptr<const void>> loaded; // resources that were loaded, held until releaseLoaded
+    std::vector<std::shared_ptr<Asset>> prefetching; // prefetches that are being decoded (main thread only)
+    std::vector<std::shared_ptr<Asset>> prefetched;  // decoded prefetches, least recently prefetched first (main thread only)
+    std::size_t prefetchedBytes;                     // decoded bytes in prefetched
+
+    std::vector<GLuint> pbos;          // pixel buffer ring
+    std::vector<GLsync> fences;        // per PBO: signaled once the GPU has read it (nullptr if it is free)
+    std::vector<std::size_t> pboSizes; // per PBO: size of its storage in bytes
+    unsigned int nextPbo;              // PBO the next image is copied into
+    unsigned int finished;             // resources finished since the loader was last idle
+
+    JobSystem jobs; // worker threads, declared last so they are joined before the rest is destroyed
+
+    /// Describes a model (see loadModel).
+    static std::shared_ptr<Asset> describeModel(const std::string &path, bool flipVertically);
+
+    /// Describes a 2D texture (see loadTexture).
+    static std::shared_ptr<Asset> describeTexture(const std::string &filename, const std::string &directory, bool flipVertically);
+
+    /// Describes a cubemap (see loadCubemap).
+    static std::shared_ptr<Asset> describeCubemap(const std::vector<std::string> &faces);
+
+    /// Queues an asset for upload: takes it from the prefetches if it is there, else starts decoding it on a worker.
+    void queue(const std::shared_ptr<Asset> &asset);
+
+    /// Starts decoding an asset ahead, unless it is queued or prefetched already.
+    void prefetch(const std::shared_ptr<Asset> &asset);
+
+    /// Decodes an asset on a worker (skipped if the asset is a prefetch that was cancelled), then hands it to update.
+    void decodeAsync(const std::shared_ptr<Asset> &asset);
+
+    /// Picks up a decoded asset: starts its upload or keeps it in the prefetch cache.
+    void pickUp(const std::shared_ptr<Asset> &asset);
+
+    /// Prepares the upload of a decoded asset.
+    static void startUpload(Asset &asset);
+
+    /// Reads a model or decodes the images of an asset (runs on a worker).
+    static void decode(Asset &asset);
+
+    /**
+     * @brief Uploads the next part of an asset (an image or a mesh) and registers the asset once it is complete.
+     *
+     * @param asset decoded asset.
+     * @param bytes the number of uploaded bytes is added here.
+     * @return true if the asset is complete, false if there is more to upload (or no PBO was free).
+     */
+    bool uploadStep(Asset &asset, std::size_t &bytes);
+
+    /**
+     * @brief Copies an image into the next PBO and uploads it to the bound texture.
+     *
+     * @param target GL_TEXTURE_2D or a face of the bound cubemap.
+     * @param image decoded image.
+     * @return true if the image was uploaded, false if the next PBO is still being read by the GPU.
+     */
+    bool uploadImage(GLenum target, const Image &image);
+};
+
+#endif /*__ASSET_LOADER__*/
@@ -29,7 +29,7 @@ public:
     AABBox(glm::vec3 vmin, glm::vec3 vmax);
 
     /// Returns true if the given bounds are valid (min < max and max > min), else false.
-    bool isValid();
+    bool isValid() const;
 
     /// Swaps values when necessary (when they are not valid).
     void fix();
@@ -38,10 +38,20 @@ public:
      * @brief Checks whether a ray hits the bounding box.
      * 
      * @param ray ray object.
-     * @param length length of ray.
+     * @param length length of ray (in units of the ray's direction vector).
      * @return true if intersect, else false.
      */
-    bool intersect(Ray ray, float length);
+    bool intersect(const Ray &ray, float length) const;
+
+    /**
+     * @brief Checks whether a ray hits the bounding box and returns where it enters the box.
+     * 
+     * @param ray ray object.
+     * @param length length of ray (in units of the ray's direction vector).
+     * @param distance set to the distance along the ray where it enters the box (0 if the ray starts inside the box).
+     * @return true if intersect, else false.
+     */
+    bool intersect(const Ray &ray, float length, float &distance) const;
 }; 
 
 #endif /*__BOX__*/
\ No newline at end of file
@@ -0,0 +1,122 @@
+/**
+ * bvh.h
+ *
+ * This file contains a bounding volume hierarchy (BVH) of axis aligned bounding boxes for ray casts.
+ * The tree is built once from a set of boxes (median split along the longest axis) and can then be
+ * refitted: items get new boxes and refit() grows/shrinks the node boxes bottom-up without changing the tree layout.
+ * That makes it cheap to keep up to date for moving objects (drones), while static objects (trees, rocks)
+ * are simply built once. A ray cast visits the nodes front to back and skips everything behind the nearest hit so far,
+ * so its cost grows logarithmically with the number of items.
+ * The item boxes are stored as a structure of arrays, so the items of a leaf are tested in one batch (see ray_batch.h).
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __BVH_H__
+#define __BVH_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "box.h"
+#include "ray.h"
+#include "ray_batch.h"
+
+class BVH
+{
+public:
+    static const int LEAF_SIZE; // max number of items in a leaf
+
+    /// Constructs an empty tree.
+    BVH();
+
+    /**
+     * @brief Builds the tree from scratch.
+     *
+     * @param ids ids of the items (e.g. drone slots or obstacle indices, >= 0).
+     * @param boxes bounding box per item (same order as ids).
+     */
+    void build(const std::vector<int> &ids, const std::vector<AABBox> &boxes);
+
+    /// Removes all items.
+    void clear();
+
+    /// Returns true if the item is part of the tree.
+    bool contains(int id) const;
+
+    /// Returns the number of items in the tree.
+    int size() const;
+
+    /**
+     * @brief Gives an item a new bounding box (takes effect after refit).
+     * Only writes to the item itself, so different items can be updated from different threads.
+     *
+     * @param id id of the item (must be part of the tree).
+     * @param min minimum bound.
+     * @param max maximum bound.
+     */
+    void update(int id, glm::vec3 min, glm::vec3 max);
+
+    /**
+     * @brief Makes an item invisible to ray casts until it gets a box again with update
+     * (ray casts skip it right away, the node boxes shrink after refit).
+     *
+     * @param id id of the item (must be part of the tree).
+     */
+    void disable(int id);
+
+    /// Recomputes the node boxes bottom-up after items were updated or disabled.
+    void refit();
+
+    /**
+     * @brief Finds the nearest item hit by a ray.
+     *
+     * @param ray ray object (use a normalized direction to measure distances in world units).
+     * @param maxDistance maximum distance.
+     * @param id set to the id of the nearest item that was hit.
+     * @param distance set to the distance of the hit.
+     * @return true if an item was hit within maxDistance, else false.
+     */
+    bool raycast(const Ray &ray, float maxDistance, int &id, float &distance) const;
+
+private:
+    struct Node
+    {
+        AABBox box;    // bounds of everything below this node
+        int first = 0; // leaf: position of the first item in items; internal node: index of the left child (right = first + 1)
+        int count = 0; // number of items in a leaf, 0 for internal nodes
+    };
+
+    std::vector<Node> nodes;          // nodes, children are always stored after their parent
+    std::vector<int> items;           // item ids in leaf order
+    std::vector<float> itemMinX, itemMinY, itemMinZ; // item boxes in leaf order (minimum bound)
+    std::vector<float> itemMaxX, itemMaxY, itemMaxZ; // item boxes in leaf order (maximum bound)
+    std::vector<uint8_t> itemEnabled; // per item in leaf order: 0 if it was disabled (ray casts skip it)
+    std::vector<int> itemPosition;    // per id: position in items (-1 if not in the tree)
+    std::vector<glm::vec3> centroids; // scratch: box centers while building (in input order)
+    std::vector<int> order;           // scratch: input indices in leaf order while building
+
+    /// Returns the item boxes as arrays for the batched ray test.
+    BoxArrays itemArrays() const;
+
+    /**
+     * @brief Stores the box of the item at a position in leaf order.
+     *
+     * @param position position in items.
+     * @param min minimum bound.
+     * @param max maximum bound.
+     */
+    void setItemBox(int position, glm::vec3 min, glm::vec3 max);
+
+    /**
+     * @brief Creates the subtree for the items in [begin, end) of order.
+     *
+     * @param boxes bounding box per item (input order).
+     * @param node index of the node to fill in.
+     * @param begin first position in order.
+     * @param end one past the last position.
+     */
+    void buildNode(const std::vector<AABBox> &boxes, int node, int begin, int end);
+};
+
+#endif /*__BVH__*/
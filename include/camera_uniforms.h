@@ -0,0 +1,53 @@
+/**
+ * camera_uniforms.h
+ *
+ * This file contains a CameraUniforms class that holds the projection and view matrix of the camera
+ * in one uniform buffer object (std140 layout). Every shader that declares the Camera block
+ * (layout (std140) uniform Camera { mat4 projection; mat4 view; };) reads the matrices from this buffer,
+ * so they are uploaded once per frame instead of once per shader and draw call.
+ * Shaders bind their Camera block to BINDING when they are linked (see shader.h).
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __CAMERA_UNIFORMS_H__
+#define __CAMERA_UNIFORMS_H__
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+class CameraUniforms
+{
+public:
+    static const GLuint BINDING;    // uniform buffer binding point of the Camera block
+    static const char *BLOCK_NAME;  // name of the uniform block in the shaders
+
+    /// Creates the uniform buffer and binds it to BINDING (needs an OpenGL context).
+    CameraUniforms();
+
+    /// Deletes the uniform buffer (the OpenGL context has to be alive, so destroy the uniforms before glfwTerminate).
+    ~CameraUniforms();
+
+    CameraUniforms(const CameraUniforms &) = delete;
+    CameraUniforms &operator=(const CameraUniforms &) = delete;
+
+    /**
+     * @brief Uploads the camera matrices, call once per frame before the first draw that uses them.
+     *
+     * @param view view matrix.
+     * @param projection projection matrix.
+     */
+    void update(const glm::mat4 &view, const glm::mat4 &projection);
+
+private:
+    /// Layout of the Camera block (std140: two column major mat4, no padding needed).
+    struct Block
+    {
+        glm::mat4 projection;
+        glm::mat4 view;
+    };
+
+    GLuint UBO; // uniform buffer
+};
+
+#endif /*__CAMERA_UNIFORMS__*/
@@ -2,8 +2,12 @@
   * collision_detection.h
   * 
   * This file is used to handle collision detection
-  * between the player's bullet and enemy and between
-  * the enemy's laser and the player.
+  * between the player's bullet and drones and between
+  * the drones' lasers and the player.
+  * The bullet is cast through a BVH of the drones and a BVH of the static obstacles (trees, rocks),
+  * so it hits the nearest drone unless an obstacle is in the way (see bvh.h).
+  * Drones and laser beams are also kept in uniform grids (see spatial_grid.h), so that radius queries stay cheap
+  * and only the lasers near the player need an exact hit test. Obstacles block lasers too.
   * 
   * Created by EtoileScintillante.
   */
@@ -11,44 +15,96 @@
 #ifndef __COLLISION_DETECTION__
 #define __COLLISION_DETECTION__
 
-#include "player.h"
-#include "enemy.h"
-#include "enemy_manager.h"
+#include <vector>
+
+#include "sim_state.h"
+#include "drone_swarm.h"
+#include "spatial_grid.h"
+#include "bvh.h"
 #include "box.h"
 #include "ray.h"
+#include "job_system.h"
 
 class CollisionDetector
 {
 public:
-  /// initializes new CollisionDetector object.
+  static const float CELL_SIZE;      // edge length of a grid cell
+  static const int REBUILD_INTERVAL; // number of ticks after which the drone tree is rebuilt instead of refitted
+
+  /// initializes new CollisionDetector object with empty grids over the terrain and the drone spawn ring.
   CollisionDetector();
 
   /**
-   * @brief Handles all collisions between player and enemy.
+   * @brief Handles all collisions between player and drones.
+   * 
+   * @param player player state.
+   * @param drones drone swarm.
+   * @param fired slots of the drones that fired their laser this tick.
+   * @param events vector to which hit events are appended.
+   * @param jobs job system for updating the drone grid and tree (nullptr = run on the calling thread).
+   */
+  void Detect(PlayerState &player, DroneSwarm &drones, const std::vector<int> &fired, std::vector<SimEvent> &events, JobSystem *jobs = nullptr);
+
+  /**
+   * @brief Sets the static obstacles (trees, rocks, ...) that block bullets and lasers.
+   * 
+   * @param obstacles bounding boxes of the obstacles.
+   */
+  void SetObstacles(const std::vector<AABBox> &obstacles);
+
+  /**
+   * @brief Finds the living drones within a radius of a point (as of the last call to Detect).
    * 
-   * @param player player object.
-   * @param manager enemy manager object.
+   * @param center center of the search area.
+   * @param radius radius of the search area.
+   * @param out vector the drone slots are appended to.
    */
-  void Detect(Player &player, EnemyManager &manager);
+  void FindDrones(glm::vec3 center, float radius, std::vector<int> &out);
+
+  /// Removes all drones and lasers (in case the game gets restarted); the obstacles stay.
+  void Reset();
 
 private:
+  SpatialGrid droneGrid;       // bounding boxes of the living drones, by slot
+  SpatialGrid laserGrid;       // laser beams that can still damage the player, by slot
+  BVH droneTree;               // bounding boxes of all drone slots (dead drones and free slots are disabled)
+  BVH obstacleTree;            // bounding boxes of the obstacles, built once
+  int ticksSinceRebuild;       // ticks since the drone tree was last rebuilt
+  std::vector<glm::vec3> laserOrigin; // per slot: position the drone fired its laser beam from
+  std::vector<float> laserLength; // per slot: length of the laser beam (shorter if an obstacle is in the way)
+  std::vector<int> candidates; // scratch: result of grid queries
+  std::vector<uint8_t> moved;  // scratch: per slot, does the drone have to move to other grid cells?
+  std::vector<int> ids;        // scratch: ids for building a tree
+  std::vector<AABBox> boxes;   // scratch: boxes for building a tree
+
+  /**
+   * @brief Rebuilds the drone tree from all slots.
+   * 
+   * @param drones drone swarm.
+   */
+  void RebuildDroneTree(const DroneSwarm &drones);
+
   /**
-   * @brief Handles collision between player's bullet and enemy.
+   * @brief Handles collision between player's bullet and the nearest drone along its path
+   * (nothing is hit if an obstacle comes first).
    * 
-   * @param player Player object.
-   * @param enemy shared pointer enemy.
+   * @param player player state.
+   * @param drones drone swarm.
+   * @param events vector to which hit events are appended.
    */
-  void PlayerAttacksEnemy(Player &player, std::shared_ptr<Enemy> enemy);
+  void PlayerAttacksEnemy(PlayerState &player, DroneSwarm &drones, std::vector<SimEvent> &events);
 
   /**
-   * @brief Handles collsision detection between enemy's laser and player.
+   * @brief Checks for collision between a drone's laser and player.
    * 
-   * @param player Player object.
-   * @param enemy shared pointer enemy.
+   * @param player player state.
+   * @param drones drone swarm.
+   * @param slot slot of the drone.
+   * @return true if the laser hits the player.
    */
-  void EnemyAttacksPlayer(Player &player, std::shared_ptr<Enemy> enemy);
+  bool EnemyAttacksPlayer(const PlayerState &player, const DroneSwarm &drones, int slot);
 };
 
 
 
-#endif /*__COLLISION_DETECTION__*/
\ No newline at end of file
+#endif /*__COLLISION_DETECTION__*/
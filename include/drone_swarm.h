@@ -0,0 +1,161 @@
+/**
+ * drone_swarm.h
+ *
+ * This file contains the DroneSwarm class, which stores the state of all drones
+ * as a structure of arrays (one contiguous array per attribute) with a free list of unused slots.
+ * The per-drone logic (moving towards the player, rebuilding bounding boxes, aiming lasers)
+ * is written as batch kernels over a range of slots, so that large numbers of drones
+ * can be updated with cache-friendly loops.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __DRONE_SWARM_H__
+#define __DRONE_SWARM_H__
+
+#include <cstdint>
+#include <vector>
+
+#include "sim_state.h"
+
+class DroneSwarm
+{
+public:
+    // flags written by advanceTimers
+    static const uint8_t FLAG_FIRED = 1;     // drone fired its laser this tick
+    static const uint8_t FLAG_RESPAWNED = 2; // drone should spawn again in a new position
+    // drone state, indexed by slot
+    std::vector<uint8_t> inUse;       // is the slot occupied by a drone?
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> rotation;      // rotation angle around the y axis in radians (points towards player)
+    std::vector<float> prevX, prevY, prevZ, prevRotation; // position and rotation before the last tick (for render interpolation)
+    std::vector<float> attackTime;    // time passed since the last attack
+    std::vector<uint8_t> isDead;      // is drone dead?
+    std::vector<float> explodeTime;   // time passed since the drone got shot
+    std::vector<float> spawnInterval; // time passed since the explosion ended
+    std::vector<float> magnitude;     // how far the explosion has spread
+    std::vector<uint8_t> canDamage;   // to ensure that a laser only damages the player once
+    std::vector<float> laserDirX, laserDirY, laserDirZ;
+    std::vector<uint8_t> flags;       // FLAG_FIRED / FLAG_RESPAWNED, written by advanceTimers
+    // bounding boxes (min and max bounds)
+    std::vector<float> boxMinX, boxMinY, boxMinZ;
+    std::vector<float> boxMaxX, boxMaxY, boxMaxZ;
+
+    /// Constructs an empty swarm.
+    DroneSwarm();
+
+    /**
+     * @brief Reserves memory so that adding drones up to the given capacity does not reallocate.
+     *
+     * @param capacity number of drones.
+     */
+    void reserve(int capacity);
+
+    /**
+     * @brief Takes a slot from the free list (or adds a new one) and resets its state.
+     *
+     * @param position spawn position.
+     * @return int slot of the new drone.
+     */
+    int spawn(glm::vec3 position);
+
+    /**
+     * @brief Resets a drone to default values in the given position, keeping its slot.
+     *
+     * @param slot slot of the drone.
+     * @param position spawn position.
+     */
+    void respawn(int slot, glm::vec3 position);
+
+    /**
+     * @brief Removes a drone and puts its slot on the free list.
+     *
+     * @param slot slot of the drone.
+     */
+    void despawn(int slot);
+
+    /// Removes all drones.
+    void clear();
+
+    /// Returns the number of slots (used and unused); kernels run over [0, slots()).
+    int slots() const;
+
+    /// Returns the number of drones in the swarm.
+    int count() const;
+
+    /**
+     * @brief Returns a copy of the state of one drone (handy for rendering or debugging a single drone).
+     *
+     * @param slot slot of the drone.
+     * @return DroneState state of the drone.
+     */
+    DroneState get(int slot) const;
+
+    /**
+     * @brief Returns a copy of the state of one drone, with its position and rotation
+     * blended between the previous tick and the current one (for rendering between ticks).
+     *
+     * @param slot slot of the drone.
+     * @param alpha blend factor, 0 = previous tick, 1 = current tick.
+     * @return DroneState state of the drone.
+     */
+    DroneState getInterpolated(int slot, float alpha) const;
+
+    /// Returns the bounding box of a drone.
+    AABBox getBoundingBox(int slot) const;
+
+    /**
+     * @brief Batch kernel: remembers the position and rotation of the drones in [begin, end)
+     * before they change this tick (see getInterpolated).
+     *
+     * @param begin first slot.
+     * @param end one past the last slot.
+     */
+    void storePrevious(int begin, int end);
+
+    /**
+     * @brief Batch kernel: moves the living drones in [begin, end) towards the player
+     * and turns them so that they face the player.
+     *
+     * @param playerPos player position.
+     * @param distance distance a drone moves (when far away from the player).
+     * @param begin first slot.
+     * @param end one past the last slot.
+     */
+    void moveToPlayer(glm::vec3 playerPos, float distance, int begin, int end);
+
+    /**
+     * @brief Batch kernel: rebuilds the bounding boxes of the living drones in [begin, end)
+     * from their position and rotation.
+     *
+     * @param begin first slot.
+     * @param end one past the last slot.
+     */
+    void calculateBoundingBoxes(int begin, int end);
+
+    /**
+     * @brief Batch kernel: advances attack, explosion and respawn timers of the drones in [begin, end)
+     * and sets FLAG_FIRED / FLAG_RESPAWNED in flags.
+     *
+     * @param dt time step in seconds.
+     * @param begin first slot.
+     * @param end one past the last slot.
+     */
+    void advanceTimers(float dt, int begin, int end);
+
+    /**
+     * @brief Batch kernel: aims the lasers of the given drones at the player and arms them.
+     *
+     * @param drones slots of the drones that fire.
+     * @param offsets random aim offset per drone (same order as drones).
+     * @param count number of drones.
+     * @param playerPos player position.
+     */
+    void calculateLaserDirections(const int *drones, const float *offsets, int count, glm::vec3 playerPos);
+
+private:
+    std::vector<int> freeSlots; // unused slots, reused before the arrays grow
+    int drones;                 // number of drones in the swarm
+};
+
+#endif /*__DRONE_SWARM__*/
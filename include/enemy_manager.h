@@ -1,7 +1,11 @@
 /**
   * enemy_manager.h
   * 
-  * This file contains a class to control the lives of the enemies.
+  * This file contains a class to render the enemies (drones) of the simulation.
+  * All visible drones are drawn together: their model matrices and explosion magnitudes are written to an instance buffer
+  * every frame and the drone model is drawn with one instanced draw call per mesh, however many drones there are.
+  * Live drones and exploding drones are drawn with different permutations of the drone shader;
+  * only the exploding ones use the geometry shader (see shader_permutations.h).
   * 
   * Created by EtoileScintillante.
   */
@@ -12,33 +16,61 @@
 #include <memory>
 
 #include "enemy.h"
-#include "player.h"
+#include "simulation.h"
+#include "model.h"
+#include "shader_permutations.h"
+#include "resource_registry.h"
+#include "gl_object.h"
+
+/// Per-instance data of a drone (vertex attributes 3-7 of the drone shader).
+struct DroneInstance
+{
+    glm::mat4 model; // model matrix
+    float magnitude; // how far the triangles of the exploding drone have moved
+};
 
 class EnemyManager
 {
 public:
-    static const int MAX_ENEMIES;                // max number of enemies that can exist in the game
-    static const float INTERVAL;                 // time in seconds between spawning of new enemies
-    std::vector<std::shared_ptr<Enemy>> enemies; // vector containing pointers to the enemy objects
-    float spawnTime;                             // needed to control spawning of enemies
-    int enemyCount;                              // keeps track of already spawned enemies
-    float currentTime;                           // current time/frame
-    float deltaTime;                             // time passed between two frames
+    std::vector<std::shared_ptr<Enemy>> enemies; // vector containing pointers to the enemy objects, one per simulated drone
 
     /// Constructs a Enemy Manager object. This also initializes the enemy objects.
     EnemyManager();
 
     /**
-     * @brief Manages the lives of the enemies.
+     * @brief Renders the drones of the simulation and plays their sounds.
      * 
-     * @param playerPos player position.
+     * @param sim simulation.
+     * @param alpha blend factor between the previous tick and the current one (see DroneSwarm::getInterpolated).
      * @param viewMatrix view matrix.
      * @param projectionMatrix projection matrix.
      */
-    void manage(glm::vec3 playerPos, glm::mat4 viewMatrix, glm::mat4 projectionMatrix);
+    void manage(const Simulation &sim, float alpha, glm::mat4 viewMatrix, glm::mat4 projectionMatrix);
 
     /// Resets all values (in case the game gets restarted).
     void reset();
+
+private:
+    static const unsigned int EXPLODE; // shader feature of exploding drones (geometry shader)
+
+    std::shared_ptr<Model> drone;                  // drone model (shared by all enemies)
+    ShaderPermutations droneShaders;               // drone shader, with and without explosion effect
+    GLBuffer instanceBuffer;                       // per-instance data of the visible drones (live ones first)
+    size_t instanceCapacity;                       // number of instances instanceBuffer has room for
+    size_t instanceBase;                           // first instance the vertex arrays of the drone meshes point at
+    std::vector<DroneInstance> liveInstances;      // per-instance data of the live drones of this frame
+    std::vector<DroneInstance> explodingInstances; // per-instance data of the exploding drones of this frame
+
+    /**
+     * @brief Points the per-instance attributes of the drone meshes at instanceBuffer, starting at an instance
+     * (OpenGL 3.3 has no base instance for instanced draws, so a range of instances is selected this way).
+     *
+     * @param first first instance.
+     */
+    void setInstanceBase(size_t first);
+
+    /// Uploads the instances of this frame and draws them, one draw call per mesh and shader permutation.
+    void drawDrones();
 };
 
-#endif /*__ENEMY_MANAGER__*/
\ No newline at end of file
+#endif /*__ENEMY_MANAGER__*/
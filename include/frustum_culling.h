@@ -0,0 +1,66 @@
+/**
+ * frustum_culling.h
+ *
+ * This file contains view frustum culling of bounding spheres, used to skip the instances of the trees and
+ * flowers/rocks/pumpkins that are outside the camera's view. The spheres are stored as a structure of arrays
+ * and tested 8 at a time with AVX2 (when compiled with -mavx2, see the ENABLE_AVX2 CMake option),
+ * 4 at a time with SSE (any x86-64 build), and one at a time otherwise.
+ * Culling is conservative: a sphere that touches the frustum is always kept.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __FRUSTUM_CULLING_H__
+#define __FRUSTUM_CULLING_H__
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/// The six planes of a view frustum (a, b, c, d with a normalized normal pointing inwards: inside if a*x + b*y + c*z + d >= 0).
+struct Frustum
+{
+    glm::vec4 planes[6]; // left, right, bottom, top, near, far
+
+    /**
+     * @brief Extracts the planes from a projection * view matrix.
+     *
+     * @param viewProjection projection * view matrix.
+     * @return Frustum frustum in world space.
+     */
+    static Frustum fromMatrix(const glm::mat4 &viewProjection);
+};
+
+/// Bounding spheres stored as one array per coordinate (indexed by sphere).
+struct BoundingSpheres
+{
+    std::vector<float> x, y, z; // centers
+    std::vector<float> radius;  // radii
+
+    /// Adds a sphere.
+    void add(const glm::vec3 &center, float r);
+
+    /// Removes all spheres.
+    void clear();
+
+    /// Returns the number of spheres.
+    int size() const;
+};
+
+/**
+ * @brief Finds the spheres that are (partly) inside the frustum.
+ *
+ * @param frustum view frustum.
+ * @param spheres bounding spheres.
+ * @param visible set to the indices of the visible spheres, in increasing order.
+ * @return int number of visible spheres.
+ */
+int cullSpheres(const Frustum &frustum, const BoundingSpheres &spheres, std::vector<unsigned int> &visible);
+
+/// Same as cullSpheres, but always tests one sphere at a time (reference for the SIMD code paths).
+int cullSpheresScalar(const Frustum &frustum, const BoundingSpheres &spheres, std::vector<unsigned int> &visible);
+
+/// Returns the widest instruction set cullSpheres uses in this build ("AVX2", "SSE" or "scalar").
+const char *frustumCullingInstructionSet();
+
+#endif /*__FRUSTUM_CULLING__*/
@@ -12,6 +12,7 @@
 enum class GameState
 {
     START,     // title / start screen
+    LOADING,   // loading screen while the selected environment is loaded (see asset_loader.h)
     PLAYING,   // active gameplay
     GAME_OVER  // ending screen
 };
@@ -0,0 +1,104 @@
+/**
+ * gl_object.h
+ *
+ * This file contains a GLObject class that owns an OpenGL buffer, vertex array or texture and deletes it when it is
+ * destroyed, so the GPU memory of e.g. a mesh or the ground goes with the object that uses it. A GLObject can be moved
+ * but not copied (there is one owner per OpenGL object). Only use GLObjects on the thread that owns the OpenGL context
+ * and destroy them before the context is (before glfwTerminate).
+ * Finished textures are shared and freed through the resource registry instead (see resource_registry.h), a GLTexture
+ * only owns a texture until it is released to the registry.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __GL_OBJECT_H__
+#define __GL_OBJECT_H__
+
+#include <glad/glad.h>
+
+/// Creates and deletes buffers.
+struct BufferTraits
+{
+    static GLuint create();
+    static void destroy(GLuint name);
+};
+
+/// Creates and deletes vertex arrays (deleting one also makes GLState forget it).
+struct VertexArrayTraits
+{
+    static GLuint create();
+    static void destroy(GLuint name);
+};
+
+/// Creates and deletes textures (deleting one also makes GLState forget it).
+struct TextureTraits
+{
+    static GLuint create();
+    static void destroy(GLuint name);
+};
+
+template <typename Traits>
+class GLObject
+{
+public:
+    /// Constructs an empty object (no OpenGL object is created).
+    GLObject() : name(0) {}
+
+    /// Deletes the OpenGL object.
+    ~GLObject() { reset(); }
+
+    GLObject(const GLObject &) = delete;
+    GLObject &operator=(const GLObject &) = delete;
+
+    /// Takes over the OpenGL object of another one (which is empty afterwards).
+    GLObject(GLObject &&other) noexcept : name(other.name) { other.name = 0; }
+
+    /// Deletes the OpenGL object and takes over the one of another object (which is empty afterwards).
+    GLObject &operator=(GLObject &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            name = other.name;
+            other.name = 0;
+        }
+        return *this;
+    }
+
+    /// Deletes the OpenGL object (if any) and creates a new one.
+    void create()
+    {
+        reset();
+        name = Traits::create();
+    }
+
+    /// Deletes the OpenGL object (if any).
+    void reset()
+    {
+        if (name != 0)
+        {
+            Traits::destroy(name);
+            name = 0;
+        }
+    }
+
+    /// Returns the name of the OpenGL object (0 if there is none).
+    GLuint get() const { return name; }
+
+    /// Hands the OpenGL object over to the caller, which has to delete it (this object is empty afterwards).
+    GLuint release()
+    {
+        GLuint released = name;
+        name = 0;
+        return released;
+    }
+
+private:
+    GLuint name; // OpenGL name (0 if there is none)
+};
+
+using GLBuffer = GLObject<BufferTraits>;
+using GLVertexArray = GLObject<VertexArrayTraits>;
+using GLTexture = GLObject<TextureTraits>;
+
+#endif /*__GL_OBJECT__*/
@@ -0,0 +1,99 @@
+/**
+ * gl_state.h
+ *
+ * This file contains a GLState class that keeps a copy of the OpenGL state the game changes while drawing:
+ * the bound program, vertex array and 2D/cube map textures per texture unit, the active texture unit,
+ * depth test, depth function and depth mask, blending and the blend function.
+ * Calls that would set a state to the value it already has are skipped, and reading the state back
+ * (glIsEnabled, glGetBooleanv) is never needed, since those queries can make the CPU wait for the driver.
+ * This only works if all code changes this state through GLState; call invalidate after code that did not.
+ * The counters show how many calls were passed on to OpenGL and how many were skipped.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __GL_STATE_H__
+#define __GL_STATE_H__
+
+#include <glad/glad.h>
+
+/// Number of state changes since the last resetStats call.
+struct GLStateStats
+{
+    unsigned int issued = 0; // calls passed on to OpenGL
+    unsigned int elided = 0; // calls skipped because the state already had the value
+};
+
+class GLState
+{
+public:
+    static const unsigned int TEXTURE_UNITS; // number of texture units that are tracked
+
+    /// Binds a shader program (glUseProgram).
+    static void useProgram(GLuint program);
+
+    /// Binds a vertex array (glBindVertexArray).
+    static void bindVertexArray(GLuint VAO);
+
+    /**
+     * @brief Binds a texture to a texture unit (activates the unit first if needed).
+     * Only GL_TEXTURE_2D and GL_TEXTURE_CUBE_MAP are tracked, other targets are always bound.
+     *
+     * @param unit texture unit (0 = GL_TEXTURE0).
+     * @param target texture target.
+     * @param texture texture.
+     */
+    static void bindTexture(unsigned int unit, GLenum target, GLuint texture);
+
+    /**
+     * @brief Enables or disables a capability (glEnable/glDisable).
+     * Only GL_DEPTH_TEST, GL_BLEND and GL_CULL_FACE are tracked, other capabilities are always set.
+     *
+     * @param capability capability.
+     * @param enabled true to enable, false to disable.
+     */
+    static void setEnabled(GLenum capability, bool enabled);
+
+    /// Returns whether a capability is enabled (tracked capabilities without asking OpenGL, unless the state was invalidated).
+    static bool isEnabled(GLenum capability);
+
+    /// Sets the depth comparison function (glDepthFunc).
+    static void depthFunc(GLenum func);
+
+    /// Enables or disables writing to the depth buffer (glDepthMask).
+    static void depthMask(bool write);
+
+    /// Returns whether writing to the depth buffer is enabled (without asking OpenGL, unless the state was invalidated).
+    static bool getDepthMask();
+
+    /// Sets the blend function (glBlendFunc).
+    static void blendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+    /**
+     * @brief Call before deleting a texture: OpenGL unbinds a deleted texture and may hand out its name again,
+     * so a binding of it must not be kept.
+     *
+     * @param texture texture that is deleted.
+     */
+    static void forgetTexture(GLuint texture);
+
+    /// Call before deleting a vertex array (see forgetTexture).
+    static void forgetVertexArray(GLuint VAO);
+
+    /// Call before deleting a shader program (a deleted program stays in use until another one is bound, so the next useProgram is always passed on).
+    static void forgetProgram(GLuint program);
+
+    /**
+     * @brief Forgets the tracked state, so the next call of every kind is passed on to OpenGL.
+     * Call after code that changed the state without GLState.
+     */
+    static void invalidate();
+
+    /// Sets the counters to 0 (e.g. at the start of a frame).
+    static void resetStats();
+
+    /// Returns the counters.
+    static const GLStateStats &getStats();
+};
+
+#endif /*__GL_STATE__*/
@@ -0,0 +1,119 @@
+/**
+ * gpu_timer.h
+ *
+ * This file contains a GpuTimer class that measures how long the GPU spends on each render pass
+ * (skybox, ground, surroundings, trees, drones, gun and HUD) with OpenGL timer queries (GL_TIME_ELAPSED).
+ * The queries of a frame are only read back FRAMES frames later, and only once the GPU has the result,
+ * so timing never makes the CPU wait for the GPU. The results can be shown with drawGpuTimings (hud.h)
+ * and written to a CSV file (one line per frame).
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __GPU_TIMER_H__
+#define __GPU_TIMER_H__
+
+#include <glad/glad.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// Render passes that are timed.
+enum class GpuPass
+{
+    SKYBOX,
+    GROUND,
+    SURROUNDINGS,
+    TREES,
+    DRONES,
+    GUN,
+    HUD,
+    COUNT // number of passes
+};
+
+class GpuTimer
+{
+public:
+    static const int FRAMES; // number of frames the queries are kept in flight
+
+    /// Creates the query objects (needs an OpenGL context).
+    GpuTimer();
+
+    /// Deletes the query objects (the OpenGL context has to be alive, so destroy the timer before glfwTerminate).
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer &) = delete;
+    GpuTimer &operator=(const GpuTimer &) = delete;
+
+    /**
+     * @brief Starts a new frame: collects the results of the frame that used the same queries
+     * (if the GPU has finished it, otherwise the previous results are kept) and writes them to the log.
+     * Call once per frame before the first pass.
+     */
+    void beginFrame();
+
+    /**
+     * @brief Starts timing a pass. Passes can not be nested and each pass can be timed once per frame.
+     *
+     * @param pass render pass.
+     */
+    void begin(GpuPass pass);
+
+    /// Stops timing the pass that was started last.
+    void end();
+
+    /**
+     * @brief Returns the GPU time of a pass in the last frame that has results.
+     *
+     * @param pass render pass.
+     * @return float time in milliseconds (0 if the pass was not drawn in that frame).
+     */
+    float getMilliseconds(GpuPass pass) const;
+
+    /// Returns the summed GPU time of all passes in the last frame that has results, in milliseconds.
+    float getTotalMilliseconds() const;
+
+    /**
+     * @brief Starts appending the results of every frame to a CSV file (frame number, milliseconds per pass, total).
+     *
+     * @param path path to the file (created with a header line if it does not exist).
+     * @return true if the file could be opened, else false.
+     */
+    bool openLog(const std::string &path);
+
+    /// Returns the name of a pass (e.g. "trees").
+    static const char *passName(GpuPass pass);
+
+    /// Times the pass for the scope it is declared in; does nothing if timer is null.
+    class Scope
+    {
+    public:
+        Scope(GpuTimer *timer, GpuPass pass) : timer(timer)
+        {
+            if (timer != nullptr) timer->begin(pass);
+        }
+        ~Scope()
+        {
+            if (timer != nullptr) timer->end();
+        }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        GpuTimer *timer;
+    };
+
+private:
+    static const int PASS_COUNT = static_cast<int>(GpuPass::COUNT);
+
+    std::vector<GLuint> queries;                  // FRAMES * PASS_COUNT query objects (frame major)
+    std::vector<bool> issued;                     // per query: started in the frame that last used its slot
+    std::vector<unsigned long long> frameNumbers; // per frame slot: number of the frame that last used it
+    float milliseconds[PASS_COUNT];               // last results per pass
+    unsigned long long frame;                     // number of the current frame
+    int active;                                   // pass that is being timed (-1 if none)
+    std::ofstream log;                            // CSV log (if opened)
+};
+
+#endif /*__GPU_TIMER__*/
@@ -1,7 +1,7 @@
 /**
  * hud.h 
  *
- * This file contains functions to render the title screen, ending screen and the HUD (heads up display).
+ * This file contains functions to render the title screen, loading screen, ending screen and the HUD (heads up display).
  * Current implementations of the functions are based on the font "theboldfont.ttf".
  * Text positions and sizes are adjusted according to the screen dimension (player::SCR_HEIGHT and player::SCR_WIDTH)
  * 
@@ -13,6 +13,9 @@
 
 #include "text_renderer.h"
 #include "player.h"
+#include "gpu_timer.h"
+#include "render_queue.h"
+#include "gl_state.h"
 
 /**
  * @brief Renders start/title screen with a fullscreen background image and environment selector.
@@ -23,6 +26,16 @@
  */
 void startingScreen(TextRenderer &tr, Player &player, int selectedEnv);
 
+/**
+ * @brief Renders the loading screen: the background of the start screen with the environment that is loaded and the progress.
+ *
+ * @param tr TextRenderer object.
+ * @param player Player object.
+ * @param selectedEnv index of the environment that is loaded (0=desert, 1=forest, 2=snow, 3=night).
+ * @param progress part of the loading that is done (0 to 1).
+ */
+void loadingScreen(TextRenderer &tr, Player &player, int selectedEnv, float progress);
+
 /**
  * @brief Renders text that should be visible while playing: player's kills and health.
  *
@@ -39,4 +52,16 @@ void inGameScreen(TextRenderer &tr, Player &player);
  */
 void endingScreen(TextRenderer &tr, Player &player);
 
+/**
+ * @brief Renders the GPU time per render pass in the top left corner (see gpu_timer.h),
+ * the draw and bind statistics of the world (see render_queue.h), the OpenGL state changes (see gl_state.h)
+ * and the number of shared resources (see resource_registry.h).
+ *
+ * @param tr TextRenderer object.
+ * @param timer GPU timer with the results of a recent frame.
+ * @param worldStats render queue statistics of the world in the last frame.
+ * @param stateStats state changes issued and skipped in the last frame.
+ */
+void drawGpuTimings(TextRenderer &tr, const GpuTimer &timer, const RenderQueueStats &worldStats, const GLStateStats &stateStats);
+
 #endif /*__HUD__*/
\ No newline at end of file
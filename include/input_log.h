@@ -0,0 +1,111 @@
+/**
+ * input_log.h
+ *
+ * This file contains a compact binary log of the player input per simulation tick (InputRecorder and InputReplay).
+ * Together with the seed of the random streams (see random_streams.h) the log reproduces a session exactly:
+ * the simulation only depends on the seed, the obstacles (which follow from the environment and the seed)
+ * and the input per tick. Replays are also the workload for timing the game before and after a change.
+ *
+ * Format (little endian):
+ *   header: "DSIL", version (u8), ticks per second (u16), seed (u32), max drones (u32), spawn interval (f32),
+ *           environment name length (u8) + characters (empty = no world, e.g. recorded headless)
+ *   per tick: key bits (u8): forward, backward, left, right, shoot, mouse x moved, mouse y moved;
+ *             then mouse x offset (f32) and mouse y offset (f32), only if they moved
+ * Most ticks take one byte. The log has no tick count, so a session that ends abruptly can still be replayed.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __INPUT_LOG_H__
+#define __INPUT_LOG_H__
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "sim_state.h"
+
+/// Everything besides the inputs that is needed to reproduce a session.
+struct SessionInfo
+{
+    unsigned int seed = 0;          // seed of the random streams (simulation and world)
+    std::string environment;        // environment type, empty if the session had no world (no obstacles)
+    int maxDrones = 0;              // max number of drones that can exist in the game
+    float spawnInterval = 0.0f;     // time in seconds between new drones joining the game
+    int ticksPerSecond = 0;         // tick rate of the simulation that recorded the session
+};
+
+class InputRecorder
+{
+public:
+    /// Constructs a recorder that is not recording yet.
+    InputRecorder();
+
+    /// Destructor, closes the file.
+    ~InputRecorder();
+
+    /**
+     * @brief Creates the log file and writes the header.
+     *
+     * @param path path of the log file.
+     * @param info session info.
+     * @return true if the file could be created, else false (an error message is printed).
+     */
+    bool open(const std::string &path, const SessionInfo &info);
+
+    /**
+     * @brief Appends the input of one tick (call right before Simulation::step with the same input).
+     *
+     * @param input input of the tick.
+     */
+    void record(const PlayerInput &input);
+
+    /// Flushes and closes the file.
+    void close();
+
+    /// Returns true while recording.
+    bool isOpen() const;
+
+    /// Returns the number of ticks recorded.
+    unsigned long long getTicks() const;
+
+private:
+    std::ofstream file;       // log file
+    unsigned long long ticks; // number of ticks recorded
+};
+
+class InputReplay
+{
+public:
+    /// Constructs a replay without a log.
+    InputReplay();
+
+    /**
+     * @brief Opens a log file and reads the header.
+     *
+     * @param path path of the log file.
+     * @return true if the file is a valid log, else false (an error message is printed).
+     */
+    bool open(const std::string &path);
+
+    /// Returns the session info from the header.
+    const SessionInfo &getInfo() const;
+
+    /**
+     * @brief Reads the input of the next tick.
+     *
+     * @param input set to the input of the tick.
+     * @return true if there was another tick, false at the end of the log.
+     */
+    bool next(PlayerInput &input);
+
+    /// Returns the number of ticks read so far.
+    unsigned long long getTicks() const;
+
+private:
+    std::ifstream file;       // log file
+    SessionInfo info;         // session info from the header
+    unsigned long long ticks; // number of ticks read
+};
+
+#endif /*__INPUT_LOG__*/
@@ -0,0 +1,203 @@
+/**
+ * job_system.h
+ *
+ * This file contains a small work-stealing thread pool (JobSystem) with a parallel-for
+ * and a task graph (TaskGraph). Every thread has its own job queue: a thread takes jobs from the
+ * back of its own queue and, when that is empty, steals from the front of the other queues.
+ * The thread that waits for work (normally the main thread, which keeps the GL context)
+ * runs jobs too instead of blocking.
+ *
+ * Long jobs that nobody waits for (like loading assets) can be queued with async; they only run on the workers.
+ *
+ * Deterministic mode: parallelFor splits a range into chunks that only depend on the range and the grain,
+ * never on the number of threads. Kernels that write per slot (and merge per-chunk results in chunk order)
+ * then give the same results with 1 thread as with 16, which makes bugs reproducible.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __JOB_SYSTEM_H__
+#define __JOB_SYSTEM_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// A set of tasks with dependencies between them, run by JobSystem::run. The graph must be acyclic.
+class TaskGraph
+{
+public:
+    /**
+     * @brief Adds a task to the graph.
+     *
+     * @param task function to run.
+     * @return int id of the task.
+     */
+    int add(std::function<void()> task);
+
+    /**
+     * @brief Adds a dependency: task after only starts once task before has finished.
+     *
+     * @param before id of the task that runs first.
+     * @param after id of the task that has to wait.
+     */
+    void precede(int before, int after);
+
+    /// Removes all tasks.
+    void clear();
+
+    /// Returns the number of tasks.
+    int size() const;
+
+private:
+    friend class JobSystem;
+
+    struct Node
+    {
+        std::function<void()> task;
+        std::vector<int> successors; // tasks that wait for this one
+        int dependencies = 0;        // number of tasks this one waits for
+    };
+    std::vector<Node> nodes;
+};
+
+class JobSystem
+{
+public:
+    static const int DETERMINISTIC_GRAIN; // chunk size used by parallelFor in deterministic mode when no grain is given
+    static const int MIN_GRAIN;           // smallest chunk size picked automatically
+
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param threads total number of threads including the calling thread (0 = one per core, 1 = no workers).
+     * @param deterministic if true, parallelFor chunks do not depend on the number of threads.
+     */
+    JobSystem(int threads = 0, bool deterministic = false);
+
+    /// Finishes the queued jobs and joins the worker threads.
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    /**
+     * @brief Splits [begin, end) into chunks and runs body(chunkBegin, chunkEnd) for every chunk,
+     * spread over all threads. Returns once all chunks are done.
+     * A single chunk (or a pool with one thread) runs directly on the calling thread, in order.
+     *
+     * @param begin first index.
+     * @param end one past the last index.
+     * @param grain chunk size (0 = automatic, see chunkSize).
+     * @param body function that processes one chunk.
+     */
+    void parallelFor(int begin, int end, int grain, const std::function<void(int, int)> &body);
+
+    /**
+     * @brief Runs all tasks of the graph, respecting the dependencies. Returns once all tasks are done.
+     * A graph with a cycle is reported and not run at all.
+     *
+     * @param graph task graph.
+     */
+    void run(TaskGraph &graph);
+
+    /**
+     * @brief Queues a job and returns right away; the job runs on a worker thread (on the calling thread if there are
+     * no workers). The job must not call parallelFor or run. The destructor waits for queued async jobs.
+     * Threads that wait in parallelFor or run can pick up async jobs too, so give long async jobs their own JobSystem.
+     *
+     * @param job function to run.
+     */
+    void async(std::function<void()> job);
+
+    /**
+     * @brief Returns the chunk size parallelFor uses for a range.
+     * Chunk i of a range starting at begin covers [begin + i * size, begin + (i + 1) * size),
+     * so kernels can use it to index per-chunk output.
+     *
+     * @param count number of indices in the range.
+     * @param grain requested chunk size (0 = automatic).
+     * @return int chunk size.
+     */
+    int chunkSize(int count, int grain) const;
+
+    /// Returns the total number of threads (including the calling thread).
+    int getThreadCount() const;
+
+    /// Returns true if the job system runs in deterministic mode.
+    bool isDeterministic() const;
+
+private:
+    struct Job
+    {
+        std::function<void()> run;
+        std::atomic<int> *counter; // decremented once the job is done (nullptr for async jobs)
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    int threads;                             // total number of threads
+    bool deterministic;                      // chunking independent of threads?
+    std::unique_ptr<WorkQueue[]> queues;     // one queue per thread, queue 0 belongs to the calling thread(s)
+    std::vector<std::thread> workers;        // worker threads (threads - 1)
+    std::atomic<int> queued;                 // number of jobs waiting in the queues
+    std::mutex sleepMutex;                   // protects sleeping workers
+    std::condition_variable wake;            // wakes sleeping workers when jobs are pushed
+    bool running;                            // false once the destructor runs
+
+    /**
+     * @brief Pushes a job on the queue of the current thread.
+     *
+     * @param job job to push.
+     */
+    void push(Job job);
+
+    /// Wakes up sleeping workers after jobs were pushed.
+    void notify();
+
+    /**
+     * @brief Runs one job: from the back of the thread's own queue or, if that one is empty,
+     * stolen from the front of another queue.
+     *
+     * @param index queue of the current thread.
+     * @return true if a job was run.
+     */
+    bool runOne(int index);
+
+    /**
+     * @brief Runs jobs until the counter reaches zero.
+     *
+     * @param counter counter of the jobs to wait for.
+     */
+    void wait(std::atomic<int> &counter);
+
+    /**
+     * @brief Loop of a worker thread: runs jobs and sleeps when there are none.
+     *
+     * @param index queue of the worker.
+     */
+    void workerLoop(int index);
+};
+
+/**
+ * @brief Same as JobSystem::parallelFor, but runs body(begin, end) on the calling thread when jobs is null
+ * (for code that can run with or without a job system).
+ *
+ * @param jobs job system or nullptr.
+ * @param begin first index.
+ * @param end one past the last index.
+ * @param grain chunk size (0 = automatic).
+ * @param body function that processes one chunk.
+ */
+void runParallel(JobSystem *jobs, int begin, int end, int grain, const std::function<void(int, int)> &body);
+
+#endif /*__JOB_SYSTEM__*/
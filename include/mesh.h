@@ -15,8 +15,11 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "gl_object.h"
 #include "shader.h"
 
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -34,25 +37,47 @@ struct Vertex
     float m_Weights[MAX_BONE_INFLUENCE]; // weights from each bone
 };
 
+// texture object shared through the resource registry, deleted with its last reference (see resource_registry.h).
+struct TextureObject
+{
+    unsigned int id;   // texture ID
+    std::size_t bytes; // estimated GPU memory (the pixels as uploaded, plus the mipmaps)
+};
+
 // store texture data in a texture struct.
 struct Texture
 {
     unsigned int id;  // texture ID
     std::string type; // type of texture: diffuse, specular, etc.
     std::string path; // path to texture
+    std::shared_ptr<const TextureObject> object; // keeps the texture alive while a mesh uses it
 };
 
 class Mesh
 {
 public:
-    // mesh Data
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
+    // mesh Data (the vertices and indices only live on the GPU)
+    unsigned int indexCount;
     std::vector<Texture> textures;
-    unsigned int VAO;
+    glm::vec3 boundsMin;  // minimum corner of the bounding box of the vertices
+    glm::vec3 boundsMax;  // maximum corner of the bounding box of the vertices
+    std::size_t gpuBytes; // size of the vertex and index buffers
+    GLVertexArray VAO;    // deleted with the mesh (meshes can be moved, not copied)
 
-    /// Constructor (here we give the mesh all the necessary data).
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
+    /**
+     * @brief Constructor (here we give the mesh all the necessary data). The vertices and indices are uploaded
+     * straight from the given memory (e.g. a mapped mesh cache) and not kept.
+     * 
+     * @param vertices vertices.
+     * @param vertexCount number of vertices.
+     * @param indices indices (triangles).
+     * @param indexCount number of indices.
+     * @param textures textures.
+     * @param boundsMin minimum corner of the bounding box of the vertices.
+     * @param boundsMax maximum corner of the bounding box of the vertices.
+     */
+    Mesh(const Vertex *vertices, unsigned int vertexCount, const unsigned int *indices, unsigned int indexCount,
+         std::vector<Texture> textures, glm::vec3 boundsMin, glm::vec3 boundsMax);
 
     /**
      * @brief Renders the mesh. Here we give a shader to the Draw function; by passing the shader to the mesh
@@ -62,11 +87,29 @@ public:
      */
     void Draw(Shader &shader);
 
+    /**
+     * @brief Renders instances of the mesh with one draw call. The per-instance data must be set up
+     * as instanced vertex attributes in the VAO of the mesh (see glVertexAttribDivisor).
+     * 
+     * @param shader shader.
+     * @param instances number of instances.
+     */
+    void DrawInstanced(Shader &shader, unsigned int instances);
+
 private:
     // render data
-    unsigned int VBO, EBO;
+    GLBuffer VBO, EBO;
+
+    /**
+     * @brief Initializes all the buffer objects/arrays.
+     * 
+     * @param vertices vertices.
+     * @param vertexCount number of vertices.
+     * @param indices indices.
+     */
+    void setupMesh(const Vertex *vertices, unsigned int vertexCount, const unsigned int *indices);
 
-    /// Initializes all the buffer objects/arrays.
-    void setupMesh();
+    /// Binds the textures of the mesh and links the samplers of the shader to their texture units.
+    void bindTextures(Shader &shader);
 };
 #endif /*__MESH__*/
\ No newline at end of file
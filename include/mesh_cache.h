@@ -0,0 +1,110 @@
+/**
+ * mesh_cache.h
+ *
+ * This file contains a MeshCache class that stores the meshes of a model in a binary file next to the model
+ * (model path + EXTENSION), so the model does not have to be imported with Assimp again on the next start.
+ * The file holds the vertices and indices exactly as they are uploaded (one blob per mesh), the bounds of every mesh
+ * and the textures named by the materials. It is mapped into memory with mmap and the blobs are handed to
+ * glBufferData straight from the mapping, so loading a cached model copies nothing on the CPU.
+ * The cache is a plain memory dump (it is only read on the machine that wrote it) and is made again when
+ * the hash of the model or its material library does not match.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __MESH_CACHE_H__
+#define __MESH_CACHE_H__
+
+#include <glm/glm.hpp>
+
+#include "mesh.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// Texture of a mesh as named by its material (the texture itself is loaded by Model).
+struct MeshTextureRef
+{
+    std::string type; // type of texture (texture_diffuse, texture_specular, texture_normal or texture_height)
+    std::string path; // path to the texture, relative to the model directory
+};
+
+/// Mesh data of an imported model, written to the cache.
+struct MeshData
+{
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<MeshTextureRef> textures;
+    glm::vec3 boundsMin; // minimum corner of the bounding box of the vertices
+    glm::vec3 boundsMax; // maximum corner of the bounding box of the vertices
+};
+
+/// Mesh in a mapped cache file, the vertices and indices point into the mapping.
+struct CachedMesh
+{
+    const Vertex *vertices;
+    unsigned int vertexCount;
+    const unsigned int *indices;
+    unsigned int indexCount;
+    std::vector<MeshTextureRef> textures;
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+};
+
+class MeshCache
+{
+public:
+    static const char *EXTENSION; // appended to the path of the model to get the path of its cache
+    static const int VERSION;     // format version, increase it when the file layout or the import settings change
+
+    /// Constructs an empty cache (nothing mapped).
+    MeshCache();
+
+    /// Unmaps the file.
+    ~MeshCache();
+
+    MeshCache(const MeshCache &) = delete;
+    MeshCache &operator=(const MeshCache &) = delete;
+
+    /**
+     * @brief Maps a cache file and checks it: it must have this version, be made from a source with the given hash
+     * and hold all the data its header promises.
+     *
+     * @param path path to the cache file.
+     * @param sourceHash hash of the model (see hashSource).
+     * @return true if the cache is valid (getMeshes holds its meshes), else false (nothing is mapped).
+     */
+    bool open(const std::string &path, unsigned long long sourceHash);
+
+    /// Unmaps the file, the pointers of the meshes are invalid afterwards.
+    void close();
+
+    /// Returns the meshes of the mapped cache (empty if none is mapped).
+    const std::vector<CachedMesh> &getMeshes() const;
+
+    /**
+     * @brief Writes meshes to a cache file.
+     *
+     * @param path path to the cache file.
+     * @param sourceHash hash of the model (see hashSource).
+     * @param meshes meshes of the model.
+     * @return true if the file was written, else false.
+     */
+    static bool write(const std::string &path, unsigned long long sourceHash, const std::vector<MeshData> &meshes);
+
+    /**
+     * @brief Hashes a model file and the material library next to it (same name with .mtl, if there is one).
+     *
+     * @param path path to the model.
+     * @return unsigned long long hash (0 if the model can not be read).
+     */
+    static unsigned long long hashSource(const std::string &path);
+
+private:
+    void *data;                      // mapped file (nullptr if none)
+    size_t size;                     // size of the mapped file in bytes
+    std::vector<CachedMesh> meshes;  // meshes in the mapping
+};
+
+#endif /*__MESH_CACHE__*/
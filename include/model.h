@@ -2,6 +2,10 @@
  * model.h
  *
  * This file contains a class to load and render an obj/mtl 3D model.
+ * The meshes are imported with Assimp once and cached in a binary file next to the model (see mesh_cache.h).
+ * Models own their meshes on the GPU and are not copied: get them from the ResourceRegistry (resource_registry.h),
+ * so every user of a model shares the same one.
+ * Reading the file (ModelFile) needs no OpenGL and can run on any thread; creating the meshes (Model::addMesh) uploads them.
  * 
  * Original author: Joey de Vries (from learnopengl)
  * Modified by EtoileScintillante.
@@ -20,6 +24,7 @@
 #include <assimp/postprocess.h>
 
 #include "mesh.h"
+#include "mesh_cache.h"
 #include "shader.h"
 #include "texture_loading.h"
 
@@ -30,6 +35,55 @@
 #include <map>
 #include <vector>
 
+/// The meshes of a model file, read without OpenGL (so it can happen on a worker thread, see asset_loader.h).
+class ModelFile
+{
+public:
+    std::string directory;           // model directory
+    std::vector<CachedMesh> meshes;  // the meshes (pointing into the mapped cache or into imported)
+
+    /**
+     * @brief Reads a model: maps its mesh cache if that was made from this model, otherwise imports it with ASSIMP
+     * (supported extensions) and writes the cache.
+     * 
+     * @param path filepath to the model.
+     * @return true if the model could be read, else false.
+     */
+    bool read(std::string const &path);
+
+private:
+    MeshCache cache;                 // mapped mesh cache (if it was valid)
+    std::vector<MeshData> imported;  // meshes imported with ASSIMP (if there was no valid cache)
+
+    /**
+     * @brief Processes a node in a recursive fashion: 
+     * processes each individual mesh located at the node and repeats this process on its children nodes (if any).
+     * 
+     * @param node aiNode* node.
+     * @param scene aiScene* scene.
+     */
+    void processNode(aiNode *node, const aiScene *scene);
+
+    /**
+     * @brief Processes the data of a mesh (vertices, indices, bounds and the textures of its material).
+     * 
+     * @param mesh aiMesh* mesh.
+     * @param scene aiScene* scene.
+     * @return MeshData 
+     */
+    MeshData processMesh(aiMesh *mesh, const aiScene *scene);
+
+    /**
+     * @brief Appends the paths of all material textures of a given type.
+     * 
+     * @param mat materials (aiMaterial*).
+     * @param type type of texture (aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_HEIGHT, aiTextureType_AMBIENT).
+     * @param typeName name of texture (how texture is defined in shader).
+     * @param textures the textures are appended here.
+     */
+    void materialTextures(aiMaterial *mat, aiTextureType type, std::string typeName, std::vector<MeshTextureRef> &textures);
+};
+
 class Model 
 {
 public:
@@ -42,6 +96,10 @@ public:
     
     /// Default constructor.
     Model();
+
+    // the meshes are deleted on the GPU with the model (the textures once no model uses them anymore)
+    Model(const Model &) = delete;
+    Model &operator=(const Model &) = delete;
     
     /**
      * @brief Constructs a new Model object.
@@ -55,41 +113,35 @@ public:
     /// Draws the model, and thus all its meshes.
     void Draw(Shader &shader);
 
+    /// Draws instances of the model, one draw call per mesh (see Mesh::DrawInstanced).
+    void DrawInstanced(Shader &shader, unsigned int instances);
+
     /// Only draws mesh at given index.
     void drawSpecificMesh(Shader &shader, int index);
-    
-private:
-    /// Loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
-    void loadModel(std::string const &path);
 
     /**
-     * @brief Processes a node in a recursive fashion: 
-     * processes each individual mesh located at the node and repeats this process on its children nodes (if any).
+     * @brief Uploads a mesh of a model file and adds it to the meshes vector (its textures are loaded if needed).
+     * Set directory and flipVertically first.
      * 
-     * @param node aiNode* node.
-     * @param scene aiScene* scene.
+     * @param mesh mesh of a ModelFile.
      */
-    void processNode(aiNode *node, const aiScene *scene);
+    void addMesh(const CachedMesh &mesh);
 
-    /**
-     * @brief Processes the data of a mesh (vertices, indices and textures).
-     * 
-     * @param mesh aiMesh* mesh.
-     * @param scene aiScene* scene.
-     * @return Mesh 
-     */
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene);
+    /// Returns the estimated GPU memory of the meshes and textures of the model.
+    std::size_t getGpuBytes() const;
+    
+private:
+    /// Reads a model file and adds all of its meshes.
+    void loadModel(std::string const &path);
 
     /**
-     * @brief Checks all material textures of a given type and loads the textures if they're not loaded yet. 
-     * The required info is returned as a Texture struct.
+     * @brief Loads the textures of a mesh if they're not loaded yet (through the resource registry, so models share them).
+     * The required info is returned as Texture structs.
      * 
-     * @param mat materials (aiMaterial*).
-     * @param type type of texture (aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_HEIGHT, aiTextureType_AMBIENT).
-     * @param typeName name of texture (how texture is defined in shader).
+     * @param refs textures of the mesh.
      * @return std::vector<Texture>
      */
-    std::vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName);
+    std::vector<Texture> loadTextures(const std::vector<MeshTextureRef> &refs);
 };
 
 #endif /*__MODEL__*/
\ No newline at end of file
@@ -3,6 +3,8 @@
  *
  * This file contains a Player class (basically a camera).
  * There is no real player character; it's basically just a gun with a bounding box.
+ * The gameplay state of the player lives in the simulation (see PlayerState in sim_state.h);
+ * this class polls the input, follows the simulated player with the camera, renders the gun and plays its sounds.
  * Based on the camera class made by Joey de Vries (from learnopengl).
  *
  * Created by EtoileScintillante.
@@ -11,87 +13,36 @@
 #ifndef __PLAYER_H__
 #define __PLAYER_H__
 
-#include "terrain_constants.h"
+#include <memory>
+#include <vector>
+
+#include "sim_state.h"
 #include "model.h"
 #include "shader.h"
-#include "box.h"
+#include "resource_registry.h"
 #include "miniaudio.h"
 #include <GLFW/glfw3.h>
 
 class Player
 {
 public:
-    // defines several possible options for player movement
-    enum Player_Movement
-    {
-        FORWARD,
-        BACKWARD,
-        LEFT,
-        RIGHT
-    };
-    // player movement limits
-    static const float BOTTOM_LIMIT_X; // bottom limit x plane
-    static const float UPPER_LIMIT_X;  // upper limit x plane
-    static const float BOTTOM_LIMIT_Z; // bottom limit z ppane
-    static const float UPPER_LIMIT_Z;  // upper limit z plane
-    // default player values
-    static const float YAW;         // euler angle related
-    static const float PITCH;       // euler angle related
-    static const float SPEED;       // movement speed
-    static const float SENSITIVITY; // mouse sensitivity
-    static const float ZOOM;        // needed to set projection matrix
+    static const float ZOOM; // needed to set projection matrix
     // screen dimensions (used to set the projection matrix)
     static const int SCR_HEIGHT;
     static const int SCR_WIDTH;
-    // other player attributes (view space related)
-    glm::vec3 Position; // position of player, this is also where the player first starts.
+    // camera attributes (view space related), these follow the simulated player
+    glm::vec3 Position; // position of camera
     glm::vec3 Front;    // front vector
     glm::vec3 Up;       // up vector
     glm::vec3 Right;    // right vector
-    glm::vec3 WorldUp;  // world up vector
-    // euler Angles
-    float Yaw;
-    float Pitch;
-    // player movement options
-    float MovementSpeed;
-    float MouseSensitivity;
     // mouse
     double xPosIn; // mouse x position input
     double yPosIn; // mouse y position input
-    // gun related
-    bool shot; // has player taken a shot?
     // time
     float currentFrame; // current time/frame
-    // collisions
-    AABBox boundingBox; // bounding box for collision detection (the bounding box is a cuboid, positioned behind the gun)
-    // game
-    float range; // range of bullet
 
-    /**
-     * @brief Constructs a new Player object with vectors.
-     * Also initializes player related objects like the gun and audio objects.
-     *
-     * @param position player position vector.
-     * @param up player up vector.
-     * @param yaw yaw value.
-     * @param pitch pitch value.
-     */
-    Player(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH);
-
-    /**
-     * @brief Constructs a new Player object with scalar values.
-     * Also initializes player related objects like the gun and audio objects.
-     *
-     * @param posX x value of position vector.
-     * @param posY y value of position vector.
-     * @param posZ z value of position vector.
-     * @param upX x value of up vector.
-     * @param upY y value of up vector.
-     * @param upZ z value of up vector.
-     * @param yaw yaw value.
-     * @param pitch pitch value.
-     */
-    Player(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch);
+    /// Constructs a new Player object. Also initializes player related objects like the gun and audio objects.
+    Player();
 
     /// Destructor.
     ~Player();
@@ -123,8 +74,14 @@ public:
     /// Returns the maximum shots available after a reload.
     int getMaxShotsBeforeReload() const;
 
-    /// Update player's kill count.
-    void updateKills();
+    /**
+     * @brief Follows the simulated player with the camera, plays sounds for the events
+     * of the simulation and animates the gun. Call this before rendering the frame.
+     *
+     * @param state player state of the simulation.
+     * @param events events emitted by the simulation since the last frame.
+     */
+    void follow(const PlayerState &state, const std::vector<SimEvent> &events);
 
     /// Controls the rendering of the player (the gun).
     void controlPlayerRendering();
@@ -132,39 +89,30 @@ public:
     /// Resets all values in case player wants to restart the game.
     void resetAll();
 
-    /// Decreases player's health by damage and plays damage sound effect.
-    void gotAttacked(float damage);
-
     /**
-     * @brief Processes all player input (keyboard + mouse).
+     * @brief Polls all player input (keyboard + mouse). Key states are overwritten,
+     * mouse offsets are added to the offsets that have not been simulated yet.
      *
      * @param window window pointer.
-     * @param deltaTime delta time (time passed between two frames).
+     * @param input input for the next simulation tick.
      */
-    void processKeyboardMouse(GLFWwindow *window, float deltaTime);
+    void processKeyboardMouse(GLFWwindow *window, PlayerInput &input);
 
 private:
     // gun related
-    Model gun;                // gun model
-    Shader shader;            // gun shader
+    std::shared_ptr<Model> gun;     // gun model (shared with the laser beams of the enemies)
+    std::shared_ptr<Shader> shader; // gun shader
     glm::vec3 gunPosition;    // (base) position for gun
     glm::mat4 gunModelMatrix; // model matrix for gun
-    float angle;              // recoil animation: this angle will be updated every frame to make the gun rotate up or down
-    bool startRecoil;         // start recoil animation?
-    bool goDown;              // recoil animation: gun needs to move down if true
-    int shotsRemaining;       // shots left before reload animation starts
-    bool isReloading;         // is the gun currently reloading?
-    float reloadStartTime;    // time when reload animation started
-    glm::mat4 reloadBaseModelMatrix; // gun transform captured when reload starts
+    glm::mat4 gunBaseMatrix;  // gun transform without recoil or reload animation
+    bool showGunFire;         // render gunfire this frame?
     // player movement control (mouse input)
-    bool isWalking;  // is player walking?
     bool firstMouse; // first time moving mouse?
     double lastX;    // last x position of mouse
     double lastY;    // last y position of mouse
     // audio
     ma_engine engine;             // miniaudio engine
     ma_sound walkingSound;        // sound object for walking soundeffect (needed to control looping of sound)
-    int soundCount;               // needed to make sure that the gunshot will only be played once every shot
     std::string gunshotSoundPath; // path to gunshot wav file
     std::string walkSoundPath;    // path to walking wav file
     std::string damageSoundPath;  // path to damage wav
@@ -173,12 +121,7 @@ private:
     glm::mat4 projection;   // projection matrix
     glm::mat4 viewLocalMat; // view matrix with positional information removed (needed for rendering the gun)
     // game
-    bool isAlive; // is player alive?
-    float health; // player's health (initialized at 100)
-    int kills;    // kill counter
-    
-    // for when resetting player
-    glm::vec3 origPosition; // original position of player when starting game for first time
+    PlayerState state; // player state of the simulation, as of the last rendered frame
 
     /// Renders gun.
     void drawGun();
@@ -186,29 +129,12 @@ private:
     /// Renders gunfire.
     void drawGunFire();
 
-    /**
-     * @brief Processes keyboard input.
-     *
-     * @param direction player movement direction (enum).
-     * @param deltaTime time passed between two frames.
-     */
-    void ProcessKeyboard(Player_Movement direction, float deltaTime);
-
-    /**
-     * @brief Processes window input; controls attributes shot and isWalking and forwards the input
-     * towards ProcessKeyboard method to process it further.
-     *
-     * @param window glfw window.
-     * @param deltaTime time passed between two frames.
-     */
-    void processInput(GLFWwindow *window, float deltaTime);
-
     /**
      * @brief Processes input received from a mouse input system.
      *
-     * @param constrainPitch limits pitch to a maximum of 90 degrees up and 45 degrees down if true.
+     * @param input input to which the mouse offsets are added.
      */
-    void ProcessMouseMovement(GLboolean constrainPitch = true);
+    void ProcessMouseMovement(PlayerInput &input);
 
     /// When player is not moving create slow up and down movement to make player look alive.
     void passiveMotion();
@@ -222,24 +148,15 @@ private:
     /// Sets gun model matrix.
     void setGunModelMatrix();
 
-    /// Starts recoil animation for gun (gun starts rotating up).
-    void startRecoilAnimation();
-
-    /// Starts second part of recoil animation: gun rotates down to base position.
-    void endRecoilAnimation();
-
-    /// Starts reload animation after the magazine is empty.
-    void startReloadAnimation();
+    /// Rotates the gun up and back down while the gun recovers from a shot.
+    void updateRecoilAnimation();
 
     /// Moves the gun out of view and back in during reload.
     void updateReloadAnimation();
 
-    /// Calculates the front vector from the Player's (updated) Euler Angles.
+    /// Sets the camera vectors from the simulated player.
     void updatePlayerVectors();
 
-    /// Creates bounding box for player.
-    void createBoundingBox();
-
     /// Sets up audio related objects.
     void audioSetup();
 };
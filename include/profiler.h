@@ -0,0 +1,98 @@
+/**
+ * profiler.h
+ *
+ * This file contains a small instrumentation profiler: scoped zones, counters and frame markers
+ * that can be saved as a Chrome trace (open the file in chrome://tracing or https://ui.perfetto.dev).
+ * Every thread records into its own ring buffer (no locks while recording, the oldest events are overwritten
+ * once the ring is full), so zones can also be placed in code that runs on the job system's workers.
+ *
+ * Use the PROFILE_* macros instead of the classes: they only do something when the game is configured with
+ * -DENABLE_PROFILER=ON (which defines DRONE_PROFILER), otherwise they compile to nothing.
+ * Names must be string literals (only the pointer is stored).
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <cstdint>
+#include <string>
+
+class Profiler
+{
+public:
+    static const int RING_SIZE; // number of events kept per thread
+
+    /// Returns the time in nanoseconds since the profiler was first used.
+    static std::uint64_t now();
+
+    /**
+     * @brief Records a zone that has ended (called by ProfileZone).
+     *
+     * @param name name of the zone.
+     * @param start start time (see now).
+     * @param end end time (see now).
+     */
+    static void zone(const char *name, std::uint64_t start, std::uint64_t end);
+
+    /**
+     * @brief Records the value of a counter (shown as a graph in the trace).
+     *
+     * @param name name of the counter.
+     * @param value value.
+     */
+    static void counter(const char *name, double value);
+
+    /// Marks the end of a frame.
+    static void frame();
+
+    /// Names the calling thread in the trace (e.g. "main", "worker 1").
+    static void setThreadName(const std::string &name);
+
+    /**
+     * @brief Writes the events of all threads to a file in the Chrome trace_event JSON format.
+     * Threads may keep recording meanwhile, events that get overwritten while writing can come out garbled.
+     *
+     * @param path path to the file.
+     * @return true if the file was written, else false.
+     */
+    static bool writeChromeTrace(const std::string &path);
+};
+
+/// Measures the time until the end of the scope it is declared in.
+class ProfileZone
+{
+public:
+    /// Starts the zone.
+    explicit ProfileZone(const char *name) : name(name), start(Profiler::now()) {}
+
+    /// Ends the zone and records it.
+    ~ProfileZone() { Profiler::zone(name, start, Profiler::now()); }
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+    const char *name;    // name of the zone
+    std::uint64_t start; // start time
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef DRONE_PROFILER
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) Profiler::counter(name, static_cast<double>(value))
+#define PROFILE_FRAME() Profiler::frame()
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#define PROFILE_SAVE(path) Profiler::writeChromeTrace(path)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_COUNTER(name, value) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_SAVE(path) ((void)0)
+#endif
+
+#endif /*__PROFILER__*/
@@ -0,0 +1,61 @@
+/**
+ * random_streams.h
+ *
+ * This file contains the seeded random number streams used by the game.
+ * Every consumer (drone spawning, drone aim, world layout, ...) gets its own stream derived from one seed,
+ * so a session can be reproduced from its seed and its inputs (see input_log.h), and drawing more numbers
+ * in one place does not change the numbers drawn somewhere else.
+ * The standard distributions are implementation defined, so the helpers below are used instead:
+ * they give the same numbers with every standard library.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __RANDOM_STREAMS_H__
+#define __RANDOM_STREAMS_H__
+
+#include <random>
+
+/// The independent random streams derived from a seed.
+enum class RandomStream
+{
+    DRONE_SPAWN,       // drone spawn positions
+    DRONE_AIM,         // random offset of the drone lasers
+    WORLD_ENVIRONMENT, // environment picked when none (or an invalid one) was selected
+    WORLD_LAYOUT,      // tree and flower/rock/pumpkin positions
+    WORLD_ROTATION     // rotation of the flowers/rocks/pumpkins
+};
+
+/// Returns a fresh seed from the hardware (for sessions that are not replayed).
+unsigned int randomSeed();
+
+/**
+ * @brief Creates the generator of one random stream.
+ *
+ * @param seed seed of the session.
+ * @param stream which stream.
+ * @return std::mt19937 generator.
+ */
+std::mt19937 makeRandomStream(unsigned int seed, RandomStream stream);
+
+/**
+ * @brief Returns a random integer in [min, max].
+ *
+ * @param gen generator.
+ * @param min minimum value.
+ * @param max maximum value.
+ * @return int random integer.
+ */
+int randomInt(std::mt19937 &gen, int min, int max);
+
+/**
+ * @brief Returns a random float in [min, max).
+ *
+ * @param gen generator.
+ * @param min minimum value.
+ * @param max maximum value.
+ * @return float random float.
+ */
+float randomFloat(std::mt19937 &gen, float min, float max);
+
+#endif /*__RANDOM_STREAMS__*/
@@ -0,0 +1,45 @@
+/**
+ * ray_batch.h
+ *
+ * This file contains a batched ray vs bounding box test: one ray against many boxes stored as
+ * a structure of arrays (min/max per axis), returning the nearest box that is hit within a maximum distance.
+ * The boxes are tested 8 at a time with AVX2 (when compiled with -mavx2, see the ENABLE_AVX2 CMake option),
+ * 4 at a time with SSE (any x86-64 build), and one at a time otherwise.
+ * Boxes with min > max (e.g. +inf/-inf for unused slots) are never hit.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __RAY_BATCH_H__
+#define __RAY_BATCH_H__
+
+#include "ray.h"
+
+/// Bounding boxes stored as one array per bound and axis (indexed by box).
+struct BoxArrays
+{
+    const float *minX, *minY, *minZ;
+    const float *maxX, *maxY, *maxZ;
+};
+
+/**
+ * @brief Finds the nearest box in [begin, end) that the ray hits within maxDistance.
+ * On equal distances the box with the lowest index wins, so all code paths give the same result.
+ *
+ * @param ray ray object (distances are measured in units of the ray's direction vector).
+ * @param boxes bounding boxes.
+ * @param begin first box.
+ * @param end one past the last box.
+ * @param maxDistance maximum distance.
+ * @param distance set to the distance where the ray enters the nearest box (0 if it starts inside), if a box was hit.
+ * @return int index of the nearest box, -1 if no box was hit.
+ */
+int nearestRayHit(const Ray &ray, const BoxArrays &boxes, int begin, int end, float maxDistance, float &distance);
+
+/// Same as nearestRayHit, but always tests one box at a time (reference for the SIMD code paths).
+int nearestRayHitScalar(const Ray &ray, const BoxArrays &boxes, int begin, int end, float maxDistance, float &distance);
+
+/// Returns the widest instruction set nearestRayHit uses in this build ("AVX2", "SSE" or "scalar").
+const char *rayBatchInstructionSet();
+
+#endif /*__RAY_BATCH__*/
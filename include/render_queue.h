@@ -0,0 +1,86 @@
+/**
+ * render_queue.h
+ *
+ * This file contains a RenderQueue class and DrawItem struct.
+ * Instead of binding state and drawing right away, systems submit draw items to the queue. Every item gets a 64-bit
+ * sort key (layer, program, texture, vertex array and depth, from most to least significant), so sorting the items
+ * puts draws that share state next to each other, and flush binds the state through GLState, which skips
+ * what is already bound (see gl_state.h). The queue counts how often the state changes between its draws.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __RENDER_QUEUE_H__
+#define __RENDER_QUEUE_H__
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <vector>
+
+/// Everything needed for one (instanced) draw call.
+struct DrawItem
+{
+    unsigned int layer = 0;        // draw order between groups of items, lower layers are drawn first (0-15)
+    float depth = 0.0f;            // distance to the camera in [0, 1], items that share state are drawn front to back
+    GLuint program = 0;            // shader program
+    GLuint VAO = 0;                // vertex array
+    GLuint texture = 0;            // 2D texture bound to texture unit 0 (0 = none)
+    GLenum mode = GL_TRIANGLES;    // primitive type
+    GLsizei count = 0;             // number of indices (or vertices if not indexed)
+    bool indexed = true;           // draw with the element buffer of the VAO (unsigned int indices)
+    GLsizei instanceCount = 1;     // number of instances (the instance data is part of the VAO)
+};
+
+/// Statistics of the draws since the last resetStats call (per flush, after sorting).
+struct RenderQueueStats
+{
+    unsigned int draws = 0;            // draw calls
+    unsigned int programBinds = 0;     // draws with a different program than the draw before
+    unsigned int textureBinds = 0;     // draws with a different texture than the draw before
+    unsigned int vertexArrayBinds = 0; // draws with a different vertex array than the draw before
+    unsigned int redundantBinds = 0;   // binds that were not needed because the draw before used the same state
+};
+
+class RenderQueue
+{
+public:
+    /**
+     * @brief Encodes the sort key of a draw item.
+     * Program, texture and vertex array names are truncated to their bit range (12, 16 and 16 bits),
+     * names that collide only sort less well, the draws are still correct.
+     *
+     * @param item draw item.
+     * @return 64-bit key: layer (4 bits), program (12), texture (16), vertex array (16), depth (16).
+     */
+    static std::uint64_t sortKey(const DrawItem &item);
+
+    /**
+     * @brief Adds an item to the queue (drawn by the next flush).
+     *
+     * @param item draw item.
+     */
+    void submit(const DrawItem &item);
+
+    /// Sorts the queued items by their key, draws them with as few state changes as possible and empties the queue.
+    void flush();
+
+    /// Sets all statistics to 0.
+    void resetStats();
+
+    /// Returns the statistics of the draws since the last resetStats call.
+    const RenderQueueStats &getStats() const;
+
+private:
+    /// A queued item with its sort key.
+    struct Entry
+    {
+        std::uint64_t key;
+        DrawItem item;
+    };
+
+    std::vector<Entry> entries; // items submitted since the last flush
+    RenderQueueStats stats;     // draw and bind statistics
+};
+
+#endif /*__RENDER_QUEUE__*/
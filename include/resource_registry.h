@@ -0,0 +1,109 @@
+/**
+ * resource_registry.h
+ *
+ * This file contains a ResourceRegistry class that shares models, textures and shader programs between everything
+ * that uses them. A resource is loaded the first time it is asked for and handed out as a shared_ptr;
+ * asking again while a reference is held returns the same one, so e.g. all enemies and the player share one
+ * handgun model and one set of shaders. The resource is deleted (also on the GPU) when its last reference is released.
+ * Resources are keyed by their paths (and load options). Only use the registry on the thread that owns the OpenGL context.
+ * Resources loaded elsewhere (see asset_loader.h) are handed to the registry with the add functions.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __RESOURCE_REGISTRY_H__
+#define __RESOURCE_REGISTRY_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mesh.h"
+#include "shader.h"
+
+class Model;
+
+/// Number of resources in the registry and how often they were requested.
+struct ResourceRegistryStats
+{
+    unsigned int models = 0;   // models alive
+    unsigned int textures = 0; // textures alive (2D textures and cubemaps)
+    unsigned int shaders = 0;  // shader programs alive
+    unsigned int loads = 0;    // requests that loaded/compiled a resource
+    unsigned int hits = 0;     // requests that returned a resource that was alive already
+};
+
+class ResourceRegistry
+{
+public:
+    /**
+     * @brief Returns a model, loads it if nobody holds it.
+     *
+     * @param path filepath to the model.
+     * @param flipVertically flip the textures vertically on load or not?
+     * @return std::shared_ptr<Model> model.
+     */
+    static std::shared_ptr<Model> getModel(const std::string &path, bool flipVertically);
+
+    /**
+     * @brief Returns a 2D texture, loads it if nobody holds it (see TextureFromFile).
+     *
+     * @param filename filename.
+     * @param directory directory where filename is located.
+     * @param flipVertically flip texture vertically on load or not?
+     * @return std::shared_ptr<const TextureObject> texture.
+     */
+    static std::shared_ptr<const TextureObject> getTexture(const std::string &filename, const std::string &directory, bool flipVertically);
+
+    /**
+     * @brief Returns a cubemap, loads it if nobody holds it (see loadCubemap).
+     *
+     * @param faces paths to the 6 faces of the cubemap (+X, -X, +Y, -Y, +Z, -Z).
+     * @return std::shared_ptr<const TextureObject> cubemap.
+     */
+    static std::shared_ptr<const TextureObject> getCubemap(const std::vector<std::string> &faces);
+
+    /**
+     * @brief Returns a shader program, compiles it if nobody holds it.
+     *
+     * @param vertexPath path to vertex shader.
+     * @param fragmentPath path to fragment shader.
+     * @param geometryPath path to geometry shader ("" if there is none).
+     * @param defines names that are #defined in every stage (see Shader).
+     * @return std::shared_ptr<Shader> shader.
+     */
+    static std::shared_ptr<Shader> getShader(const std::string &vertexPath, const std::string &fragmentPath,
+                                             const std::string &geometryPath = "", const std::vector<std::string> &defines = {});
+
+    /// Returns a model if somebody holds it, else nullptr (nothing is loaded).
+    static std::shared_ptr<Model> findModel(const std::string &path, bool flipVertically);
+
+    /// Returns a 2D texture if somebody holds it, else nullptr (nothing is loaded).
+    static std::shared_ptr<const TextureObject> findTexture(const std::string &filename, const std::string &directory, bool flipVertically);
+
+    /// Returns a cubemap if somebody holds it, else nullptr (nothing is loaded).
+    static std::shared_ptr<const TextureObject> findCubemap(const std::vector<std::string> &faces);
+
+    /**
+     * @brief Adds a model that was loaded elsewhere, as if getModel(path, flipVertically) had loaded it.
+     * If that model is alive already, the given one is deleted and the one that is alive is returned.
+     *
+     * @param path filepath to the model.
+     * @param flipVertically were the textures flipped vertically on load?
+     * @param model the model, the registry takes ownership.
+     * @return std::shared_ptr<Model> model.
+     */
+    static std::shared_ptr<Model> addModel(const std::string &path, bool flipVertically, Model *model);
+
+    /// Adds a 2D texture that was loaded elsewhere and takes ownership of it (see addModel), bytes is its estimated GPU memory.
+    static std::shared_ptr<const TextureObject> addTexture(const std::string &filename, const std::string &directory, bool flipVertically,
+                                                           unsigned int id, std::size_t bytes);
+
+    /// Adds a cubemap that was loaded elsewhere and takes ownership of it (see addTexture).
+    static std::shared_ptr<const TextureObject> addCubemap(const std::vector<std::string> &faces, unsigned int id, std::size_t bytes);
+
+    /// Returns the number of resources alive and the number of loads and hits so far.
+    static ResourceRegistryStats getStats();
+};
+
+#endif /*__RESOURCE_REGISTRY__*/
@@ -2,6 +2,9 @@
  * shader.h
  *
  * This file contains a shader class to make compiling and using shaders easier.
+ * The locations of all active uniforms are looked up once after linking, so the setters do not have to
+ * ask OpenGL for the location by name on every call. A Camera uniform block is bound to the camera
+ * uniform buffer (see camera_uniforms.h).
  * 
  * Original author: Joey de Vries (from learnopengl)
  * Modified by EtoileScintillante.
@@ -14,6 +17,8 @@
 #include <glm/glm.hpp>
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -26,8 +31,15 @@ public:
     /// Default constructor.
     Shader();
 
-    /// Constructor with paths to shaders (it generates the shaders on the fly).
-    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+    /**
+     * @brief Constructor with paths to shaders (it generates the shaders on the fly).
+     * 
+     * @param vertexPath path to vertex shader.
+     * @param fragmentPath path to fragment shader.
+     * @param geometryPath path to geometry shader (optional).
+     * @param defines names that are #defined in every stage (after the #version line), to compile variants of the same source.
+     */
+    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr, const std::vector<std::string> &defines = {});
 
     /// Activates the shader.
     void use() const;
@@ -133,9 +145,22 @@ public:
      * @param mat glm::mat4.
      */
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
+
+    /**
+     * @brief Returns the location of a uniform from the table filled at link time.
+     * 
+     * @param name name of uniform.
+     * @return GLint location, -1 if the program has no active uniform with that name (setting it does nothing).
+     */
+    GLint getUniformLocation(const std::string &name) const;
     
 private:
+    std::unordered_map<std::string, GLint> uniformLocations; // locations of the active uniforms by name
+
     /// Utility function for checking shader compilation/linking errors.
     void checkCompileErrors(GLuint shader, std::string type);
+
+    /// Fills the uniform location table and binds the Camera block (if any) to its binding point.
+    void reflectUniforms();
 };
 #endif /*__SHADER__*/
\ No newline at end of file
@@ -0,0 +1,66 @@
+/**
+ * shader_permutations.h
+ *
+ * This file contains a ShaderPermutations class: one shader source compiled into variants (permutations).
+ * Every feature of the source is a name the shader checks with #ifdef; a permutation is a bit mask of features
+ * (bit i = features[i]) and is compiled with those names #defined the first time it is requested, then cached.
+ * The geometry shader is only attached to permutations that enable one of its features,
+ * so variants that do not need it skip geometry shading entirely.
+ * The shaders come from the ResourceRegistry, so permutation sets of the same source share their programs.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __SHADER_PERMUTATIONS_H__
+#define __SHADER_PERMUTATIONS_H__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "shader.h"
+#include "resource_registry.h"
+
+class ShaderPermutations
+{
+public:
+    /// Default constructor.
+    ShaderPermutations();
+
+    /**
+     * @brief Constructs a new Shader Permutations object (nothing is compiled yet).
+     *
+     * @param vertexPath path to vertex shader.
+     * @param fragmentPath path to fragment shader.
+     * @param geometryPath path to geometry shader ("" if there is none).
+     * @param features names of the features (at most 32), in bit order.
+     * @param geometryFeatures mask of the features that need the geometry shader.
+     */
+    ShaderPermutations(const std::string &vertexPath, const std::string &fragmentPath, const std::string &geometryPath,
+                       const std::vector<std::string> &features, unsigned int geometryFeatures = 0);
+
+    /**
+     * @brief Returns the shader of a permutation, compiles it if it is not in the cache yet.
+     *
+     * @param permutation mask of the enabled features.
+     * @return Shader& compiled shader (stays valid, permutations are never removed from the cache).
+     */
+    Shader &get(unsigned int permutation);
+
+    /// Returns the mask of a feature by name (0 if there is no such feature).
+    unsigned int feature(const std::string &name) const;
+
+    /// Returns the number of permutations that have been compiled.
+    size_t compiledCount() const;
+
+private:
+    std::string vertexPath;                                          // path to vertex shader
+    std::string fragmentPath;                                        // path to fragment shader
+    std::string geometryPath;                                        // path to geometry shader (optional)
+    std::vector<std::string> features;                               // feature names, in bit order
+    unsigned int geometryFeatures;                                   // features that need the geometry shader
+    std::unordered_map<unsigned int, std::shared_ptr<Shader>> cache; // compiled permutations
+};
+
+#endif /*__SHADER_PERMUTATIONS__*/
@@ -0,0 +1,119 @@
+/**
+ * sim_state.h
+ *
+ * This file contains the plain game state that is owned by the simulation (see simulation.h):
+ * player input, player state, drone state and the events the simulation emits.
+ * Nothing in here touches OpenGL or audio, so the state can be updated without a window.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __SIM_STATE_H__
+#define __SIM_STATE_H__
+
+#include <glm/glm.hpp>
+
+#include "terrain_constants.h"
+#include "box.h"
+
+/// Player input for one simulation tick.
+struct PlayerInput
+{
+    bool forward = false;  // W / arrow up
+    bool backward = false; // S / arrow down
+    bool left = false;     // A / arrow left
+    bool right = false;    // D / arrow right
+    bool shoot = false;    // space
+    float mouseDX = 0.0f;  // horizontal mouse offset (in pixels) since the last tick
+    float mouseDY = 0.0f;  // vertical mouse offset (in pixels) since the last tick, positive is up
+};
+
+/// Gameplay state of the player (position, orientation, gun and health).
+struct PlayerState
+{
+    // default player values
+    static const float YAW;                   // euler angle related
+    static const float PITCH;                 // euler angle related
+    static const float SPEED;                 // movement speed in units per second
+    static const float SENSITIVITY;           // mouse sensitivity
+    static const float MAX_HEALTH;            // health at the start of a game
+    static const int MAX_SHOTS_BEFORE_RELOAD; // magazine size
+    static const float RECOIL_DURATION;       // time in seconds before the gun can fire again
+    static const float RELOAD_DURATION;       // time in seconds a reload takes
+    // player movement limits
+    static const float BOTTOM_LIMIT_X;
+    static const float UPPER_LIMIT_X;
+    static const float BOTTOM_LIMIT_Z;
+    static const float UPPER_LIMIT_Z;
+
+    // orientation
+    glm::vec3 position = glm::vec3(0.0f);                  // position of player (on ground level)
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f);        // front vector (also the direction of the bullet)
+    glm::vec3 right = glm::vec3(1.0f, 0.0f, 0.0f);         // right vector
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);            // up vector
+    float yaw = YAW;
+    float pitch = PITCH;
+    bool isWalking = false;                                // did the player move this tick?
+    // gun related
+    bool shot = false;                                     // true while the gun recovers from a shot
+    bool bulletFired = false;                              // true only on the tick the shot was taken
+    float shotTime = 0.0f;                                 // time passed since the last shot
+    bool isReloading = false;                              // is the gun currently reloading?
+    float reloadTime = 0.0f;                               // time passed since the reload started
+    int shotsRemaining = MAX_SHOTS_BEFORE_RELOAD;          // shots left before reloading
+    float range = Terrain::SIZE * 2;                       // range of bullet
+    // game
+    float health = MAX_HEALTH;                             // player's health
+    int kills = 0;                                         // kill counter
+    bool isAlive = true;                                   // is player alive?
+    AABBox boundingBox;                                    // cuboid positioned behind the gun (see docs/player_bbox)
+};
+
+/// Gameplay state of a single drone (the simulation stores drones as arrays, see drone_swarm.h).
+struct DroneState
+{
+    // default drone values
+    static const float MAX_FLOAT_HEIGHT; // maximum floating height of drone, measured from y = 0
+    static const float MIN_FLOAT_HEIGHT; // minimum floating height of drone, measured from y = 0
+    static const float ATTACK_INTERVAL;  // time in seconds between attacks
+    static const float SPAWN_INTERVAL;   // time in seconds between drone dying and spawning again
+    static const float EXPLODE_DURATION; // duration of the explosion animation in seconds
+    static const float DAMAGE;           // amount of damage the drone does to the player per hit
+    static const float SPEED;            // movement speed of drone in units per tick
+    static const float SCALE;            // scale of the drone model (the bounding box is based on it)
+    static const float RANGE;            // range of laser beam
+
+    glm::vec3 position = glm::vec3(0.0f);       // position of drone
+    float rotation = 0.0f;                      // rotation angle around the y axis in radians (points towards player)
+    float attackTime = 0.0f;                    // time passed since the last attack
+    bool isDead = false;                        // is drone dead?
+    float explodeTime = 0.0f;                   // time passed since the drone got shot
+    float spawnInterval = 0.0f;                 // time passed since the explosion ended
+    float magnitude = 0.0f;                     // how far the explosion has spread
+    bool canDamage = false;                     // to ensure that a laser only damages the player once
+    glm::vec3 laserDirection = glm::vec3(0.0f); // direction of the last laser beam
+    AABBox boundingBox;                         // drone bounding box (see docs/enemy_bbox)
+
+    /// Returns true if the drone should be rendered (alive or still exploding).
+    bool isVisible() const { return !isDead || explodeTime <= EXPLODE_DURATION; }
+};
+
+/// Things that happened during a simulation tick, used by the renderer to play sounds and effects.
+enum class SimEventType
+{
+    PLAYER_SHOT,     // player fired the gun
+    RELOAD_STARTED,  // player's magazine is empty and the reload started
+    PLAYER_HIT,      // a laser hit the player
+    PLAYER_DIED,     // player has no health left
+    LASER_FIRED,     // a drone fired its laser
+    DRONE_KILLED,    // a drone got shot
+    DRONE_RESPAWNED  // a drone spawned in a new position
+};
+
+struct SimEvent
+{
+    SimEventType type;
+    int drone; // index of the drone involved, -1 if no drone is involved
+};
+
+#endif /*__SIM_STATE__*/
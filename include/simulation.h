@@ -0,0 +1,152 @@
+/**
+ * simulation.h
+ *
+ * This file contains the Simulation class, which owns all gameplay state:
+ * the player, the drones and the collisions between them.
+ * The simulation advances in fixed ticks and never makes OpenGL or audio calls,
+ * so it can run headless (see tools/headless_sim.cpp). The renderer only reads its state
+ * and reacts to the events emitted during a tick. Since frames and ticks don't line up, the renderer
+ * blends the state of the last two ticks (see interpolatePlayer and DroneSwarm::getInterpolated).
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __SIMULATION_H__
+#define __SIMULATION_H__
+
+#include <vector>
+#include <random>
+
+#include "sim_state.h"
+#include "drone_swarm.h"
+#include "collision_detection.h"
+#include "job_system.h"
+#include "random_streams.h"
+
+class Simulation
+{
+public:
+    static const float TIMESTEP;       // duration of one tick in seconds
+    static const float MAX_FRAME_TIME; // longest frame time to catch up on, longer frames slow the game down instead
+    static const int MAX_DRONES;       // default max number of drones that can exist in the game
+    static const float SPAWN_INTERVAL; // default time in seconds between new drones joining the game
+    PlayerState player;                // player state
+    DroneSwarm drones;                 // state of all drones that joined the game
+    int maxDrones;                     // max number of drones that can exist in the game
+    float spawnInterval;               // time in seconds between new drones joining the game (0 = all at once)
+    float spawnTime;                   // needed to control the joining of new drones
+    float time;                        // simulated time in seconds
+    unsigned long long tick;           // number of ticks simulated
+
+    /**
+     * @brief Constructs a new Simulation with the player at the start position and no drones in the game.
+     * Use a large maxDrones and a spawnInterval of 0 for a horde mode.
+     *
+     * @param maxDrones max number of drones that can exist in the game.
+     * @param spawnInterval time in seconds between new drones joining the game (0 = all join at once).
+     */
+    Simulation(int maxDrones = MAX_DRONES, float spawnInterval = SPAWN_INTERVAL);
+
+    /**
+     * @brief Advances the game by exactly one tick (TIMESTEP seconds).
+     * Does nothing once the player is dead.
+     *
+     * @param input player input for this tick.
+     */
+    void step(const PlayerInput &input);
+
+    /**
+     * @brief Sets the seed of the random streams (drone spawn positions and aim) and resets the game.
+     * The same seed, obstacles and inputs give the same game (see input_log.h).
+     *
+     * @param seed seed.
+     */
+    void setSeed(unsigned int seed);
+
+    /// Returns the seed of the random streams (a random one unless setSeed was called).
+    unsigned int getSeed() const;
+
+    /**
+     * @brief Returns the player state with its position and orientation blended between the previous tick
+     * and the current one (for rendering between ticks).
+     *
+     * @param alpha blend factor, 0 = previous tick, 1 = current tick (time not simulated yet / TIMESTEP).
+     * @return PlayerState player state.
+     */
+    PlayerState interpolatePlayer(float alpha) const;
+
+    /**
+     * @brief Lets the drone updates and the collision grid update run on a job system.
+     * Without one (the default) everything runs on the calling thread.
+     *
+     * @param jobs job system or nullptr.
+     */
+    void setJobSystem(JobSystem *jobs);
+
+    /**
+     * @brief Sets the static obstacles (trees, rocks, ...) that block bullets and lasers. They stay after a reset.
+     *
+     * @param obstacles bounding boxes of the obstacles.
+     */
+    void setObstacles(const std::vector<AABBox> &obstacles);
+
+    /**
+     * @brief Finds the living drones within a radius of a point (uses the collision grid, so it stays cheap for large swarms).
+     *
+     * @param center center of the search area.
+     * @param radius radius of the search area.
+     * @param out vector the drone slots are appended to.
+     */
+    void findDrones(glm::vec3 center, float radius, std::vector<int> &out);
+
+    /// Resets all state (in case the game gets restarted). The random streams start over from the seed.
+    void reset();
+
+    /// Returns the events emitted since the last call to clearEvents.
+    const std::vector<SimEvent> &getEvents() const;
+
+    /// Clears the emitted events (call once they have been handled).
+    void clearEvents();
+
+private:
+    CollisionDetector detector;   // handles collisions between bullets, lasers, player and drones
+    JobSystem *jobs;              // spreads the drone kernels over threads (optional)
+    PlayerState previousPlayer;   // player state before the last tick (for render interpolation)
+    std::vector<SimEvent> events; // events emitted since the last clearEvents
+    std::vector<int> firing;      // scratch: slots of the drones that fire this tick
+    std::vector<float> aimOffset; // scratch: random aim offset per firing drone
+    unsigned int seed;            // seed of the random streams
+    std::mt19937 spawnRng;        // generator for drone spawn positions
+    std::mt19937 aimRng;          // generator for the aim offset of the lasers
+
+    /**
+     * @brief Moves and rotates the player, and controls shooting and reloading.
+     *
+     * @param input player input for this tick.
+     */
+    void updatePlayer(const PlayerInput &input);
+
+    /// Lets a new drone join the game every spawnInterval seconds until maxDrones is reached.
+    void updateSpawning();
+
+    /// Controls life of the drones: moving, attacking, dying and spawning again.
+    void updateDrones();
+
+    /**
+     * @brief Calculates the front vector from the player's (updated) Euler Angles.
+     *
+     * @param state player state.
+     */
+    static void updatePlayerVectors(PlayerState &state);
+
+    /// Creates bounding box for player.
+    void createPlayerBoundingBox();
+
+    /// Returns a random spawn position for a drone (outside the inner square of the terrain).
+    glm::vec3 generateDronePosition();
+
+    /// Returns a random offset for the aim of a drone's laser.
+    float generateAimOffset();
+};
+
+#endif /*__SIMULATION__*/
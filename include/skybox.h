@@ -14,10 +14,12 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <iostream>
+#include <memory>
 #include <vector>
 
+#include "gl_object.h"
+#include "mesh.h"
 #include "shader.h"
-#include "texture_loading.h"
 
 class SkyBox {
 public:
@@ -38,17 +40,28 @@ public:
     SkyBox(std::vector< std::string > filenames, std::string dirName);
 
     /**
-     * @brief Draws the skybox.
+     * @brief Draws the skybox with the camera matrices in the camera uniform buffer (see camera_uniforms.h).
      * 
      * @param shader shader for skybox.
-     * @param cameraView camera view matrix.
-     * @param projection projection matrix.
      */
-    void Draw(Shader &shader, glm::mat4 cameraView, glm::mat4 projection);
+    void Draw(Shader &shader);
+
+    /// Returns the estimated GPU memory of the skybox (cubemap and vertex buffer).
+    std::size_t getGpuBytes() const;
+
+    /**
+     * @brief Returns the paths to the faces of a skybox (the cubemap is shared through the resource registry under these paths).
+     * 
+     * @param filenames filenames of the 6 faces (same order as in the constructor).
+     * @param dirName name of directory which contains the faces.
+     * @return std::vector<std::string> paths.
+     */
+    static std::vector<std::string> getFacePaths(const std::vector<std::string> &filenames, const std::string &dirName);
 
 private:
-    unsigned int skyboxTexture;
-    unsigned int VBO, VAO;
+    std::shared_ptr<const TextureObject> skyboxTexture; // cubemap (shared through the resource registry)
+    GLBuffer VBO;      // vertex buffer
+    GLVertexArray VAO; // vertex array (both are deleted with the skybox, which can be moved but not copied)
 
     /// Sets up buffers.
     void configureSkybox();
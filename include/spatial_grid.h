@@ -0,0 +1,182 @@
+/**
+ * spatial_grid.h
+ *
+ * This file contains a uniform grid (SpatialGrid) for broadphase collision queries.
+ * The grid splits a box shaped area into equally sized cells; every item (identified by an integer id,
+ * e.g. a drone slot) is stored in all cells that its bounding box or ray overlaps.
+ * Items are updated incrementally: moving an item only touches the grid when it enters other cells.
+ *
+ * Queries only look at the cells around the query shape, so their cost depends on how many items
+ * are nearby instead of on the total number of items:
+ *  - queryRay walks the cells along a ray with a 3D-DDA (Amanatides & Woo).
+ *  - queryRadius and queryBox visit the cells overlapping a sphere or box.
+ * Queries return candidates; the exact hit test is up to the caller.
+ * Items outside the grid area are clamped into the border cells.
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __SPATIAL_GRID_H__
+#define __SPATIAL_GRID_H__
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class SpatialGrid
+{
+public:
+    /**
+     * @brief Constructs an empty grid.
+     *
+     * @param min minimum corner of the area covered by the grid.
+     * @param max maximum corner of the area covered by the grid.
+     * @param cellSize edge length of a (cube shaped) cell.
+     */
+    SpatialGrid(glm::vec3 min, glm::vec3 max, float cellSize);
+
+    /**
+     * @brief Inserts an item with the given bounding box, or moves it if it is already in the grid.
+     * Does nothing if the item stays in the same cells.
+     *
+     * @param id id of the item (>= 0).
+     * @param min minimum bound of the item.
+     * @param max maximum bound of the item.
+     */
+    void insert(int id, glm::vec3 min, glm::vec3 max);
+
+    /**
+     * @brief Updates the bounding box of a box item without touching the cells.
+     * Only writes to the item itself, so different items can be updated from different threads
+     * (after reserve); items for which it returns true need an insert afterwards.
+     *
+     * @param id id of the item.
+     * @param min minimum bound of the item.
+     * @param max maximum bound of the item.
+     * @return true if the item is not in the grid yet or has to move to other cells.
+     */
+    bool update(int id, glm::vec3 min, glm::vec3 max);
+
+    /**
+     * @brief Makes room for items with ids below count (so update can be called from several threads).
+     *
+     * @param count number of ids.
+     */
+    void reserve(int count);
+
+    /**
+     * @brief Inserts an item that covers a ray segment (e.g. a laser beam), replacing its previous shape.
+     *
+     * @param id id of the item (>= 0).
+     * @param orig origin of the ray.
+     * @param dir direction of the ray (does not need to be normalized).
+     * @param length length of the segment.
+     */
+    void insertRay(int id, glm::vec3 orig, glm::vec3 dir, float length);
+
+    /**
+     * @brief Removes an item from the grid (does nothing if it is not in the grid).
+     *
+     * @param id id of the item.
+     */
+    void remove(int id);
+
+    /// Removes all items.
+    void clear();
+
+    /// Returns true if the item is in the grid.
+    bool contains(int id) const;
+
+    /**
+     * @brief Collects the items in the cells along a ray, roughly from near to far (every item once).
+     *
+     * @param orig origin of the ray.
+     * @param dir direction of the ray (does not need to be normalized).
+     * @param length length of the ray.
+     * @param out vector the ids are appended to.
+     */
+    void queryRay(glm::vec3 orig, glm::vec3 dir, float length, std::vector<int> &out);
+
+    /**
+     * @brief Collects the items whose bounding box lies (partly) within a radius of a point.
+     * Ray items in the overlapped cells are returned as candidates.
+     *
+     * @param center center of the sphere.
+     * @param radius radius of the sphere.
+     * @param out vector the ids are appended to.
+     */
+    void queryRadius(glm::vec3 center, float radius, std::vector<int> &out);
+
+    /**
+     * @brief Collects the items whose bounding box overlaps a box.
+     * Ray items in the overlapped cells are returned as candidates.
+     *
+     * @param min minimum bound of the box.
+     * @param max maximum bound of the box.
+     * @param out vector the ids are appended to.
+     */
+    void queryBox(glm::vec3 min, glm::vec3 max, std::vector<int> &out);
+
+private:
+    struct Entry
+    {
+        int item;  // id of the item
+        int index; // position of this cell in the item's cell list
+    };
+
+    // checked for every item on every update, so kept small (the cell lists live in separate arrays)
+    struct Item
+    {
+        glm::vec3 min, max;          // bounding box of a box item
+        glm::ivec3 cellMin, cellMax; // cell range of a box item
+        bool used = false;           // is the item in the grid?
+        bool isRay = false;          // ray item (cells along a ray) or box item (range of cells)
+    };
+
+    glm::vec3 origin;                      // minimum corner of the grid
+    float cellSize;                        // edge length of a cell
+    float inverseCellSize;                 // 1 / cellSize
+    glm::ivec3 dims;                       // number of cells along each axis
+    std::vector<std::vector<Entry>> cells; // items per cell
+    std::vector<Item> items;               // items by id
+    std::vector<std::vector<int>> itemCells;     // per item: cells the item is stored in
+    std::vector<std::vector<int>> itemPositions; // per item: position of the item in each of those cells
+    std::vector<unsigned> stamps;          // per item: last query that returned it (to return items only once)
+    unsigned stamp;                        // id of the current query
+    std::vector<int> scratch;              // scratch: cells along a ray
+
+    /// Returns the coordinates of the cell that contains the point (clamped to the grid).
+    glm::ivec3 cellCoords(glm::vec3 point) const;
+
+    /// Returns the index of a cell in cells.
+    int cellIndex(glm::ivec3 coords) const;
+
+    /// Makes sure the item arrays can hold the given id.
+    void grow(int id);
+
+    /**
+     * @brief Adds an item to a cell and remembers the position in the item's cell list.
+     *
+     * @param id id of the item.
+     * @param cell index of the cell.
+     */
+    void addToCell(int id, int cell);
+
+    /// Removes an item from all of its cells.
+    void removeFromCells(int id);
+
+    /// Starts a new query (every item can be returned once per query).
+    void nextStamp();
+
+    /**
+     * @brief Collects the cells along a ray with a 3D-DDA, in the order the ray passes them.
+     *
+     * @param orig origin of the ray.
+     * @param dir direction of the ray.
+     * @param length length of the ray.
+     * @param out vector the cell indices are appended to.
+     */
+    void rayCells(glm::vec3 orig, glm::vec3 dir, float length, std::vector<int> &out) const;
+};
+
+#endif /*__SPATIAL_GRID__*/
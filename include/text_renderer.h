@@ -3,6 +3,11 @@
  *
  * This file contains a TextRenderer class and Character struct to make text rendering easier.
  * Based on code from Joey de Vries (https://learnopengl.com/In-Practice/Text-Rendering).
+ * The glyphs are stored as signed distance fields (SDF) in one atlas texture: every texel holds the distance to the
+ * outline of the glyph, so the shader can draw the fill and a border of any width from the same texture and text
+ * stays sharp at any scale. The atlas is generated from the font at startup and cached next to the font (.sdf file).
+ * RenderText and RenderTextBordered only add quads (with their colors per vertex) to a batch,
+ * Flush draws the whole batch with a single draw call.
  * 
  * Created by EtoileScintillante.
  */
@@ -12,6 +17,7 @@
 
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -25,16 +31,25 @@
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
-#include FT_GLYPH_H
-#include FT_STROKER_H
 
 /// Holds all state information relevant to a character as loaded using FreeType.
 struct Character
 {
-    unsigned int TextureID; // ID handle of the glyph texture
-    glm::ivec2 Size;        // Size of glyph
-    glm::ivec2 Bearing;     // Offset from baseline to left/top of glyph
-    unsigned int Advance;   // Horizontal offset to advance to next glyph
+    glm::vec2 UVMin;      // Top left corner of the glyph in the atlas (texture coordinates)
+    glm::vec2 UVMax;      // Bottom right corner of the glyph in the atlas (texture coordinates)
+    glm::ivec2 Size;      // Size of glyph (including the distance field around it)
+    glm::ivec2 Bearing;   // Offset from baseline to left/top of glyph (including the distance field around it)
+    unsigned int Advance; // Horizontal offset to advance to next glyph
+};
+
+/// Vertex of a glyph quad in the text batch.
+struct TextVertex
+{
+    glm::vec2 Position;    // screen position
+    glm::vec2 TexCoords;   // position in the atlas
+    glm::vec3 Color;       // text color
+    glm::vec3 BorderColor; // border color
+    float BorderWidth;     // border width in distance field units (0 = no border)
 };
 
 class TextRenderer
@@ -46,7 +61,8 @@ public:
 
     /**
      * @brief Constructs a new Text Renderer object.
-     * Also initializes FreeType library, loads font and compiles shaders.
+     * Compiles the shaders and loads the glyph atlas from the cache file next to the font,
+     * or generates it with FreeType (and writes the cache) if there is no valid cache.
      * 
      * @param pathToFont path to font (ttf).
      * @param pathVertexShader path to vertex shader.
@@ -54,8 +70,13 @@ public:
      */
     TextRenderer(std::string pathToFont, std::string pathVertexShader, std::string pathFragmentShader);
 
+    static const int ATLAS_WIDTH;   // width of the glyph atlas in pixels (the height depends on the font size)
+    static const int GLYPH_SIZE;    // pixel size the glyphs are rasterized at (scale 1 in RenderText)
+    static const int SDF_SPREAD;    // distance in pixels (at GLYPH_SIZE) the distance field reaches beyond the outline
+    static const float BORDER_SIZE; // border width of RenderTextBordered in pixels at GLYPH_SIZE
+
     /**
-     * @brief Renders a line of text. Bottom left corner of screen is (x,y) = (0,0).
+     * @brief Adds a line of text to the batch (drawn by Flush). Bottom left corner of screen is (x,y) = (0,0).
      *
      * @param text text (string) to render.
      * @param x x position of text (of the first character).
@@ -75,8 +96,8 @@ public:
     float MeasureText(std::string_view text, float scale) const;
 
     /**
-     * @brief Renders text with a solid border using FT_Stroker-generated glyph outlines.
-     * Border pass renders first so the fill sits cleanly on top.
+     * @brief Adds text with a solid border to the batch (drawn by Flush).
+     * Fill and border come from the same distance field, so they need one quad per character.
      *
      * @param text text to render.
      * @param x x position.
@@ -87,20 +108,96 @@ public:
      */
     void RenderTextBordered(std::string_view text, float x, float y, float scale, glm::vec3 fillColor, glm::vec3 borderColor);
 
+    /**
+     * @brief Lays out a line of text like RenderText, but appends the quads to vertices instead of the batch,
+     * so text that does not change can be laid out once and added to the batch every frame with RenderVertices.
+     *
+     * @param vertices quads are appended here.
+     * @param text text.
+     * @param x x position of text (of the first character).
+     * @param y y position of text.
+     * @param scale scale factor.
+     * @param color color of text.
+     */
+    void LayoutText(std::vector<TextVertex> &vertices, std::string_view text, float x, float y, float scale, glm::vec3 color) const;
+
+    /// Same as LayoutText, for text with a border (see RenderTextBordered).
+    void LayoutTextBordered(std::vector<TextVertex> &vertices, std::string_view text, float x, float y, float scale, glm::vec3 fillColor, glm::vec3 borderColor) const;
+
+    /**
+     * @brief Adds quads made by LayoutText/LayoutTextBordered to the batch (drawn by Flush with the current projection matrix).
+     *
+     * @param vertices quads.
+     */
+    void RenderVertices(const std::vector<TextVertex> &vertices);
+
+    /**
+     * @brief Draws all text added since the last flush with one draw call (on top of everything, no depth test) and empties the batch.
+     * Also called when text is added after the projection matrix changed, since the batch uses one projection.
+     */
+    void Flush();
+
 private:
     std::string font;          // path to font
     FT_Library ft;             // FreeType Library
     FT_Face face;              // needed to load font as a face
-    Character characters[95];       // fill glyphs, covers ASCII 32–126
-    Character borderCharacters[95]; // stroked border glyphs, same range
+    Character characters[95];  // glyphs, covers ASCII 32–126
+    unsigned int atlasTexture; // distance fields of all glyphs
     Shader shader;             // shader
     unsigned int VBO, VAO;     // data buffers
+    size_t bufferCapacity;     // number of vertices VBO has room for
+    std::vector<TextVertex> batch; // quads of the text added since the last flush
+    glm::mat4 batchProjection;     // projection matrix of the batch
+
+    /**
+     * @brief Loads font as face and renders the distance fields of its glyphs into an atlas.
+     *
+     * @param atlas set to the pixels of the atlas (ATLAS_WIDTH x atlasHeight, one byte per pixel).
+     * @param atlasHeight set to the height of the atlas.
+     * @return true if the font could be loaded, else false.
+     */
+    bool loadFace(std::vector<unsigned char> &atlas, int &atlasHeight);
+
+    /**
+     * @brief Reads the atlas and glyph metrics from the cache file, if it was made from the same font with the same settings.
+     *
+     * @param path path to the cache file.
+     * @param fontHash hash of the font file.
+     * @param atlas set to the pixels of the atlas.
+     * @param atlasHeight set to the height of the atlas.
+     * @return true if the cache was valid, else false.
+     */
+    bool loadCache(const std::string &path, unsigned long long fontHash, std::vector<unsigned char> &atlas, int &atlasHeight);
 
-    /// Loads font as face.
-    void loadFace();
+    /**
+     * @brief Writes the atlas and glyph metrics to a cache file.
+     *
+     * @param path path to the cache file.
+     * @param fontHash hash of the font file.
+     * @param atlas pixels of the atlas.
+     * @param atlasHeight height of the atlas.
+     */
+    void saveCache(const std::string &path, unsigned long long fontHash, const std::vector<unsigned char> &atlas, int atlasHeight) const;
 
     /// Configures buffers for texture quads.
     void configBuffers();
+
+    /// Flushes the batch if the projection matrix changed since the batch was started.
+    void prepareBatch();
+
+    /**
+     * @brief Appends the quads of a line of text to a vertex array.
+     *
+     * @param vertices quads are appended here (the batch or a caller's array).
+     * @param text text.
+     * @param x x position of the first character.
+     * @param y y position (baseline).
+     * @param scale scale factor.
+     * @param color fill color.
+     * @param borderColor border color.
+     * @param borderWidth border width in distance field units (0 = no border).
+     */
+    void addQuads(std::vector<TextVertex> &vertices, std::string_view text, float x, float y, float scale, glm::vec3 color, glm::vec3 borderColor, float borderWidth) const;
 };
 
 #endif /*__TEXT_RENDERER__*/
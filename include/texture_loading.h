@@ -15,6 +15,7 @@
 #include <GLFW/glfw3.h>
 #include <stb_image.h>
 
+#include <cstddef>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -29,9 +30,10 @@
  * -Z (back)
  * 
  * @param faces paths to the 6 sides (faces) of the cubemap. Paths must be ordered as stated in function description.
- * @param ID unsigned int texture ID.
+ * @param bytes if not nullptr, the size of the uploaded faces is stored here.
+ * @return unsigned int texture ID.
  */
-void loadCubemap(std::vector<std::string> faces, unsigned int ID);
+unsigned int loadCubemap(std::vector<std::string> faces, std::size_t *bytes = nullptr);
 
 /**
  * @brief Loads a texture.
@@ -49,8 +51,9 @@ void loadTexture(std::string path, unsigned int ID, bool flipVertically);
  * @param directory directory where filename is located.
  * @param flipVertically flip texture vertically on load or not?
  * @param gamma gamma correction? Default is false.
+ * @param bytes if not nullptr, the size of the uploaded texture (with its mipmaps) is stored here.
  * @return unsigned int texture ID.
  */
-unsigned int TextureFromFile(const char *filename, const std::string &directory, bool flipVertically, bool gamma = false);
+unsigned int TextureFromFile(const char *filename, const std::string &directory, bool flipVertically, bool gamma = false, std::size_t *bytes = nullptr);
 
 #endif /*__TEXTURE_LOADING__*/
\ No newline at end of file
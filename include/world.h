@@ -10,12 +10,31 @@
 #ifndef __WORLD_H__
 #define __WORLD_H__
 
-#include <random>
-
 #include "terrain_constants.h"
 #include "shader.h"
 #include "model.h"
+#include "resource_registry.h"
 #include "skybox.h"
+#include "box.h"
+#include "world_layout.h"
+#include "gpu_timer.h"
+#include "render_queue.h"
+#include "frustum_culling.h"
+
+#include <cstddef>
+
+class AssetLoader;
+
+/// Models, textures and skybox of an environment (kept in the environment cache of World, see setCacheBudget).
+struct EnvironmentResources
+{
+    std::string type;                                   // desert, snow, forest, night
+    std::shared_ptr<Model> tree;                        // tree model
+    std::shared_ptr<Model> surrounding;                 // model for flowers/rocks/pumpkins
+    std::shared_ptr<const TextureObject> groundTexture; // ground texture
+    SkyBox skybox;                                      // skybox
+    std::size_t bytes = 0;                              // estimated GPU memory
+};
 
 class World
 {
@@ -23,18 +42,17 @@ public:
     // terrain settings
     static const unsigned int N_TREES;        // number of trees
     static const unsigned int N_SURROUNDINGS; // number of flowers/rocks/pumpkins
-    // matrices
-    glm::mat4 view;       // camera view matrix
-    glm::mat4 projection; // projection matrix
+    static const std::size_t DEFAULT_CACHE_BUDGET; // estimated GPU memory the environment cache may use
     // environment type
     std::string environmentType; // desert, snow, forest, night
     bool isLoaded;               // true after load() has been called
+    unsigned int seed;           // seed of the layout (and of the environment if it was picked randomly)
 
     /// Default constructor; constructs an empty World with no GPU resources allocated.
     World();
 
     /**
-     * @brief Convenience constructor: calls load(envType).
+     * @brief Convenience constructor: calls load(envType) with a random seed.
      *
      * @param envType The environment type (desert, snow, forest, night).
      */
@@ -44,19 +62,41 @@ public:
      * @brief Loads all GPU resources for the given environment.
      * Safe to call once the OpenGL context exists.
      * Randomly picks an environment if envType is empty or invalid.
+     * The models, textures and skyboxes of recently loaded environments are cached (see setCacheBudget),
+     * so loading one of them again uploads nothing.
+     *
+     * @param envType The environment type (desert, snow, forest, night).
+     * @param seed seed for the positions of the trees and flowers/rocks/pumpkins (the same seed gives the same world).
+     */
+    void load(const std::string& envType, unsigned int seed);
+
+    /**
+     * @brief Queues the models and textures of an environment on an asset loader, so load() finds them
+     * in the resource registry once the loader is idle. Nothing is queued for an invalid envType.
+     *
+     * @param envType The environment type (desert, snow, forest, night).
+     * @param loader asset loader.
+     */
+    static void requestAssets(const std::string& envType, AssetLoader &loader);
+
+    /**
+     * @brief Decodes the models and textures of an environment ahead on an asset loader (see AssetLoader::prefetchModel),
+     * so requestAssets only has to upload them. Nothing is prefetched for an invalid envType.
      *
      * @param envType The environment type (desert, snow, forest, night).
+     * @param loader asset loader.
      */
-    void load(const std::string& envType);
+    static void prefetchAssets(const std::string& envType, AssetLoader &loader);
 
     /**
      * @brief Renders the world (ground, trees, flowers/rocks/pumpkins and skybox).
      * Just returns if load() has not been called yet.
+     * The camera matrices come from the camera uniform buffer, update it first (see camera_uniforms.h).
+     * Trees and flowers/rocks/pumpkins outside the view frustum are culled.
      *
-     * @param view view matrix.
-     * @param projection projection matrix.
+     * @param viewProjection projection * view matrix of the camera (for culling).
      */
-    void Draw(glm::mat4 view, glm::mat4 projection);
+    void Draw(const glm::mat4 &viewProjection);
 
     /**
      * @brief Renders skybox.
@@ -65,28 +105,63 @@ public:
      */
     void drawSkyBox(bool grayscale);
 
+    /**
+     * @brief Sets the timer that measures the GPU time of the skybox, ground, surroundings and trees in Draw.
+     *
+     * @param timer GPU timer (nullptr = no timing, the default).
+     */
+    void setGpuTimer(GpuTimer *timer);
+
+    /**
+     * @brief Sets the estimated GPU memory the environment cache may use. The least recently loaded environments
+     * are released first (the loaded one is always kept).
+     *
+     * @param bytes budget in bytes (DEFAULT_CACHE_BUDGET by default).
+     */
+    void setCacheBudget(std::size_t bytes);
+
+    /// Returns the draw and bind statistics of the ground, surroundings and trees in the last Draw.
+    const RenderQueueStats &getRenderStats() const;
+
     /// Returns the tree positions.
     std::vector<glm::vec3> getTreePositions() const;
 
+    /// Returns bounding boxes of the trees and flowers/rocks/pumpkins (they block bullets and lasers in the simulation).
+    std::vector<AABBox> getObstacles() const;
+
 private:
-    // objects and shaders
-    Shader shaderModel;  // shader for flower/rock/pumpkin and tree models
-    Shader shaderGround; // ground shader
-    Shader shaderSkybox; // skybox shader
-    Model tree;          // tree model
-    Model surrounding;   // model for flowers/rocks/pumpkins
-    SkyBox skybox;       // skybox
+    // shaders and environments (the models and textures come from the resource registry and are released
+    // once an environment is dropped from the cache)
+    std::shared_ptr<Shader> shaderModel;               // shader for flower/rock/pumpkin and tree models
+    std::shared_ptr<Shader> shaderGround;              // ground shader
+    std::shared_ptr<Shader> shaderSkybox;              // skybox shader
+    std::shared_ptr<EnvironmentResources> environment; // loaded environment
+    // recently loaded environments, the most recent (the loaded one) first
+    std::vector<std::shared_ptr<EnvironmentResources>> environmentCache;
+    std::size_t cacheBudget;                           // estimated GPU memory the cached environments may use
+    GpuTimer *gpuTimer;                                // times the passes in Draw (optional)
+    // draw items (submitted to the render queue every frame)
+    RenderQueue renderQueue;                // sorts the draws of the ground, surroundings and trees
+    DrawItem groundDraw;                    // ground
+    std::vector<DrawItem> treeDraws;        // tree meshes (one per mesh and texture)
+    std::vector<DrawItem> surroundingDraws; // flower/rock/pumpkin meshes
     // object related attributes
-    std::vector<glm::vec3> treePos;        // tree positions
-    std::vector<glm::vec3> surroundingPos; // flower/rock/pumpkin positions
-    std::vector<float> groundVertices;     // ground vertex data
-    unsigned int groundTexture;            // ground texture
-    unsigned int groundVAO, groundVBO;     // buffers for ground data
-    unsigned int treeBuffer;               // buffer for tree models
-    unsigned int surroundingBuffer;        // buffer for flower/rock models
+    WorldLayout layout;                                 // tree and flower/rock/pumpkin positions
+    std::vector<float> groundVertices;                  // ground vertex data
+    GLVertexArray groundVAO;                            // ground vertex array (same for every environment)
+    GLBuffer groundVBO;                                 // ground vertex buffer
+    GLBuffer treeBuffer;                                // buffer for tree models (the visible ones, updated every frame)
+    GLBuffer surroundingBuffer;                         // buffer for flower/rock models (the visible ones, updated every frame)
     // matrix data (used for instancing)
     std::vector<glm::mat4> treeModelMatrices;        // tree model matrices
     std::vector<glm::mat4> surroundingModelMatrices; // flower/rock/pumpkin model matrices
+    // frustum culling
+    BoundingSpheres treeSpheres;             // bounding sphere per tree
+    BoundingSpheres surroundingSpheres;      // bounding sphere per flower/rock/pumpkin
+    std::vector<unsigned int> visible;       // indices of the visible instances (reused every frame)
+    std::vector<glm::mat4> visibleMatrices;  // model matrices of the visible instances (reused every frame)
+    unsigned int visibleTrees;               // number of trees in treeBuffer
+    unsigned int visibleSurroundings;        // number of flowers/rocks/pumpkins in surroundingBuffer
 
     /// Sets up all the objects so that they can be rendered.
     void setupWorld();
@@ -94,24 +169,39 @@ private:
     /// Clears generated per-environment data before loading another world.
     void clearWorldData();
 
-    /// Renders trees.
+    /**
+     * @brief Returns the resources of an environment from the cache, or loads them (through the resource registry).
+     * The environment becomes the most recent one in the cache, the least recent ones are dropped while the cache
+     * is over its budget.
+     *
+     * @param envType The environment type (desert, snow, forest, night).
+     * @return std::shared_ptr<EnvironmentResources> resources.
+     */
+    std::shared_ptr<EnvironmentResources> useEnvironment(const std::string& envType);
+
+    /// Renders the visible trees.
     void drawTrees();
 
     /// Renders ground.
     void drawGround();
 
-    /// Renders flowers/rocks/pumpkins.
+    /// Renders the visible flowers/rocks/pumpkins.
     void drawSurroundings();
 
+    /**
+     * @brief Culls instances against the view frustum and writes the model matrices of the visible ones to their buffer.
+     *
+     * @param frustum view frustum.
+     * @param spheres bounding spheres of the instances.
+     * @param modelMatrices model matrices of all instances.
+     * @param buffer instanced array buffer.
+     * @return unsigned int number of visible instances (at the start of the buffer).
+     */
+    unsigned int uploadVisibleInstances(const Frustum &frustum, const BoundingSpheres &spheres, const std::vector<glm::mat4> &modelMatrices, unsigned int buffer);
+
     /// Returns vertex data for ground. Data includes positions and texture coords.
     std::vector<float> getGroundVertexData() const;
 
-    /// Creates N_TREES random positions.
-    void createTreePositions();
-
-    /// Creates flower/rock/pumpkin positions.
-    void createSurroundingPositions();
-
     /// Creates model matrices for the trees.
     void createTreeModelMatrices();
 
@@ -122,11 +212,11 @@ private:
      * @brief Sets up an instanced array for a model.
      * 
      * @param model Model object.
-     * @param buffer instanced array buffer.
+     * @param buffer instanced array buffer (created if it does not exist yet).
      * @param modelMatrices vector containing the model matrices.
      * @param amount number of instances.
      */
-    void setupInstancedArray(Model &model, unsigned int buffer, std::vector<glm::mat4> modelMatrices, int amount);
+    void setupInstancedArray(Model &model, GLBuffer &buffer, const std::vector<glm::mat4> &modelMatrices, int amount);
 };
 
 #endif /*__WORLD__*/
@@ -0,0 +1,61 @@
+/**
+ * world_layout.h
+ *
+ * This file contains the WorldLayout class: where the trees and flowers/rocks/pumpkins of an environment stand.
+ * The layout only depends on the environment type and a seed, and does not need OpenGL,
+ * so the headless simulation can rebuild the obstacles of a recorded session (see input_log.h).
+ *
+ * Created by EtoileScintillante.
+ */
+
+#ifndef __WORLD_LAYOUT_H__
+#define __WORLD_LAYOUT_H__
+
+#include <string>
+#include <vector>
+
+#include "terrain_constants.h"
+#include "random_streams.h"
+#include "box.h"
+
+class WorldLayout
+{
+public:
+    static const unsigned int N_TREES;        // number of trees
+    static const unsigned int N_SURROUNDINGS; // number of flowers/rocks/pumpkins
+    std::vector<glm::vec3> treePositions;        // tree positions
+    std::vector<glm::vec3> surroundingPositions; // flower/rock/pumpkin positions
+    std::vector<float> surroundingRotations;     // rotation angle around the y axis in radians per flower/rock/pumpkin
+
+    /// Constructs an empty layout (no trees or flowers/rocks/pumpkins).
+    WorldLayout();
+
+    /**
+     * @brief Constructs the layout of an environment.
+     *
+     * @param environmentType environment type (desert, snow, forest, night), some models need a different height.
+     * @param seed seed of the random streams.
+     */
+    WorldLayout(const std::string &environmentType, unsigned int seed);
+
+    /// Returns bounding boxes of the trees and flowers/rocks/pumpkins (they block bullets and lasers in the simulation).
+    std::vector<AABBox> getObstacles() const;
+
+private:
+    /**
+     * @brief Creates N_TREES random positions.
+     *
+     * @param gen generator.
+     */
+    void createTreePositions(std::mt19937 &gen);
+
+    /**
+     * @brief Creates flower/rock/pumpkin positions that are not taken by a tree.
+     *
+     * @param environmentType environment type.
+     * @param gen generator.
+     */
+    void createSurroundingPositions(const std::string &environmentType, std::mt19937 &gen);
+};
+
+#endif /*__WORLD_LAYOUT__*/
@@ -1,4 +1,13 @@
 /// === Shoot drones! === ///
+/// Usage: Drone-Shooter [--record <file> | --replay <file>] [--gpu-log <file>] [--vram-budget <MB>]
+/// --record writes the input of the first game to a log, --replay plays a log back and prints the frame timing
+/// (see input_log.h).
+/// F3 shows the GPU time per render pass, the draw/bind counts of the world and the GL state changes per frame,
+/// --gpu-log appends the GPU times to a CSV file every frame (see gpu_timer.h).
+/// --vram-budget sets the estimated GPU memory the recently played maps may keep, so switching back to them is instant
+/// (see World::setCacheBudget).
+/// When built with -DENABLE_PROFILER=ON, F12 saves a Chrome trace of the last frames to profile.json
+/// (it is also saved on exit, see profiler.h).
 
 #include "game_state.h"
 #include "player.h"
@@ -7,115 +16,364 @@
 #include "hud.h"
 #include "glfw_setup.h"
 #include "enemy_manager.h"
-#include "collision_detection.h"
+#include "simulation.h"
+#include "job_system.h"
 #include "text_renderer.h"
+#include "input_log.h"
+#include "profiler.h"
+#include "gpu_timer.h"
+#include "camera_uniforms.h"
+#include "gl_state.h"
+#include "asset_loader.h"
+#include "resource_registry.h"
 
-int main()
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+int main(int argc, char *argv[])
 {
+    PROFILE_THREAD("main");
+    std::string mode;        // --record or --replay
+    std::string logPath;     // input log
+    std::string gpuLogPath;  // GPU timing log
+    long vramBudgetMB = -1;  // environment cache budget (-1 = default)
+    for (int i = 1; i < argc; i += 2)
+    {
+        std::string option = argv[i];
+        if (option != "--record" && option != "--replay" && option != "--gpu-log" && option != "--vram-budget")
+        {
+            std::cout << "ERROR: Unknown option " << option << std::endl;
+            std::cout << "Usage: " << argv[0] << " [--record <file> | --replay <file>] [--gpu-log <file>] [--vram-budget <MB>]" << std::endl;
+            return 1;
+        }
+        if (i + 1 >= argc)
+        {
+            std::cout << "ERROR: Option " << option << " needs a value" << std::endl;
+            return 1;
+        }
+        if (option == "--gpu-log")
+        {
+            gpuLogPath = argv[i + 1];
+        }
+        else if (option == "--vram-budget")
+        {
+            vramBudgetMB = std::max(0L, std::atol(argv[i + 1]));
+        }
+        else if (!mode.empty() && mode != option)
+        {
+            std::cout << "ERROR: --record and --replay can not be combined" << std::endl;
+            return 1;
+        }
+        else
+        {
+            mode = option;
+            logPath = argv[i + 1];
+        }
+    }
+
+    // input log (a log that can not be replayed is reported before the window opens)
+    InputRecorder recorder;
+    InputReplay replay;
+    bool replaying = mode == "--replay";
+    bool recording = mode == "--record";
+    if (replaying)
+    {
+        if (!replay.open(logPath))
+        {
+            return 1;
+        }
+        if (replay.getInfo().ticksPerSecond != static_cast<int>(std::lround(1.0f / Simulation::TIMESTEP)))
+        {
+            std::cout << "WARNING: session was recorded at " << replay.getInfo().ticksPerSecond << " ticks per second, the replay will differ" << std::endl;
+        }
+    }
+
     // initialize and configure glfw, load OpenGL function pointers and create window
     GLFWwindow *window = setup("Drone Shooter", Player::SCR_HEIGHT, Player::SCR_WIDTH);
 
-    // prepare game related objects
-    Player player;
-    World world; // loaded later, after player selects environment on start screen
-    EnemyManager manager;
-    CollisionDetector detector;
-    TextRenderer text("resources/font/theboldfont.ttf", "shaders/text.vert", "shaders/text.frag");
-
-    // game state
-    GameState state = GameState::START;
-
-    // environment selection
-    const std::string envNames[4] = {"desert", "forest", "snow", "night"};
-    int selectedEnv = 0;
-    bool wWasPressed = false;
-    bool sWasPressed = false;
-    bool enterWasPressed = false;
-
-    // timing
-    float currentFrame;
-    float deltaTime = 0.0f;
-    float lastFrame = 0.0f;
-
-    // render loop
-    while (!glfwWindowShouldClose(window))
+    // the game objects own OpenGL objects that they delete when they are destroyed, so they live in this block
+    // and are destroyed while the context still exists (before glfwTerminate)
     {
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // prepare game related objects
+        Player player;
+        World world; // loaded later, after player selects environment on start screen
+        if (vramBudgetMB >= 0)
+        {
+            world.setCacheBudget(static_cast<std::size_t>(vramBudgetMB) * 1024 * 1024);
+        }
+        EnemyManager manager;
+        JobSystem jobs; // worker threads for per-tick work (the main thread keeps the GL context)
+        Simulation sim; // gameplay state (player, drones and collisions), rendered by player, world and manager
+        sim.setJobSystem(&jobs);
+        TextRenderer text("resources/font/theboldfont.ttf", "shaders/text.vert", "shaders/text.frag");
+        GpuTimer gpuTimer; // GPU time per render pass
+        world.setGpuTimer(&gpuTimer);
+        if (!gpuLogPath.empty())
+        {
+            gpuTimer.openLog(gpuLogPath);
+        }
+        bool showGpuTimings = false;
+        GLStateStats glStateStats; // OpenGL state changes of the last frame
+        CameraUniforms camera; // view and projection matrix shared by the world and drone shaders
+        AssetLoader loader; // loads the selected environment on worker threads while the loading screen is shown
 
-        // per-frame time logic
-        currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
-        text.deltaTime = deltaTime;
+        // game state
+        GameState state = GameState::START;
 
-        // ESC always closes the window
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-            glfwSetWindowShouldClose(window, true);
+        // replay progress
+        bool replayFinished = false;
+        unsigned long long replayFrames = 0;
+        auto replayStart = std::chrono::steady_clock::now();
 
-        bool enterNow = glfwGetKey(window, GLFW_KEY_ENTER) == GLFW_PRESS;
+        // environment selection
+        const std::string envNames[4] = {"desert", "forest", "snow", "night"};
+        int selectedEnv = 0;
+        int prefetchedEnv = -1; // environment that was prefetched for last (-1 = none yet)
+        bool wWasPressed = false;
+        bool sWasPressed = false;
+        bool enterWasPressed = false;
+        bool f12WasPressed = false;
+        bool f3WasPressed = false;
 
-        switch (state)
+        // timing
+        float currentFrame;
+        float deltaTime = 0.0f;
+        float lastFrame = 0.0f;
+        float accumulator = 0.0f; // time that has not been simulated yet
+        float alpha = 0.0f;       // how far the rendered frame is between the last two ticks
+
+        // input for the next simulation tick
+        PlayerInput input;
+
+        // a replay skips the start screen and plays the recorded session in the recorded world
+        if (replaying)
         {
-            case GameState::START:
-            {
-                // navigate env selector with edge detection to avoid skipping entries
-                bool wNow = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS;
-                bool sNow = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS;
-                if (wNow && !wWasPressed) selectedEnv = (selectedEnv - 1 + 4) % 4;
-                if (sNow && !sWasPressed) selectedEnv = (selectedEnv + 1) % 4;
-                wWasPressed = wNow;
-                sWasPressed = sNow;
+            const SessionInfo &info = replay.getInfo();
+            world.load(info.environment, info.seed);
+            sim.maxDrones = info.maxDrones;
+            sim.spawnInterval = info.spawnInterval;
+            sim.setSeed(info.seed);
+            sim.setObstacles(world.getObstacles());
+            state = GameState::PLAYING;
+        }
 
-                startingScreen(text, player, selectedEnv);
+        // render loop
+        while (!glfwWindowShouldClose(window))
+        {
+            PROFILE_ZONE("frame");
+            gpuTimer.beginFrame();
+            glStateStats = GLState::getStats();
+            GLState::resetStats();
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-                if (enterNow && !enterWasPressed)
-                {
-                    world.load(envNames[selectedEnv]);
-                    state = GameState::PLAYING;
-                }
-                break;
-            }
+            // per-frame time logic
+            currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+            text.deltaTime = deltaTime;
+
+            // ESC always closes the window
+            if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+                glfwSetWindowShouldClose(window, true);
 
-            case GameState::PLAYING:
-                // pass timing to objects that need it
-                player.currentFrame = currentFrame;
-                manager.currentTime = currentFrame;
-                manager.deltaTime   = deltaTime;
-
-                // input, world, player, enemies, collisions, HUD
-                player.processKeyboardMouse(window, deltaTime);
-                world.Draw(player.GetViewMatrix(), player.getProjectionMatrix());
-                player.controlPlayerRendering();
-                manager.manage(player.Position, player.GetViewMatrix(), player.getProjectionMatrix());
-                detector.Detect(player, manager);
-                inGameScreen(text, player);
-
-                // transition when player dies
-                if (!player.getLifeState())
+            bool enterNow = glfwGetKey(window, GLFW_KEY_ENTER) == GLFW_PRESS;
+
+            // upload what the loader's workers decoded (a bounded amount per frame)
+            loader.update();
+
+            switch (state)
+            {
+                case GameState::START:
                 {
-                    manager.reset();
-                    state = GameState::GAME_OVER;
+                    // navigate env selector with edge detection to avoid skipping entries
+                    bool wNow = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS;
+                    bool sNow = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS;
+                    if (wNow && !wWasPressed) selectedEnv = (selectedEnv - 1 + 4) % 4;
+                    if (sNow && !sWasPressed) selectedEnv = (selectedEnv + 1) % 4;
+                    wWasPressed = wNow;
+                    sWasPressed = sNow;
+
+                    // decode the highlighted environment and its neighbours ahead, so Enter only has to upload them;
+                    // what was queued for the previous selection and did not start yet is dropped
+                    if (selectedEnv != prefetchedEnv)
+                    {
+                        loader.cancelPrefetches();
+                        World::prefetchAssets(envNames[selectedEnv], loader);
+                        World::prefetchAssets(envNames[(selectedEnv + 1) % 4], loader);
+                        World::prefetchAssets(envNames[(selectedEnv + 3) % 4], loader);
+                        prefetchedEnv = selectedEnv;
+                    }
+
+                    startingScreen(text, player, selectedEnv);
+
+                    if (enterNow && !enterWasPressed)
+                    {
+                        // load the models and textures of the environment on the workers, the loading screen is shown meanwhile
+                        // (prefetches of the other environments that did not start yet make way for it)
+                        loader.cancelPrefetches();
+                        World::requestAssets(envNames[selectedEnv], loader);
+                        prefetchedEnv = -1; // prefetch again when the start screen comes back
+                        state = GameState::LOADING;
+                    }
+                    break;
                 }
-                break;
 
-            case GameState::GAME_OVER:
-                endingScreen(text, player);
-                if (enterNow && !enterWasPressed)
+                case GameState::LOADING:
                 {
-                    player.resetAll();
-                    state = GameState::START;
+                    loadingScreen(text, player, selectedEnv, loader.getProgress());
+
+                    if (loader.isIdle())
+                    {
+                        // new seed for every game, the world and the simulation share it so a recording can rebuild both
+                        // (the world finds its models and textures in the resource registry now)
+                        sim.setSeed(randomSeed());
+                        world.load(envNames[selectedEnv], sim.getSeed());
+                        loader.releaseLoaded();
+                        sim.setObstacles(world.getObstacles());
+                        accumulator = 0.0f;
+                        state = GameState::PLAYING;
+
+                        if (recording)
+                        {
+                            SessionInfo info;
+                            info.seed = sim.getSeed();
+                            info.environment = world.environmentType;
+                            info.maxDrones = sim.maxDrones;
+                            info.spawnInterval = sim.spawnInterval;
+                            info.ticksPerSecond = static_cast<int>(std::lround(1.0f / Simulation::TIMESTEP));
+                            recorder.open(logPath, info);
+                            recording = false; // only the first game is recorded
+                        }
+                    }
+                    break;
                 }
-                break;
-        }
 
-        enterWasPressed = enterNow;
+                case GameState::PLAYING:
+                    // pass timing to objects that need it
+                    player.currentFrame = currentFrame;
 
-        // glfw: swap buffers and poll IO events
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+                    // input, then advance the simulation in fixed ticks
+                    if (!replaying)
+                    {
+                        player.processKeyboardMouse(window, input);
+                    }
+                    accumulator += std::min(deltaTime, Simulation::MAX_FRAME_TIME);
+                    while (accumulator >= Simulation::TIMESTEP)
+                    {
+                        PROFILE_ZONE("tick");
+                        if (replaying && !replay.next(input))
+                        {
+                            replayFinished = true;
+                            break;
+                        }
+                        recorder.record(input);
+                        sim.step(input);
+                        input.mouseDX = 0.0f; // mouse offsets are consumed by one tick
+                        input.mouseDY = 0.0f;
+                        accumulator -= Simulation::TIMESTEP;
+                    }
+                    PROFILE_COUNTER("accumulator (ms)", accumulator * 1000.0f);
+
+                    // player (camera and gun), world, enemies, HUD; rendered between the last two ticks
+                    alpha = accumulator / Simulation::TIMESTEP;
+                    player.follow(sim.interpolatePlayer(alpha), sim.getEvents());
+                    camera.update(player.GetViewMatrix(), player.getProjectionMatrix());
+                    world.Draw(player.getProjectionMatrix() * player.GetViewMatrix()); // times its own passes
+                    gpuTimer.begin(GpuPass::GUN);
+                    player.controlPlayerRendering();
+                    gpuTimer.end();
+                    gpuTimer.begin(GpuPass::DRONES);
+                    manager.manage(sim, alpha, player.GetViewMatrix(), player.getProjectionMatrix());
+                    gpuTimer.end();
+                    sim.clearEvents();
+                    inGameScreen(text, player);
+
+                    replayFrames++;
+
+                    // transition when player dies
+                    if (!player.getLifeState())
+                    {
+                        recorder.close();
+                        manager.reset();
+                        state = GameState::GAME_OVER;
+                    }
+                    break;
+
+                case GameState::GAME_OVER:
+                    endingScreen(text, player);
+                    if (enterNow && !enterWasPressed)
+                    {
+                        sim.reset();
+                        player.resetAll();
+                        state = GameState::START;
+                    }
+                    break;
+            }
+
+            enterWasPressed = enterNow;
+
+            // F3 toggles the GPU time per render pass
+            bool f3Now = glfwGetKey(window, GLFW_KEY_F3) == GLFW_PRESS;
+            if (f3Now && !f3WasPressed)
+            {
+                showGpuTimings = !showGpuTimings;
+            }
+            f3WasPressed = f3Now;
+            if (showGpuTimings)
+            {
+                drawGpuTimings(text, gpuTimer, world.getRenderStats(), glStateStats);
+            }
+
+            // the screens above only collect their text, all of it is drawn here with one draw call
+            gpuTimer.begin(GpuPass::HUD);
+            text.Flush();
+            gpuTimer.end();
+
+            // F12 saves the profiler trace (only when the profiler is compiled in)
+            bool f12Now = glfwGetKey(window, GLFW_KEY_F12) == GLFW_PRESS;
+            if (f12Now && !f12WasPressed)
+            {
+                PROFILE_SAVE("profile.json");
+            }
+            f12WasPressed = f12Now;
+
+            // end of a replay (end of the log or the player died): report the frame timing and quit
+            if (replaying && (replayFinished || state == GameState::GAME_OVER))
+            {
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - replayStart;
+                std::cout << "replayed " << replay.getTicks() << " ticks in " << replayFrames << " frames, "
+                          << elapsed.count() << " s (" << replayFrames / elapsed.count() << " fps)" << std::endl;
+                glfwSetWindowShouldClose(window, true);
+                replaying = false;
+            }
+
+            // glfw: swap buffers and poll IO events
+            {
+                PROFILE_ZONE("swap buffers");
+                glfwSwapBuffers(window);
+            }
+            glfwPollEvents();
+            PROFILE_COUNTER("GL state changes issued", GLState::getStats().issued);
+            PROFILE_COUNTER("GL state changes elided", GLState::getStats().elided);
+            PROFILE_FRAME();
+        }
     }
 
+    // whatever is still alive in the resource registry would be deleted without a context
+    ResourceRegistryStats leftover = ResourceRegistry::getStats();
+    if (leftover.models + leftover.textures + leftover.shaders > 0)
+    {
+        std::cout << "WARNING: " << leftover.models << " models, " << leftover.textures << " textures and "
+                  << leftover.shaders << " shaders are still alive when the OpenGL context is destroyed" << std::endl;
+    }
+
+    PROFILE_SAVE("profile.json");
+
     glfwTerminate();
     return 0;
 }
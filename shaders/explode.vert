@@ -1,15 +1,35 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in mat4 aInstanceMatrix; // model matrix of the drone
+layout (location = 7) in float aMagnitude;     // explosion magnitude of the drone
 
+#ifdef EXPLODE
+// exploding drones: the geometry shader moves the triangles and applies the camera matrices
 out VS_OUT {
     vec2 texCoords;
+    float magnitude;
 } vs_out;
 
-uniform mat4 model;
-
 void main()
 {
     vs_out.texCoords = aTexCoords;
-    gl_Position = model * vec4(aPos, 1.0);
+    vs_out.magnitude = aMagnitude;
+    gl_Position = aInstanceMatrix * vec4(aPos, 1.0);
+}
+#else
+// live drones: no geometry shader
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+};
+
+out vec2 TexCoords;
+
+void main()
+{
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * aInstanceMatrix * vec4(aPos, 1.0);
 }
+#endif
@@ -2,8 +2,11 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+};
 
 out vec2 TexCoords;
 
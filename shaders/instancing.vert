@@ -5,8 +5,11 @@ layout (location = 3) in mat4 aInstanceMatrix;
 
 out vec2 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+};
 
 void main()
 {
@@ -3,12 +3,15 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+};
 
 void main()
 {
     TexCoords = aPos;
-    vec4 pos = projection * view * vec4(aPos, 1.0);
+    vec4 pos = projection * mat4(mat3(view)) * vec4(aPos, 1.0); // without the translation of the view matrix
     gl_Position = pos.xyww;
 }  
\ No newline at end of file
@@ -1,12 +1,17 @@
 #version 330 core
 in vec2 TexCoords;
+in vec3 TextColor;
+in vec4 Border; // <vec3 color, float width>
 out vec4 color;
 
-uniform sampler2D text;
-uniform vec3 textColor;
+uniform sampler2D text; // signed distance field: 0.5 on the outline, more inside
 
 void main()
 {    
-    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
-    color = vec4(textColor, 1.0) * sampled;
-}
\ No newline at end of file
+    float distance = texture(text, TexCoords).r;
+    // anti-aliasing over about one screen pixel, whatever the text scale
+    float smoothing = max(fwidth(distance) * 0.5, 0.001);
+    float fill = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+    float outline = smoothstep(0.5 - Border.w - smoothing, 0.5 - Border.w + smoothing, distance);
+    color = vec4(mix(Border.rgb, TextColor, fill), outline);
+}
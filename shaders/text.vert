@@ -1,6 +1,10 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
+layout (location = 1) in vec3 vertexColor;
+layout (location = 2) in vec4 vertexBorder; // <vec3 color, float width>
 out vec2 TexCoords;
+out vec3 TextColor;
+out vec4 Border;
 
 uniform mat4 projection;
 
@@ -8,4 +12,6 @@ void main()
 {
     gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
     TexCoords = vertex.zw;
-}
\ No newline at end of file
+    TextColor = vertexColor;
+    Border = vertexBorder;
+}
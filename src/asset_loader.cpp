@@ -0,0 +1,630 @@
+#include "asset_loader.h"
+#include "gl_object.h"
+#include "gl_state.h"
+#include "model.h"
+#include "profiler.h"
+#include "resource_registry.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+const std::size_t AssetLoader::UPLOAD_BUDGET = 8 * 1024 * 1024;
+const unsigned int AssetLoader::PBO_COUNT = 4;
+const std::size_t AssetLoader::PREFETCH_BUDGET = 384 * 1024 * 1024;
+
+/// Decoded image (the pixels are freed once they are uploaded).
+struct AssetLoader::Image
+{
+    std::string filename;                  // filename (relative to the directory of the asset) or path of a cubemap face
+    std::shared_ptr<unsigned char> pixels; // nullptr if the image could not be decoded
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+};
+
+/// Queued model, texture or cubemap.
+struct AssetLoader::Asset
+{
+    AssetType type;
+    std::string key;                    // identifies the asset while it is queued
+    std::string path;                   // model: filepath to the model
+    std::string filename;               // texture: filename
+    std::string directory;              // texture: directory of filename, model: directory of the model
+    std::vector<std::string> faces;     // cubemap: paths to the faces
+    bool flipVertically = false;        // flip the images vertically on load?
+    bool prefetch = false;              // true while it is only decoded ahead (main thread only)
+    std::atomic<bool> cancelled{false}; // set for a prefetch that is no longer wanted before it is decoded
+
+    // written by the worker that decodes the asset
+    std::unique_ptr<ModelFile> file;    // model: meshes
+    std::vector<Image> images;          // texture: the texture, model: its textures, cubemap: the faces
+    std::size_t bytes = 0;              // decoded bytes (images and meshes)
+    bool skipped = false;               // true if it was cancelled before it was decoded
+
+    // upload, main thread only
+    bool ready = false;                 // true once update picked the decoded asset up
+    std::size_t step = 0;               // parts (images, then meshes) that are uploaded
+    std::size_t parts = 0;              // images plus meshes
+    std::unique_ptr<Model> model;       // model: the meshes that are uploaded so far
+    GLTexture texture;                  // cubemap: texture the faces are uploaded to (deleted if the loader is destroyed first)
+    std::vector<std::shared_ptr<const void>> textures; // model: its textures, held until the model holds them
+};
+
+/**
+ * @brief Decodes an image file with stb_image (can be called on any thread).
+ *
+ * @param path path to the image.
+ * @param flipVertically flip the image vertically or not?
+ * @param desiredChannels number of channels to convert to (0 keeps the channels of the file).
+ * @param pixels decoded pixels (stays nullptr if the image can not be decoded).
+ * @param width width of the image.
+ * @param height height of the image.
+ * @param channels number of channels of the decoded pixels.
+ */
+static void decodeImage(const std::string &path, bool flipVertically, int desiredChannels,
+                        std::shared_ptr<unsigned char> &pixels, int &width, int &height, int &channels)
+{
+    // the flip setting of this thread only, the main thread may load textures with another one meanwhile
+    stbi_set_flip_vertically_on_load_thread(flipVertically);
+    int fileChannels = 0;
+    unsigned char *data = stbi_load(path.c_str(), &width, &height, &fileChannels, desiredChannels);
+    if (data == nullptr)
+    {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        return;
+    }
+    pixels = std::shared_ptr<unsigned char>(data, stbi_image_free);
+    channels = desiredChannels != 0 ? desiredChannels : fileChannels;
+}
+
+/// Format of decoded pixels with a number of channels (as in TextureFromFile).
+static GLenum pixelFormat(int channels)
+{
+    if (channels == 1)
+    {
+        return GL_RED;
+    }
+    return channels == 3 ? GL_RGB : GL_RGBA;
+}
+
+/**
+ * @brief Finds the asset with a key in a list.
+ *
+ * @param assets list of assets.
+ * @param key key of the asset.
+ * @return iterator to the asset, or assets.end() if it is not in the list.
+ */
+template <typename Assets>
+static typename Assets::iterator findAsset(Assets &assets, const std::string &key)
+{
+    return std::find_if(assets.begin(), assets.end(), [&key](const typename Assets::value_type &asset)
+                        { return asset->key == key; });
+}
+
+AssetLoader::AssetLoader() : prefetchedBytes(0), nextPbo(0), finished(0) {}
+
+AssetLoader::~AssetLoader()
+{
+    // the workers are joined after this, skip what they did not start on yet
+    cancelPrefetches();
+    for (GLsync fence : fences)
+    {
+        if (fence != nullptr)
+        {
+            glDeleteSync(fence);
+        }
+    }
+    if (!pbos.empty())
+    {
+        glDeleteBuffers(static_cast<GLsizei>(pbos.size()), pbos.data());
+    }
+}
+
+void AssetLoader::loadModel(const std::string &path, bool flipVertically)
+{
+    if (std::shared_ptr<Model> model = ResourceRegistry::findModel(path, flipVertically))
+    {
+        loaded.push_back(model);
+        return;
+    }
+    queue(describeModel(path, flipVertically));
+}
+
+void AssetLoader::loadTexture(const std::string &filename, const std::string &directory, bool flipVertically)
+{
+    if (std::shared_ptr<const TextureObject> texture = ResourceRegistry::findTexture(filename, directory, flipVertically))
+    {
+        loaded.push_back(texture);
+        return;
+    }
+    queue(describeTexture(filename, directory, flipVertically));
+}
+
+void AssetLoader::loadCubemap(const std::vector<std::string> &faces)
+{
+    if (std::shared_ptr<const TextureObject> cubemap = ResourceRegistry::findCubemap(faces))
+    {
+        loaded.push_back(cubemap);
+        return;
+    }
+    queue(describeCubemap(faces));
+}
+
+void AssetLoader::prefetchModel(const std::string &path, bool flipVertically)
+{
+    if (!ResourceRegistry::findModel(path, flipVertically))
+    {
+        prefetch(describeModel(path, flipVertically));
+    }
+}
+
+void AssetLoader::prefetchTexture(const std::string &filename, const std::string &directory, bool flipVertically)
+{
+    if (!ResourceRegistry::findTexture(filename, directory, flipVertically))
+    {
+        prefetch(describeTexture(filename, directory, flipVertically));
+    }
+}
+
+void AssetLoader::prefetchCubemap(const std::vector<std::string> &faces)
+{
+    if (!ResourceRegistry::findCubemap(faces))
+    {
+        prefetch(describeCubemap(faces));
+    }
+}
+
+void AssetLoader::cancelPrefetches()
+{
+    for (const std::shared_ptr<Asset> &asset : prefetching)
+    {
+        asset->cancelled = true;
+    }
+}
+
+std::size_t AssetLoader::getPrefetchedBytes() const
+{
+    return prefetchedBytes;
+}
+
+std::shared_ptr<AssetLoader::Asset> AssetLoader::describeModel(const std::string &path, bool flipVertically)
+{
+    std::shared_ptr<Asset> asset = std::make_shared<Asset>();
+    asset->type = AssetType::MODEL;
+    asset->key = "model|" + path + (flipVertically ? "|flipped" : "");
+    asset->path = path;
+    asset->flipVertically = flipVertically;
+    return asset;
+}
+
+std::shared_ptr<AssetLoader::Asset> AssetLoader::describeTexture(const std::string &filename, const std::string &directory, bool flipVertically)
+{
+    std::shared_ptr<Asset> asset = std::make_shared<Asset>();
+    asset->type = AssetType::TEXTURE;
+    asset->key = "texture|" + directory + '/' + filename + (flipVertically ? "|flipped" : "");
+    asset->filename = filename;
+    asset->directory = directory;
+    asset->flipVertically = flipVertically;
+    return asset;
+}
+
+std::shared_ptr<AssetLoader::Asset> AssetLoader::describeCubemap(const std::vector<std::string> &faces)
+{
+    std::shared_ptr<Asset> asset = std::make_shared<Asset>();
+    asset->type = AssetType::CUBEMAP;
+    asset->key = "cubemap";
+    for (const std::string &face : faces)
+    {
+        asset->key += '|' + face;
+    }
+    asset->faces = faces;
+    return asset;
+}
+
+void AssetLoader::queue(const std::shared_ptr<Asset> &asset)
+{
+    if (findAsset(pending, asset->key) != pending.end())
+    {
+        return;
+    }
+    if (pending.empty())
+    {
+        finished = 0;
+    }
+
+    // decoded ahead: only the upload is left
+    auto cached = findAsset(prefetched, asset->key);
+    if (cached != prefetched.end())
+    {
+        std::shared_ptr<Asset> decodedAsset = *cached;
+        prefetched.erase(cached);
+        prefetchedBytes -= decodedAsset->bytes;
+        decodedAsset->prefetch = false;
+        startUpload(*decodedAsset);
+        pending.push_back(decodedAsset);
+        return;
+    }
+
+    // being decoded ahead: it is uploaded once it is done (and no longer cancelled)
+    auto decoding = findAsset(prefetching, asset->key);
+    if (decoding != prefetching.end())
+    {
+        std::shared_ptr<Asset> decodingAsset = *decoding;
+        prefetching.erase(decoding);
+        decodingAsset->prefetch = false;
+        decodingAsset->cancelled = false;
+        pending.push_back(decodingAsset);
+        return;
+    }
+
+    pending.push_back(asset);
+    decodeAsync(asset);
+}
+
+void AssetLoader::prefetch(const std::shared_ptr<Asset> &asset)
+{
+    if (findAsset(pending, asset->key) != pending.end())
+    {
+        return;
+    }
+
+    // decoded ahead already: it becomes the most recent prefetch
+    auto cached = findAsset(prefetched, asset->key);
+    if (cached != prefetched.end())
+    {
+        std::rotate(cached, cached + 1, prefetched.end());
+        return;
+    }
+
+    // being decoded ahead already (it may have been cancelled, it is wanted again)
+    auto decoding = findAsset(prefetching, asset->key);
+    if (decoding != prefetching.end())
+    {
+        (*decoding)->cancelled = false;
+        return;
+    }
+
+    asset->prefetch = true;
+    prefetching.push_back(asset);
+    decodeAsync(asset);
+}
+
+void AssetLoader::decodeAsync(const std::shared_ptr<Asset> &asset)
+{
+    jobs.async([this, asset]()
+               {
+                   if (asset->cancelled)
+                   {
+                       asset->skipped = true;
+                   }
+                   else
+                   {
+                       decode(*asset);
+                   }
+                   std::lock_guard<std::mutex> lock(decodedMutex);
+                   decoded.push_back(asset); });
+}
+
+void AssetLoader::pickUp(const std::shared_ptr<Asset> &asset)
+{
+    if (asset->skipped)
+    {
+        if (asset->cancelled)
+        {
+            // cancelled prefetch
+            prefetching.erase(std::find(prefetching.begin(), prefetching.end(), asset));
+            return;
+        }
+        // cancelled, then wanted again before the worker got to it
+        asset->skipped = false;
+        decodeAsync(asset);
+        return;
+    }
+
+    if (!asset->prefetch)
+    {
+        startUpload(*asset);
+        return;
+    }
+
+    // keep the prefetch, drop the least recent ones while the cache is over its budget
+    prefetching.erase(std::find(prefetching.begin(), prefetching.end(), asset));
+    prefetched.push_back(asset);
+    prefetchedBytes += asset->bytes;
+    while (prefetchedBytes > PREFETCH_BUDGET && !prefetched.empty())
+    {
+        prefetchedBytes -= prefetched.front()->bytes;
+        prefetched.erase(prefetched.begin());
+    }
+}
+
+void AssetLoader::startUpload(Asset &asset)
+{
+    asset.ready = true;
+    asset.parts = asset.images.size() + (asset.file ? asset.file->meshes.size() : 0);
+    if (asset.type == AssetType::MODEL)
+    {
+        asset.model.reset(new Model());
+        asset.model->directory = asset.directory;
+        asset.model->flipVertically = asset.flipVertically;
+        asset.model->gammaCorrection = false;
+    }
+}
+
+void AssetLoader::decode(Asset &asset)
+{
+    PROFILE_ZONE("decode asset");
+    if (asset.type == AssetType::MODEL)
+    {
+        asset.file.reset(new ModelFile());
+        asset.file->read(asset.path);
+        asset.directory = asset.file->directory;
+
+        // the textures of the model, each file once
+        for (const CachedMesh &mesh : asset.file->meshes)
+        {
+            for (const MeshTextureRef &ref : mesh.textures)
+            {
+                bool known = std::any_of(asset.images.begin(), asset.images.end(), [&ref](const Image &image)
+                                         { return image.filename == ref.path; });
+                if (!known)
+                {
+                    Image image;
+                    image.filename = ref.path;
+                    asset.images.push_back(image);
+                }
+            }
+        }
+        for (Image &image : asset.images)
+        {
+            decodeImage(asset.directory + '/' + image.filename, asset.flipVertically, 0, image.pixels, image.width, image.height, image.channels);
+        }
+    }
+    else if (asset.type == AssetType::TEXTURE)
+    {
+        Image image;
+        image.filename = asset.filename;
+        decodeImage(asset.directory + '/' + asset.filename, asset.flipVertically, 0, image.pixels, image.width, image.height, image.channels);
+        asset.images.push_back(image);
+    }
+    else
+    {
+        // the faces are uploaded as GL_RGB (see loadCubemap)
+        for (const std::string &face : asset.faces)
+        {
+            Image image;
+            image.filename = face;
+            decodeImage(face, false, 3, image.pixels, image.width, image.height, image.channels);
+            asset.images.push_back(image);
+        }
+    }
+
+    // memory the decoded asset takes (for the prefetch budget)
+    for (const Image &image : asset.images)
+    {
+        asset.bytes += static_cast<std::size_t>(image.width) * image.height * image.channels;
+    }
+    if (asset.file)
+    {
+        for (const CachedMesh &mesh : asset.file->meshes)
+        {
+            asset.bytes += mesh.vertexCount * sizeof(Vertex) + mesh.indexCount * sizeof(unsigned int);
+        }
+    }
+}
+
+void AssetLoader::update()
+{
+    PROFILE_ZONE("AssetLoader::update");
+    std::deque<std::shared_ptr<Asset>> arrived;
+    {
+        std::lock_guard<std::mutex> lock(decodedMutex);
+        arrived.swap(decoded);
+    }
+    for (const std::shared_ptr<Asset> &asset : arrived)
+    {
+        pickUp(asset);
+    }
+
+    // upload in the order the assets were queued until the budget is used up or no PBO is free
+    std::size_t bytes = 0;
+    bool stalled = false;
+    size_t i = 0;
+    while (i < pending.size() && bytes < UPLOAD_BUDGET && !stalled)
+    {
+        Asset &asset = *pending[i];
+        if (!asset.ready)
+        {
+            i++;
+            continue;
+        }
+        std::size_t step = asset.step;
+        if (uploadStep(asset, bytes))
+        {
+            pending.erase(pending.begin() + i);
+            finished++;
+            continue;
+        }
+        stalled = asset.step == step;
+    }
+    PROFILE_COUNTER("asset upload (KB)", bytes / 1024.0);
+}
+
+bool AssetLoader::uploadStep(Asset &asset, std::size_t &bytes)
+{
+    if (asset.step < asset.images.size())
+    {
+        Image &image = asset.images[asset.step];
+        if (asset.type == AssetType::CUBEMAP)
+        {
+            // all faces go into one texture
+            if (asset.texture.get() == 0)
+            {
+                asset.texture.create();
+            }
+            GLState::bindTexture(0, GL_TEXTURE_CUBE_MAP, asset.texture.get());
+            if (image.pixels && !uploadImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(asset.step), image))
+            {
+                return false;
+            }
+        }
+        else if (std::shared_ptr<const TextureObject> alive = ResourceRegistry::findTexture(image.filename, asset.directory, asset.flipVertically))
+        {
+            // loaded in the meantime (e.g. by another model that uses it too)
+            (asset.type == AssetType::TEXTURE ? loaded : asset.textures).push_back(alive);
+        }
+        else
+        {
+            // a texture that can not be decoded stays empty, like in TextureFromFile
+            GLTexture id;
+            id.create();
+            GLState::bindTexture(0, GL_TEXTURE_2D, id.get());
+            if (image.pixels)
+            {
+                if (!uploadImage(GL_TEXTURE_2D, image))
+                {
+                    return false; // the texture is deleted, the image is uploaded again once a PBO is free
+                }
+                glGenerateMipmap(GL_TEXTURE_2D);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            }
+            std::size_t textureBytes = static_cast<std::size_t>(image.width) * image.height * image.channels * 4 / 3; // with the mipmaps
+            std::shared_ptr<const TextureObject> texture = ResourceRegistry::addTexture(image.filename, asset.directory, asset.flipVertically, id.release(), textureBytes);
+            (asset.type == AssetType::TEXTURE ? loaded : asset.textures).push_back(texture);
+        }
+        bytes += static_cast<std::size_t>(image.width) * image.height * image.channels;
+        image.pixels.reset();
+        asset.step++;
+    }
+    else if (asset.step < asset.parts)
+    {
+        // one mesh of a model, its textures are in the registry now
+        const CachedMesh &mesh = asset.file->meshes[asset.step - asset.images.size()];
+        asset.model->addMesh(mesh);
+        bytes += mesh.vertexCount * sizeof(Vertex) + mesh.indexCount * sizeof(unsigned int);
+        asset.step++;
+    }
+    if (asset.step < asset.parts)
+    {
+        return false;
+    }
+
+    // complete, hand it to the registry (textures were handed over when they were uploaded)
+    if (asset.type == AssetType::MODEL)
+    {
+        loaded.push_back(ResourceRegistry::addModel(asset.path, asset.flipVertically, asset.model.release()));
+        asset.file.reset();
+    }
+    else if (asset.type == AssetType::CUBEMAP)
+    {
+        if (asset.texture.get() == 0)
+        {
+            asset.texture.create();
+        }
+        GLState::bindTexture(0, GL_TEXTURE_CUBE_MAP, asset.texture.get());
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        loaded.push_back(ResourceRegistry::addCubemap(asset.faces, asset.texture.release(), asset.bytes));
+    }
+    return true;
+}
+
+bool AssetLoader::uploadImage(GLenum target, const Image &image)
+{
+    if (pbos.empty())
+    {
+        pbos.resize(PBO_COUNT);
+        glGenBuffers(static_cast<GLsizei>(PBO_COUNT), pbos.data());
+        fences.assign(PBO_COUNT, nullptr);
+        pboSizes.assign(PBO_COUNT, 0);
+    }
+
+    // the next PBO can only be filled once the GPU has read the image that was uploaded from it last time
+    GLsync &fence = fences[nextPbo];
+    if (fence != nullptr)
+    {
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            return false;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    std::size_t size = static_cast<std::size_t>(image.width) * image.height * image.channels;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+    if (pboSizes[nextPbo] < size)
+    {
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW);
+        pboSizes[nextPbo] = size;
+    }
+    // the fence was signaled, so the driver does not have to synchronize the mapping
+    void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size),
+                                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    const void *pixels = nullptr; // offset into the PBO
+    if (mapped != nullptr)
+    {
+        std::memcpy(mapped, image.pixels.get(), size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    else
+    {
+        // upload straight from memory if the PBO can not be mapped
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        pixels = image.pixels.get();
+    }
+
+    // rows of the decoded images are tightly packed (the alignment is put back for whoever uploads next)
+    GLenum format = pixelFormat(image.channels);
+    GLint alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(target, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (mapped != nullptr)
+    {
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        nextPbo = (nextPbo + 1) % PBO_COUNT;
+    }
+    return true;
+}
+
+float AssetLoader::getProgress() const
+{
+    if (pending.empty())
+    {
+        return 1.0f;
+    }
+    // a decoded resource counts as half done, the other half is its upload
+    float done = static_cast<float>(finished);
+    for (const std::shared_ptr<Asset> &asset : pending)
+    {
+        if (asset->ready && asset->parts > 0)
+        {
+            done += 0.5f + 0.5f * static_cast<float>(asset->step) / static_cast<float>(asset->parts);
+        }
+    }
+    return done / static_cast<float>(finished + pending.size());
+}
+
+bool AssetLoader::isIdle() const
+{
+    return pending.empty();
+}
+
+void AssetLoader::releaseLoaded()
+{
+    loaded.clear();
+}
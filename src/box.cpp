@@ -13,7 +13,7 @@ AABBox::AABBox(glm::vec3 vmin, glm::vec3 vmax)
     }
 }
 
-bool AABBox::isValid()
+bool AABBox::isValid() const
 {
     return bounds[0].x < bounds[1].x && bounds[0].y < bounds[1].y && bounds[0].z < bounds[1].z;
 }
@@ -40,7 +40,13 @@ void AABBox::fix()
     }
 }
 
-bool AABBox::intersect(Ray ray, float length)
+bool AABBox::intersect(const Ray &ray, float length) const
+{
+    float distance;
+    return intersect(ray, length, distance);
+}
+
+bool AABBox::intersect(const Ray &ray, float length, float &distance) const
 {
     float tmin, tmax, tymin, tymax, tzmin, tzmax;
 
@@ -68,14 +74,18 @@ bool AABBox::intersect(Ray ray, float length)
     if (tzmax < tmax)
         tmax = tzmax;
 
-    length = tmin;
+    // box lies behind the ray
+    if (tmax < 0)
+        return false;
+
+    // ray starts inside the box
+    if (tmin < 0)
+        tmin = 0;
 
-    if (length < 0)
-    {
-        length = tmax;
-        if (length < 0)
-            return false;
-    }
+    // box lies beyond the end of the ray
+    if (tmin > length)
+        return false;
 
+    distance = tmin;
     return true;
 }
\ No newline at end of file
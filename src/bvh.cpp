@@ -0,0 +1,264 @@
+#include "bvh.h"
+
+#include <algorithm>
+#include <limits>
+
+const int BVH::LEAF_SIZE = 8;
+
+// a box that nothing can hit and that does not grow its parent (min > max)
+static AABBox emptyBox()
+{
+    const float infinity = std::numeric_limits<float>::infinity();
+    AABBox box;
+    box.bounds[0] = glm::vec3(infinity);
+    box.bounds[1] = glm::vec3(-infinity);
+    return box;
+}
+
+// smallest box that contains both boxes
+static void grow(AABBox &box, const AABBox &other)
+{
+    box.bounds[0] = glm::min(box.bounds[0], other.bounds[0]);
+    box.bounds[1] = glm::max(box.bounds[1], other.bounds[1]);
+}
+
+BVH::BVH() {}
+
+void BVH::build(const std::vector<int> &ids, const std::vector<AABBox> &boxes)
+{
+    clear();
+    int n = static_cast<int>(ids.size());
+    if (n == 0)
+    {
+        return;
+    }
+
+    centroids.resize(n);
+    order.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        centroids[i] = (boxes[i].bounds[0] + boxes[i].bounds[1]) * 0.5f;
+        order[i] = i;
+    }
+
+    // a binary tree with leaves of at least one item has fewer than 2n nodes
+    nodes.reserve(2 * n);
+    nodes.push_back(Node());
+    buildNode(boxes, 0, 0, n);
+
+    // store the items in leaf order, so a leaf is a contiguous range
+    items.resize(n);
+    itemMinX.resize(n);
+    itemMinY.resize(n);
+    itemMinZ.resize(n);
+    itemMaxX.resize(n);
+    itemMaxY.resize(n);
+    itemMaxZ.resize(n);
+    itemEnabled.assign(n, 1);
+    for (int i = 0; i < n; i++)
+    {
+        items[i] = ids[order[i]];
+        setItemBox(i, boxes[order[i]].bounds[0], boxes[order[i]].bounds[1]);
+        if (items[i] >= static_cast<int>(itemPosition.size()))
+        {
+            itemPosition.resize(items[i] + 1, -1);
+        }
+        itemPosition[items[i]] = i;
+    }
+}
+
+void BVH::clear()
+{
+    nodes.clear();
+    items.clear();
+    itemMinX.clear();
+    itemMinY.clear();
+    itemMinZ.clear();
+    itemMaxX.clear();
+    itemMaxY.clear();
+    itemMaxZ.clear();
+    itemEnabled.clear();
+    std::fill(itemPosition.begin(), itemPosition.end(), -1);
+}
+
+bool BVH::contains(int id) const
+{
+    return id >= 0 && id < static_cast<int>(itemPosition.size()) && itemPosition[id] != -1;
+}
+
+int BVH::size() const
+{
+    return static_cast<int>(items.size());
+}
+
+void BVH::update(int id, glm::vec3 min, glm::vec3 max)
+{
+    setItemBox(itemPosition[id], min, max);
+    itemEnabled[itemPosition[id]] = 1;
+}
+
+void BVH::disable(int id)
+{
+    // the empty box keeps the item out of the node boxes, the mask keeps it out of the leaf tests
+    AABBox empty = emptyBox();
+    setItemBox(itemPosition[id], empty.bounds[0], empty.bounds[1]);
+    itemEnabled[itemPosition[id]] = 0;
+}
+
+void BVH::refit()
+{
+    // children are stored after their parent, so walking backwards visits children first
+    for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; i--)
+    {
+        Node &node = nodes[i];
+        node.box = emptyBox();
+        if (node.count > 0)
+        {
+            for (int k = node.first; k < node.first + node.count; k++)
+            {
+                node.box.bounds[0] = glm::min(node.box.bounds[0], glm::vec3(itemMinX[k], itemMinY[k], itemMinZ[k]));
+                node.box.bounds[1] = glm::max(node.box.bounds[1], glm::vec3(itemMaxX[k], itemMaxY[k], itemMaxZ[k]));
+            }
+        }
+        else
+        {
+            grow(node.box, nodes[node.first].box);
+            grow(node.box, nodes[node.first + 1].box);
+        }
+    }
+}
+
+bool BVH::raycast(const Ray &ray, float maxDistance, int &id, float &distance) const
+{
+    if (nodes.empty())
+    {
+        return false;
+    }
+
+    const BoxArrays boxes = itemArrays();
+    float nearest = maxDistance;
+    bool hit = false;
+    float t;
+
+    // depth first, nearest child first; everything that starts behind the nearest hit is skipped
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node &node = nodes[stack[--top]];
+        if (!node.box.intersect(ray, nearest, t))
+        {
+            continue;
+        }
+
+        if (node.count > 0)
+        {
+            // the whole leaf in one batch, or item by item if some of its items are disabled
+            int end = node.first + node.count;
+            int k = -1;
+            if (std::all_of(itemEnabled.begin() + node.first, itemEnabled.begin() + end, [](uint8_t enabled)
+                            { return enabled != 0; }))
+            {
+                k = nearestRayHit(ray, boxes, node.first, end, nearest, t);
+            }
+            else
+            {
+                float best = nearest;
+                for (int i = node.first; i < end; i++)
+                {
+                    if (itemEnabled[i] && nearestRayHit(ray, boxes, i, i + 1, best, t) >= 0)
+                    {
+                        best = t;
+                        k = i;
+                    }
+                }
+                t = best;
+            }
+            if (k >= 0)
+            {
+                nearest = t;
+                id = items[k];
+                hit = true;
+            }
+            continue;
+        }
+
+        // push the far child first so that the near child is visited first
+        float tLeft, tRight;
+        bool hitLeft = nodes[node.first].box.intersect(ray, nearest, tLeft);
+        bool hitRight = nodes[node.first + 1].box.intersect(ray, nearest, tRight);
+        if (hitLeft && hitRight)
+        {
+            bool leftFirst = tLeft <= tRight;
+            stack[top++] = leftFirst ? node.first + 1 : node.first;
+            stack[top++] = leftFirst ? node.first : node.first + 1;
+        }
+        else if (hitLeft)
+        {
+            stack[top++] = node.first;
+        }
+        else if (hitRight)
+        {
+            stack[top++] = node.first + 1;
+        }
+    }
+
+    if (hit)
+    {
+        distance = nearest;
+    }
+    return hit;
+}
+
+BoxArrays BVH::itemArrays() const
+{
+    return {itemMinX.data(), itemMinY.data(), itemMinZ.data(), itemMaxX.data(), itemMaxY.data(), itemMaxZ.data()};
+}
+
+void BVH::setItemBox(int position, glm::vec3 min, glm::vec3 max)
+{
+    itemMinX[position] = min.x;
+    itemMinY[position] = min.y;
+    itemMinZ[position] = min.z;
+    itemMaxX[position] = max.x;
+    itemMaxY[position] = max.y;
+    itemMaxZ[position] = max.z;
+}
+
+void BVH::buildNode(const std::vector<AABBox> &boxes, int node, int begin, int end)
+{
+    // bounds of the items and of their centers
+    AABBox bounds = emptyBox();
+    AABBox centerBounds = emptyBox();
+    for (int i = begin; i < end; i++)
+    {
+        grow(bounds, boxes[order[i]]);
+        centerBounds.bounds[0] = glm::min(centerBounds.bounds[0], centroids[order[i]]);
+        centerBounds.bounds[1] = glm::max(centerBounds.bounds[1], centroids[order[i]]);
+    }
+    nodes[node].box = bounds;
+
+    if (end - begin <= LEAF_SIZE)
+    {
+        nodes[node].first = begin;
+        nodes[node].count = end - begin;
+        return;
+    }
+
+    // split at the median along the axis where the centers are spread out the most
+    glm::vec3 extent = centerBounds.bounds[1] - centerBounds.bounds[0];
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+    int middle = (begin + end) / 2;
+    std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                     [this, axis](int a, int b)
+                     { return centroids[a][axis] < centroids[b][axis]; });
+
+    int left = static_cast<int>(nodes.size());
+    nodes.push_back(Node());
+    nodes.push_back(Node());
+    nodes[node].first = left;
+    nodes[node].count = 0;
+    buildNode(boxes, left, begin, middle);
+    buildNode(boxes, left + 1, middle, end);
+}
@@ -0,0 +1,28 @@
+#include "camera_uniforms.h"
+
+const GLuint CameraUniforms::BINDING = 0;
+const char *CameraUniforms::BLOCK_NAME = "Camera";
+
+CameraUniforms::CameraUniforms()
+{
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, UBO);
+}
+
+CameraUniforms::~CameraUniforms()
+{
+    glDeleteBuffers(1, &UBO);
+}
+
+void CameraUniforms::update(const glm::mat4 &view, const glm::mat4 &projection)
+{
+    Block block;
+    block.projection = projection;
+    block.view = view;
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
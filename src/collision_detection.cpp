@@ -1,53 +1,211 @@
 #include "collision_detection.h"
+#include "profiler.h"
 
-CollisionDetector::CollisionDetector(){}
+const float CollisionDetector::CELL_SIZE = 2.0f;
+const int CollisionDetector::REBUILD_INTERVAL = 60;
 
-void CollisionDetector::Detect(Player &player, EnemyManager &manager)
+// the grids cover the terrain and the ring around it where drones spawn, from below the player up to above the highest drone
+static const glm::vec3 GRID_MIN = glm::vec3(-Terrain::SIZE, -2.0f, -Terrain::SIZE);
+static const glm::vec3 GRID_MAX = glm::vec3(Terrain::SIZE, DroneState::MAX_FLOAT_HEIGHT + 2.0f, Terrain::SIZE);
+
+CollisionDetector::CollisionDetector()
+    : droneGrid(GRID_MIN, GRID_MAX, CELL_SIZE), laserGrid(GRID_MIN, GRID_MAX, CELL_SIZE)
+{
+    ticksSinceRebuild = 0;
+}
+
+void CollisionDetector::Detect(PlayerState &player, DroneSwarm &drones, const std::vector<int> &fired, std::vector<SimEvent> &events, JobSystem *jobs)
 {
-    if (player.shot)
+    PROFILE_ZONE("CollisionDetector::Detect");
+    int slots = drones.slots();
+
+    /* the drone tree keeps its layout while drones move, so its boxes slowly get bigger and overlap more;
+    rebuild it once in a while and whenever new slots were added, otherwise only refit it */
+    bool rebuild = droneTree.size() != slots || ++ticksSinceRebuild >= REBUILD_INTERVAL;
+
+    // update the drone tree and find the drones that enter other grid cells (in parallel), then move only those in the grid
+    droneGrid.reserve(slots);
+    moved.resize(slots);
+    runParallel(jobs, 0, slots, 0, [&](int begin, int end)
+                {
+                    for (int i = begin; i < end; i++)
+                    {
+                        glm::vec3 min(drones.boxMinX[i], drones.boxMinY[i], drones.boxMinZ[i]);
+                        glm::vec3 max(drones.boxMaxX[i], drones.boxMaxY[i], drones.boxMaxZ[i]);
+                        if (drones.inUse[i] && !drones.isDead[i])
+                        {
+                            moved[i] = droneGrid.update(i, min, max);
+                            if (!rebuild)
+                            {
+                                droneTree.update(i, min, max);
+                            }
+                        }
+                        else
+                        {
+                            moved[i] = droneGrid.contains(i);
+                            if (!rebuild)
+                            {
+                                droneTree.disable(i);
+                            }
+                        }
+                    } });
+
+    for (int i = 0; i < slots; i++)
     {
-        // collision detection between player;s bullet and enemy
-        for (unsigned int i = 0; i < manager.enemyCount - 1; i++)
+        if (!moved[i])
         {
-            PlayerAttacksEnemy(player, manager.enemies[i]);
+            continue;
         }
+        if (drones.inUse[i] && !drones.isDead[i])
+        {
+            droneGrid.insert(i, glm::vec3(drones.boxMinX[i], drones.boxMinY[i], drones.boxMinZ[i]),
+                             glm::vec3(drones.boxMaxX[i], drones.boxMaxY[i], drones.boxMaxZ[i]));
+        }
+        else
+        {
+            droneGrid.remove(i);
+        }
+    }
+
+    if (rebuild)
+    {
+        RebuildDroneTree(drones);
+    }
+    else
+    {
+        droneTree.refit();
     }
 
-    for (unsigned int i = 0; i < manager.enemyCount - 1; i++)
+    // collision detection between player's bullet and drones
+    if (player.bulletFired)
     {
-        if (manager.enemies[i]->canDamage) 
+        PlayerAttacksEnemy(player, drones, events);
+    }
+
+    /* new laser beams replace the previous beam of the same drone and end at the first obstacle;
+    a beam keeps the origin it was fired from, so the hit test checks the same beam that is in the grid */
+    laserOrigin.resize(slots, glm::vec3(0.0f));
+    laserLength.resize(slots, 0.0f);
+    for (int slot : fired)
+    {
+        glm::vec3 position(drones.posX[slot], drones.posY[slot], drones.posZ[slot]);
+        glm::vec3 laserDirection(drones.laserDirX[slot], drones.laserDirY[slot], drones.laserDirZ[slot]);
+        Ray ray(position, glm::normalize(laserDirection));
+        int obstacle;
+        float length = DroneState::RANGE;
+        obstacleTree.raycast(ray, DroneState::RANGE, obstacle, length);
+        laserOrigin[slot] = position;
+        laserLength[slot] = length;
+        laserGrid.insertRay(slot, position, laserDirection, length);
+    }
+
+    // collision detection between the lasers near the player and player
+    candidates.clear();
+    laserGrid.queryBox(player.boundingBox.bounds[0], player.boundingBox.bounds[1], candidates);
+    for (int slot : candidates)
+    {
+        if (!drones.canDamage[slot])
+        {
+            laserGrid.remove(slot); // beam already did damage or the drone spawned again
+        }
+        else if (EnemyAttacksPlayer(player, drones, slot))
         {
-            // collision detection between enemy's laser and player
-            EnemyAttacksPlayer(player, manager.enemies[i]);
+            player.health -= DroneState::DAMAGE; // decrease player's health
+            drones.canDamage[slot] = 0; // set to false to ensure that player's health only decreases once per hit
+            events.push_back({SimEventType::PLAYER_HIT, slot});
+            laserGrid.remove(slot);
         }
     }
 }
 
-void CollisionDetector::PlayerAttacksEnemy(Player &player, std::shared_ptr<Enemy> enemy)
+void CollisionDetector::SetObstacles(const std::vector<AABBox> &obstacles)
 {
-    // construct ray object with start position and direction of bullet
-    Ray ray(player.Position, player.Front);
+    ids.clear();
+    for (size_t i = 0; i < obstacles.size(); i++)
+    {
+        ids.push_back(static_cast<int>(i));
+    }
+    obstacleTree.build(ids, obstacles);
+}
 
-    // check for collision
-    if (enemy->boundingBox.intersect(ray, player.range) == true)
+void CollisionDetector::FindDrones(glm::vec3 center, float radius, std::vector<int> &out)
+{
+    droneGrid.queryRadius(center, radius, out);
+}
+
+void CollisionDetector::Reset()
+{
+    droneGrid.clear();
+    laserGrid.clear();
+    droneTree.clear();
+    ticksSinceRebuild = 0;
+}
+
+void CollisionDetector::RebuildDroneTree(const DroneSwarm &drones)
+{
+    int slots = drones.slots();
+    ids.clear();
+    boxes.clear();
+    for (int i = 0; i < slots; i++)
+    {
+        ids.push_back(i);
+        boxes.push_back(drones.getBoundingBox(i));
+    }
+    droneTree.build(ids, boxes);
+
+    // dead drones and free slots are part of the tree (so it does not need a rebuild when they come back), but can not be hit
+    for (int i = 0; i < slots; i++)
     {
-        if (enemy->getLifeState()) // check if enemy is alive
+        if (!drones.inUse[i] || drones.isDead[i])
         {
-            enemy->gotHit(); // kill enemy
-            player.updateKills(); // update killcount by one
+            droneTree.disable(i);
         }
     }
+    droneTree.refit();
+    ticksSinceRebuild = 0;
 }
 
-void CollisionDetector::EnemyAttacksPlayer(Player &player, std::shared_ptr<Enemy> enemy)
+void CollisionDetector::PlayerAttacksEnemy(PlayerState &player, DroneSwarm &drones, std::vector<SimEvent> &events)
 {
-    // construct ray object with enemy position and laser direction
-    Ray ray = Ray(enemy->position, enemy->laserDirection);
+    // construct ray object with start position and direction of bullet
+    Ray ray(player.position, player.front);
 
-    // check for collision
-    if (player.boundingBox.intersect(ray, enemy->range))
+    // find the nearest drone along the bullet's path
+    int slot;
+    float distance;
+    if (!droneTree.raycast(ray, player.range, slot, distance))
     {
-        player.gotAttacked(Enemy::DAMAGE); // decrease player's health
-        enemy->canDamage = false; // set to false to ensure that player's health only decreases once per hit
+        return;
     }
-}
\ No newline at end of file
+
+    // only a living drone can be killed, a stale entry in the tree does not count
+    if (!drones.inUse[slot] || drones.isDead[slot])
+    {
+        return;
+    }
+
+    // the bullet stops at an obstacle in front of the drone
+    int obstacle;
+    float obstacleDistance;
+    if (obstacleTree.raycast(ray, distance, obstacle, obstacleDistance))
+    {
+        return;
+    }
+
+    drones.isDead[slot] = 1; // kill drone
+    player.kills++; // update killcount by one
+    events.push_back({SimEventType::DRONE_KILLED, slot});
+    droneGrid.remove(slot);
+    droneTree.disable(slot); // takes effect with the next refit
+}
+
+bool CollisionDetector::EnemyAttacksPlayer(const PlayerState &player, const DroneSwarm &drones, int slot)
+{
+    // construct ray object with the position the drone fired from and laser direction
+    glm::vec3 laserDirection(drones.laserDirX[slot], drones.laserDirY[slot], drones.laserDirZ[slot]);
+    Ray ray = Ray(laserOrigin[slot], glm::normalize(laserDirection));
+
+    // check for collision (the beam ends at the first obstacle)
+    float distance;
+    return player.boundingBox.intersect(ray, laserLength[slot], distance);
+}
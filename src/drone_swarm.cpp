@@ -0,0 +1,341 @@
+#include "drone_swarm.h"
+
+#include <cmath>
+
+#include <glm/gtc/constants.hpp>
+
+DroneSwarm::DroneSwarm()
+{
+    drones = 0;
+}
+
+void DroneSwarm::reserve(int capacity)
+{
+    inUse.reserve(capacity);
+    posX.reserve(capacity);
+    posY.reserve(capacity);
+    posZ.reserve(capacity);
+    rotation.reserve(capacity);
+    prevX.reserve(capacity);
+    prevY.reserve(capacity);
+    prevZ.reserve(capacity);
+    prevRotation.reserve(capacity);
+    attackTime.reserve(capacity);
+    isDead.reserve(capacity);
+    explodeTime.reserve(capacity);
+    spawnInterval.reserve(capacity);
+    magnitude.reserve(capacity);
+    canDamage.reserve(capacity);
+    laserDirX.reserve(capacity);
+    laserDirY.reserve(capacity);
+    laserDirZ.reserve(capacity);
+    flags.reserve(capacity);
+    boxMinX.reserve(capacity);
+    boxMinY.reserve(capacity);
+    boxMinZ.reserve(capacity);
+    boxMaxX.reserve(capacity);
+    boxMaxY.reserve(capacity);
+    boxMaxZ.reserve(capacity);
+    freeSlots.reserve(capacity);
+}
+
+int DroneSwarm::spawn(glm::vec3 position)
+{
+    int slot;
+    if (!freeSlots.empty())
+    {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else
+    {
+        // grow all arrays by one slot
+        slot = slots();
+        inUse.push_back(0);
+        posX.push_back(0);
+        posY.push_back(0);
+        posZ.push_back(0);
+        rotation.push_back(0);
+        prevX.push_back(0);
+        prevY.push_back(0);
+        prevZ.push_back(0);
+        prevRotation.push_back(0);
+        attackTime.push_back(0);
+        isDead.push_back(0);
+        explodeTime.push_back(0);
+        spawnInterval.push_back(0);
+        magnitude.push_back(0);
+        canDamage.push_back(0);
+        laserDirX.push_back(0);
+        laserDirY.push_back(0);
+        laserDirZ.push_back(0);
+        flags.push_back(0);
+        boxMinX.push_back(0);
+        boxMinY.push_back(0);
+        boxMinZ.push_back(0);
+        boxMaxX.push_back(0);
+        boxMaxY.push_back(0);
+        boxMaxZ.push_back(0);
+    }
+
+    inUse[slot] = 1;
+    drones++;
+    respawn(slot, position);
+    return slot;
+}
+
+void DroneSwarm::respawn(int slot, glm::vec3 position)
+{
+    posX[slot] = position.x;
+    posY[slot] = position.y;
+    posZ[slot] = position.z;
+    rotation[slot] = 0;
+    storePrevious(slot, slot + 1); // no interpolation from the old position
+    attackTime[slot] = 0;
+    isDead[slot] = 0;
+    explodeTime[slot] = 0;
+    spawnInterval[slot] = 0;
+    magnitude[slot] = 0;
+    canDamage[slot] = 0;
+    laserDirX[slot] = 0;
+    laserDirY[slot] = 0;
+    laserDirZ[slot] = 0;
+    flags[slot] = 0;
+    calculateBoundingBoxes(slot, slot + 1);
+}
+
+void DroneSwarm::despawn(int slot)
+{
+    if (!inUse[slot])
+    {
+        return;
+    }
+    inUse[slot] = 0;
+    canDamage[slot] = 0;
+    flags[slot] = 0;
+    freeSlots.push_back(slot);
+    drones--;
+}
+
+void DroneSwarm::clear()
+{
+    // slots are handed out again from the lowest index
+    freeSlots.clear();
+    for (int slot = slots() - 1; slot >= 0; slot--)
+    {
+        inUse[slot] = 0;
+        canDamage[slot] = 0;
+        flags[slot] = 0;
+        freeSlots.push_back(slot);
+    }
+    drones = 0;
+}
+
+int DroneSwarm::slots() const
+{
+    return static_cast<int>(inUse.size());
+}
+
+int DroneSwarm::count() const
+{
+    return drones;
+}
+
+DroneState DroneSwarm::get(int slot) const
+{
+    DroneState drone;
+    drone.position = glm::vec3(posX[slot], posY[slot], posZ[slot]);
+    drone.rotation = rotation[slot];
+    drone.attackTime = attackTime[slot];
+    drone.isDead = isDead[slot];
+    drone.explodeTime = explodeTime[slot];
+    drone.spawnInterval = spawnInterval[slot];
+    drone.magnitude = magnitude[slot];
+    drone.canDamage = canDamage[slot];
+    drone.laserDirection = glm::vec3(laserDirX[slot], laserDirY[slot], laserDirZ[slot]);
+    drone.boundingBox = getBoundingBox(slot);
+    return drone;
+}
+
+DroneState DroneSwarm::getInterpolated(int slot, float alpha) const
+{
+    DroneState drone = get(slot);
+    drone.position = glm::mix(glm::vec3(prevX[slot], prevY[slot], prevZ[slot]), drone.position, alpha);
+
+    // turn the short way around (atan2 wraps around at +-180 degrees)
+    float turn = rotation[slot] - prevRotation[slot];
+    turn -= glm::two_pi<float>() * std::floor((turn + glm::pi<float>()) / glm::two_pi<float>());
+    drone.rotation = prevRotation[slot] + turn * alpha;
+    return drone;
+}
+
+AABBox DroneSwarm::getBoundingBox(int slot) const
+{
+    return AABBox(glm::vec3(boxMinX[slot], boxMinY[slot], boxMinZ[slot]),
+                  glm::vec3(boxMaxX[slot], boxMaxY[slot], boxMaxZ[slot]));
+}
+
+void DroneSwarm::storePrevious(int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        prevX[i] = posX[i];
+        prevY[i] = posY[i];
+        prevZ[i] = posZ[i];
+        prevRotation[i] = rotation[i];
+    }
+}
+
+void DroneSwarm::moveToPlayer(glm::vec3 playerPos, float distance, int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        if (!inUse[i] || isDead[i])
+        {
+            continue;
+        }
+
+        // create direction vector (y level of drone does not change)
+        float dx = playerPos.x - posX[i];
+        float dy = playerPos.y - posY[i];
+        float dz = playerPos.z - posZ[i];
+
+        // normalize vector
+        float magnitude = std::sqrt(dx * dx + dy * dy + dz * dz);
+        if (magnitude < 1)
+        {
+            magnitude = 1;
+        }
+
+        // update position
+        posX[i] += (dx / magnitude) * distance;
+        posZ[i] += (dz / magnitude) * distance;
+
+        // calculate rotation angle so that the drone points towards the player's position
+        rotation[i] = std::atan2(playerPos.z - posZ[i], playerPos.x - posX[i]) + glm::radians(90.0f);
+    }
+}
+
+/*
+To construct a bounding box we need two things: a minimum bound and a maximum bound.
+We also want the bounding box to rotate with the model.
+We can imagine the bounding box like a quadrilateral inscribed in a circle where the center is
+the position of the drone on the x z plane. The two bounds represent two points on that circle.
+We don't actually need all 4 points to create a bounding box, the two min and max bounds are enough.
+If the model rotates N degrees, we also want those two points to rotate N degrees.
+So we baically we rotate those two points (the bounds) about the center by N degrees.
+The formula (for counter clockwise rotation) is as follows:
+
+newX = cos(θ) * (X - Cx) - sin(θ) * (Y - Cy) + Cx.
+newY = sin(θ) * (X - Cx) + cos(θ) * (Y - Cy) + Cy.
+
+Cx and Cy are the center coordinates, θ is the angle in radians,
+X and Y are the initial coordinates and newX and newY are the rotated coordinates.
+
+Formula from https://math.stackexchange.com/a/814981.
+
+Since the bounds start at (Cx -/+ 0.3, Cz -/+ 1.0), the offsets (X - Cx) and (Y - Cy) are constants
+and only the sine and cosine of the rotation are needed per drone.
+
+Important note: in this program the y coordinate remains untouched because the height of the box does
+not change when rotating it around the y - axis. Also, the current implementation of calculateBoundingBoxes
+is based on the drone model scaled by factor 0.6. The bounding box does not contain the whole model,
+but this is not a problem because the model is quite big, so it is not too difficult to hit it.
+See /doc/enemy_bbox for a visualization.
+*/
+
+void DroneSwarm::calculateBoundingBoxes(int begin, int end)
+{
+    const float halfWidth = 0.3f;  // half of the box size along x before rotating
+    const float halfLength = 1.0f; // half of the box size along z before rotating
+    const float height = 0.7f;     // height of the box
+
+    for (int i = begin; i < end; i++)
+    {
+        if (!inUse[i] || isDead[i])
+        {
+            continue;
+        }
+
+        float c = std::cos(rotation[i]);
+        float s = std::sin(rotation[i]);
+
+        // rotate (-halfWidth, -halfLength) and (halfWidth, halfLength) about the center
+        float offsetX = c * halfWidth - s * halfLength;
+        float offsetZ = s * halfWidth + c * halfLength;
+        float minX = posX[i] - offsetX;
+        float minZ = posZ[i] - offsetZ;
+        float maxX = posX[i] + offsetX;
+        float maxZ = posZ[i] + offsetZ;
+
+        // swap values when necessary (same as AABBox::fix)
+        boxMinX[i] = minX < maxX ? minX : maxX;
+        boxMaxX[i] = minX < maxX ? maxX : minX;
+        boxMinZ[i] = minZ < maxZ ? minZ : maxZ;
+        boxMaxZ[i] = minZ < maxZ ? maxZ : minZ;
+        boxMinY[i] = posY[i];
+        boxMaxY[i] = posY[i] + height;
+    }
+}
+
+void DroneSwarm::advanceTimers(float dt, int begin, int end)
+{
+    for (int i = begin; i < end; i++)
+    {
+        flags[i] = 0;
+        if (!inUse[i])
+        {
+            continue;
+        }
+
+        if (!isDead[i])
+        {
+            // check if drone can attack
+            attackTime[i] += dt;
+            if (attackTime[i] >= DroneState::ATTACK_INTERVAL)
+            {
+                attackTime[i] = 0;
+                flags[i] = FLAG_FIRED;
+            }
+        }
+        else
+        {
+            explodeTime[i] += dt;
+
+            // explosion
+            if (explodeTime[i] <= DroneState::EXPLODE_DURATION)
+            {
+                magnitude[i] = explodeTime[i] * 8.0f;
+            }
+            // spawn drone again in new position after time interval has passed
+            else
+            {
+                spawnInterval[i] += dt;
+                if (spawnInterval[i] >= DroneState::SPAWN_INTERVAL)
+                {
+                    flags[i] = FLAG_RESPAWNED;
+                }
+            }
+        }
+    }
+}
+
+void DroneSwarm::calculateLaserDirections(const int *drones, const float *offsets, int count, glm::vec3 playerPos)
+{
+    for (int n = 0; n < count; n++)
+    {
+        int i = drones[n];
+
+        // create a direction vector and normalize it
+        float dx = playerPos.x - posX[i];
+        float dy = playerPos.y - posY[i];
+        float dz = playerPos.z - posZ[i];
+        float d = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+        // add random offset (otherwise the drone's aim would too good)
+        laserDirX[i] = dx / d + offsets[n];
+        laserDirY[i] = dy / d + offsets[n];
+        laserDirZ[i] = dz / d + offsets[n];
+        canDamage[i] = 1; // set to true so that the laser can damage player
+    }
+}
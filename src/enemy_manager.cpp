@@ -1,47 +1,171 @@
 #include "enemy_manager.h"
+#include "profiler.h"
+#include "gl_state.h"
 
-const int EnemyManager::MAX_ENEMIES = 3;
-const float EnemyManager::INTERVAL = 3.0f;
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * @brief Creates the model matrix of a drone (the rotation makes the drone point towards the player's position).
+ *
+ * @param drone drone state.
+ * @return glm::mat4 model matrix.
+ */
+static glm::mat4 droneModelMatrix(const DroneState &drone)
+{
+    glm::mat4 modelMatrix = glm::mat4(1.0f);
+    modelMatrix = glm::translate(modelMatrix, drone.position);
+    modelMatrix = glm::rotate(modelMatrix, drone.rotation, glm::vec3(0.0f, -1.0f, 0.0f));
+    modelMatrix = glm::scale(modelMatrix, glm::vec3(DroneState::SCALE));
+    return modelMatrix;
+}
+
+const unsigned int EnemyManager::EXPLODE = 1;
 
 EnemyManager::EnemyManager()
 {
-    // set default values
-    enemyCount = 1; // always start with at least one enemy
-    spawnTime = 0;
+    // load the drone model and shaders once for all enemies
+    drone = ResourceRegistry::getModel("resources/models/drone/E 45 Aircraft_obj.obj", false);
+    droneShaders = ShaderPermutations("shaders/explode.vert", "shaders/explode.frag", "shaders/explode.geom", {"EXPLODE"}, EXPLODE);
+    droneShaders.get(0);       // compile both permutations now instead of when the first drone explodes
+    droneShaders.get(EXPLODE);
+
+    // instance buffer, the per-instance attributes are added to the vertex arrays of the drone meshes
+    instanceBuffer.create();
+    instanceCapacity = 0;
+    for (unsigned int i = 0; i < drone->meshes.size(); i++)
+    {
+        GLState::bindVertexArray(drone->meshes[i].VAO.get());
+        for (unsigned int location = 3; location <= 7; location++)
+        {
+            glEnableVertexAttribArray(location);
+            glVertexAttribDivisor(location, 1);
+        }
+    }
+    GLState::bindVertexArray(0);
+    instanceBase = 1; // anything but 0, so the attribute pointers are set
+    setInstanceBase(0);
 
     // initialize enemies
-    for (unsigned int i = 0; i < MAX_ENEMIES; i++)
+    for (int i = 0; i < Simulation::MAX_DRONES; i++)
     {
         enemies.push_back(std::make_shared<Enemy>());
     }
 }
 
-void EnemyManager::manage(glm::vec3 playerPos, glm::mat4 viewMatrix, glm::mat4 projectionMatrix)
+void EnemyManager::manage(const Simulation &sim, float alpha, glm::mat4 viewMatrix, glm::mat4 projectionMatrix)
 {
-    if (enemyCount < MAX_ENEMIES + 1) // enemyCount starts at 1
+    PROFILE_ZONE("EnemyManager::manage");
+
+    // react to what happened in the simulation since the last frame
+    for (const SimEvent &event : sim.getEvents())
     {
-        spawnTime += deltaTime;
-        if (spawnTime >= INTERVAL)
+        if (event.drone < 0 || event.drone >= static_cast<int>(enemies.size()))
         {
-            enemyCount++;
-            spawnTime = 0;
+            continue;
+        }
+        DroneState drone = sim.drones.get(event.drone);
+        switch (event.type)
+        {
+            case SimEventType::LASER_FIRED:
+                enemies[event.drone]->fireLaser(drone, sim.player.position);
+                break;
+            case SimEventType::DRONE_KILLED:
+                enemies[event.drone]->explode(drone, sim.player.position);
+                break;
+            case SimEventType::DRONE_RESPAWNED:
+                enemies[event.drone]->silence();
+                break;
+            default:
+                break;
         }
     }
-    
-    for (unsigned int i = 0; i < enemyCount - 1; i++)
+
+    // only the first enemies.size() slots have an enemy object to render them
+    int slots = std::min(sim.drones.slots(), static_cast<int>(enemies.size()));
+    liveInstances.clear();
+    explodingInstances.clear();
+    for (int i = 0; i < slots; i++)
     {
-        enemies[i]->currentFrame = currentTime;
-        enemies[i]->deltaTime = deltaTime;
-        enemies[i]->controlEnemyLife(playerPos, viewMatrix, projectionMatrix);
+        if (sim.drones.inUse[i])
+        {
+            DroneState drone = sim.drones.getInterpolated(i, alpha);
+            if (drone.isVisible())
+            {
+                std::vector<DroneInstance> &instances = drone.isDead ? explodingInstances : liveInstances;
+                instances.push_back({droneModelMatrix(drone), drone.magnitude});
+            }
+            enemies[i]->render(drone, sim.player.position, viewMatrix, projectionMatrix);
+        }
+    }
+    drawDrones();
+    PROFILE_COUNTER("drones drawn", liveInstances.size() + explodingInstances.size());
+}
+
+void EnemyManager::setInstanceBase(size_t first)
+{
+    if (first == instanceBase)
+    {
+        return;
+    }
+    instanceBase = first;
+
+    // model matrix (4 times vec4) at locations 3-6 and the explosion magnitude at location 7
+    size_t offset = first * sizeof(DroneInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.get());
+    for (unsigned int i = 0; i < drone->meshes.size(); i++)
+    {
+        GLState::bindVertexArray(drone->meshes[i].VAO.get());
+        for (unsigned int column = 0; column < 4; column++)
+        {
+            glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(DroneInstance), (void *)(offset + offsetof(DroneInstance, model) + column * sizeof(glm::vec4)));
+        }
+        glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, sizeof(DroneInstance), (void *)(offset + offsetof(DroneInstance, magnitude)));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void EnemyManager::drawDrones()
+{
+    size_t count = liveInstances.size() + explodingInstances.size();
+    if (count == 0)
+    {
+        return;
+    }
+
+    // upload the instances (live drones first); the buffer only grows, and is orphaned every frame so the driver never waits for the previous draw
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer.get());
+    if (count > instanceCapacity)
+    {
+        instanceCapacity = std::max(count, 2 * instanceCapacity);
+    }
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(DroneInstance), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, liveInstances.size() * sizeof(DroneInstance), liveInstances.data());
+    glBufferSubData(GL_ARRAY_BUFFER, liveInstances.size() * sizeof(DroneInstance), explodingInstances.size() * sizeof(DroneInstance), explodingInstances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // one draw call per drone mesh for all live drones, and one for all exploding drones (with the geometry shader)
+    GLState::setEnabled(GL_DEPTH_TEST, true);
+    if (!liveInstances.empty())
+    {
+        Shader &shader = droneShaders.get(0);
+        shader.use();
+        setInstanceBase(0);
+        drone->DrawInstanced(shader, static_cast<unsigned int>(liveInstances.size()));
+    }
+    if (!explodingInstances.empty())
+    {
+        Shader &shader = droneShaders.get(EXPLODE);
+        shader.use();
+        setInstanceBase(liveInstances.size());
+        drone->DrawInstanced(shader, static_cast<unsigned int>(explodingInstances.size()));
     }
 }
 
 void EnemyManager::reset()
 {
-    for (unsigned int i = 0; i < enemyCount - 1; i++)
+    for (unsigned int i = 0; i < enemies.size(); i++)
     {
-        enemies[i]->setDefaultValues(); // also reset enemies
+        enemies[i]->silence(); // also reset enemies
     }
-    enemyCount = 1; 
-    spawnTime = 0;
-}
\ No newline at end of file
+}
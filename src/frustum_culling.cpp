@@ -0,0 +1,163 @@
+#include "frustum_culling.h"
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#define FRUSTUM_CULLING_SSE
+#include <emmintrin.h>
+#endif
+
+/*
+A sphere is outside the frustum if its center lies further than its radius behind one of the planes,
+i.e. if a*x + b*y + c*z + d < -radius for any plane. All code paths use this test.
+*/
+
+Frustum Frustum::fromMatrix(const glm::mat4 &viewProjection)
+{
+    // Gribb/Hartmann: every plane is the sum or difference of the fourth row and one of the other rows
+    glm::mat4 m = glm::transpose(viewProjection); // columns of m are the rows of viewProjection
+    Frustum frustum;
+    frustum.planes[0] = m[3] + m[0]; // left
+    frustum.planes[1] = m[3] - m[0]; // right
+    frustum.planes[2] = m[3] + m[1]; // bottom
+    frustum.planes[3] = m[3] - m[1]; // top
+    frustum.planes[4] = m[3] + m[2]; // near
+    frustum.planes[5] = m[3] - m[2]; // far
+    for (glm::vec4 &plane : frustum.planes)
+    {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f)
+        {
+            plane /= length;
+        }
+    }
+    return frustum;
+}
+
+void BoundingSpheres::add(const glm::vec3 &center, float r)
+{
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    radius.push_back(r);
+}
+
+void BoundingSpheres::clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    radius.clear();
+}
+
+int BoundingSpheres::size() const
+{
+    return static_cast<int>(x.size());
+}
+
+// scalar test of the spheres in [begin, end), appends the visible ones
+static void cullScalar(const Frustum &frustum, const BoundingSpheres &spheres, int begin, int end, std::vector<unsigned int> &visible)
+{
+    for (int i = begin; i < end; i++)
+    {
+        bool inside = true;
+        for (const glm::vec4 &plane : frustum.planes)
+        {
+            // same order of operations as the SIMD paths, so all paths give the same result
+            float distance = (plane.x * spheres.x[i] + plane.y * spheres.y[i]) + (plane.z * spheres.z[i] + plane.w);
+            if (distance < -spheres.radius[i])
+            {
+                inside = false;
+                break;
+            }
+        }
+        if (inside)
+        {
+            visible.push_back(static_cast<unsigned int>(i));
+        }
+    }
+}
+
+int cullSpheresScalar(const Frustum &frustum, const BoundingSpheres &spheres, std::vector<unsigned int> &visible)
+{
+    visible.clear();
+    cullScalar(frustum, spheres, 0, spheres.size(), visible);
+    return static_cast<int>(visible.size());
+}
+
+int cullSpheres(const Frustum &frustum, const BoundingSpheres &spheres, std::vector<unsigned int> &visible)
+{
+    visible.clear();
+    int count = spheres.size();
+    int i = 0;
+
+#if defined(__AVX2__)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&spheres.x[i]);
+        __m256 y = _mm256_loadu_ps(&spheres.y[i]);
+        __m256 z = _mm256_loadu_ps(&spheres.z[i]);
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const glm::vec4 &plane : frustum.planes)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), x), _mm256_mul_ps(_mm256_set1_ps(plane.y), y)),
+                                            _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), z), _mm256_set1_ps(plane.w)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+        }
+        // compact: append the indices of the visible lanes
+        int mask = _mm256_movemask_ps(inside);
+        for (int lane = 0; lane < 8; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                visible.push_back(static_cast<unsigned int>(i + lane));
+            }
+        }
+    }
+#endif
+
+#if defined(FRUSTUM_CULLING_SSE)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(&spheres.x[i]);
+        __m128 y = _mm_loadu_ps(&spheres.y[i]);
+        __m128 z = _mm_loadu_ps(&spheres.z[i]);
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const glm::vec4 &plane : frustum.planes)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x), _mm_mul_ps(_mm_set1_ps(plane.y), y)),
+                                         _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), z), _mm_set1_ps(plane.w)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+        // compact: append the indices of the visible lanes
+        int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (mask & (1 << lane))
+            {
+                visible.push_back(static_cast<unsigned int>(i + lane));
+            }
+        }
+    }
+#endif
+
+    // the rest one at a time
+    cullScalar(frustum, spheres, i, count, visible);
+    return static_cast<int>(visible.size());
+}
+
+const char *frustumCullingInstructionSet()
+{
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(FRUSTUM_CULLING_SSE)
+    return "SSE";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,40 @@
+#include "gl_object.h"
+#include "gl_state.h"
+
+GLuint BufferTraits::create()
+{
+    GLuint name;
+    glGenBuffers(1, &name);
+    return name;
+}
+
+void BufferTraits::destroy(GLuint name)
+{
+    glDeleteBuffers(1, &name);
+}
+
+GLuint VertexArrayTraits::create()
+{
+    GLuint name;
+    glGenVertexArrays(1, &name);
+    return name;
+}
+
+void VertexArrayTraits::destroy(GLuint name)
+{
+    GLState::forgetVertexArray(name);
+    glDeleteVertexArrays(1, &name);
+}
+
+GLuint TextureTraits::create()
+{
+    GLuint name;
+    glGenTextures(1, &name);
+    return name;
+}
+
+void TextureTraits::destroy(GLuint name)
+{
+    GLState::forgetTexture(name);
+    glDeleteTextures(1, &name);
+}
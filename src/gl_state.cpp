@@ -0,0 +1,280 @@
+#include "gl_state.h"
+
+const unsigned int GLState::TEXTURE_UNITS = 16;
+
+namespace
+{
+// tracked capabilities
+enum Capability
+{
+    DEPTH_TEST,
+    BLEND,
+    CULL_FACE,
+    CAPABILITY_COUNT
+};
+
+/// A tracked value; unknown until it has been set once (after invalidate).
+template <typename T>
+struct Tracked
+{
+    T value;
+    bool known;
+
+    /// Returns true if the value changes (and stores it), false if the call can be skipped.
+    bool set(T newValue)
+    {
+        if (known && value == newValue)
+        {
+            return false;
+        }
+        value = newValue;
+        known = true;
+        return true;
+    }
+};
+
+// tracked state, starts with the defaults of a new context
+struct State
+{
+    Tracked<GLuint> program;
+    Tracked<GLuint> vertexArray;
+    Tracked<unsigned int> activeUnit;
+    Tracked<GLuint> texture2D[GLState::TEXTURE_UNITS];
+    Tracked<GLuint> textureCubeMap[GLState::TEXTURE_UNITS];
+    Tracked<bool> capabilities[CAPABILITY_COUNT];
+    Tracked<GLenum> depthFunc;
+    Tracked<bool> depthMask;
+    Tracked<GLenum> blendSource;
+    Tracked<GLenum> blendDestination;
+
+    State()
+    {
+        program = {0, true};
+        vertexArray = {0, true};
+        activeUnit = {0, true};
+        for (unsigned int i = 0; i < GLState::TEXTURE_UNITS; i++)
+        {
+            texture2D[i] = {0, true};
+            textureCubeMap[i] = {0, true};
+        }
+        for (Tracked<bool> &capability : capabilities)
+        {
+            capability = {false, true};
+        }
+        depthFunc = {GL_LESS, true};
+        depthMask = {true, true};
+        blendSource = {GL_ONE, true};
+        blendDestination = {GL_ZERO, true};
+    }
+};
+
+State state;        // only used on the thread that owns the OpenGL context
+GLStateStats stats; // calls issued and skipped
+
+/// Counts a call, returns changed (the call has to be passed on).
+bool count(bool changed)
+{
+    if (changed)
+    {
+        stats.issued++;
+    }
+    else
+    {
+        stats.elided++;
+    }
+    return changed;
+}
+
+/// Returns the index of a tracked capability, or CAPABILITY_COUNT if it is not tracked.
+int capabilityIndex(GLenum capability)
+{
+    switch (capability)
+    {
+    case GL_DEPTH_TEST:
+        return DEPTH_TEST;
+    case GL_BLEND:
+        return BLEND;
+    case GL_CULL_FACE:
+        return CULL_FACE;
+    default:
+        return CAPABILITY_COUNT;
+    }
+}
+} // namespace
+
+void GLState::useProgram(GLuint program)
+{
+    if (count(state.program.set(program)))
+    {
+        glUseProgram(program);
+    }
+}
+
+void GLState::bindVertexArray(GLuint VAO)
+{
+    if (count(state.vertexArray.set(VAO)))
+    {
+        glBindVertexArray(VAO);
+    }
+}
+
+void GLState::bindTexture(unsigned int unit, GLenum target, GLuint texture)
+{
+    Tracked<GLuint> *binding = nullptr;
+    if (unit < TEXTURE_UNITS && target == GL_TEXTURE_2D)
+    {
+        binding = &state.texture2D[unit];
+    }
+    else if (unit < TEXTURE_UNITS && target == GL_TEXTURE_CUBE_MAP)
+    {
+        binding = &state.textureCubeMap[unit];
+    }
+
+    if (binding != nullptr && !count(binding->set(texture)))
+    {
+        return;
+    }
+    if (binding == nullptr)
+    {
+        stats.issued++;
+    }
+    if (count(state.activeUnit.set(unit)))
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    glBindTexture(target, texture);
+}
+
+void GLState::setEnabled(GLenum capability, bool enabled)
+{
+    int index = capabilityIndex(capability);
+    if (index != CAPABILITY_COUNT && !count(state.capabilities[index].set(enabled)))
+    {
+        return;
+    }
+    if (index == CAPABILITY_COUNT)
+    {
+        stats.issued++;
+    }
+    if (enabled)
+    {
+        glEnable(capability);
+    }
+    else
+    {
+        glDisable(capability);
+    }
+}
+
+bool GLState::isEnabled(GLenum capability)
+{
+    int index = capabilityIndex(capability);
+    if (index == CAPABILITY_COUNT)
+    {
+        return glIsEnabled(capability) == GL_TRUE;
+    }
+    if (!state.capabilities[index].known)
+    {
+        state.capabilities[index].set(glIsEnabled(capability) == GL_TRUE); // only after invalidate
+    }
+    return state.capabilities[index].value;
+}
+
+void GLState::depthFunc(GLenum func)
+{
+    if (count(state.depthFunc.set(func)))
+    {
+        glDepthFunc(func);
+    }
+}
+
+void GLState::depthMask(bool write)
+{
+    if (count(state.depthMask.set(write)))
+    {
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+}
+
+bool GLState::getDepthMask()
+{
+    if (!state.depthMask.known)
+    {
+        GLboolean mask;
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &mask); // only after invalidate
+        state.depthMask.set(mask == GL_TRUE);
+    }
+    return state.depthMask.value;
+}
+
+void GLState::blendFunc(GLenum sourceFactor, GLenum destinationFactor)
+{
+    // both factors are set by one call
+    bool changed = state.blendSource.set(sourceFactor);
+    changed = state.blendDestination.set(destinationFactor) || changed;
+    if (count(changed))
+    {
+        glBlendFunc(sourceFactor, destinationFactor);
+    }
+}
+
+void GLState::forgetTexture(GLuint texture)
+{
+    for (unsigned int i = 0; i < TEXTURE_UNITS; i++)
+    {
+        if (state.texture2D[i].value == texture)
+        {
+            state.texture2D[i].value = 0;
+        }
+        if (state.textureCubeMap[i].value == texture)
+        {
+            state.textureCubeMap[i].value = 0;
+        }
+    }
+}
+
+void GLState::forgetVertexArray(GLuint VAO)
+{
+    if (state.vertexArray.value == VAO)
+    {
+        state.vertexArray.value = 0;
+    }
+}
+
+void GLState::forgetProgram(GLuint program)
+{
+    if (state.program.value == program)
+    {
+        state.program.known = false;
+    }
+}
+
+void GLState::invalidate()
+{
+    state.program.known = false;
+    state.vertexArray.known = false;
+    state.activeUnit.known = false;
+    for (unsigned int i = 0; i < TEXTURE_UNITS; i++)
+    {
+        state.texture2D[i].known = false;
+        state.textureCubeMap[i].known = false;
+    }
+    for (Tracked<bool> &capability : state.capabilities)
+    {
+        capability.known = false;
+    }
+    state.depthFunc.known = false;
+    state.depthMask.known = false;
+    state.blendSource.known = false;
+    state.blendDestination.known = false;
+}
+
+void GLState::resetStats()
+{
+    stats = GLStateStats();
+}
+
+const GLStateStats &GLState::getStats()
+{
+    return stats;
+}
@@ -24,6 +24,9 @@ GLFWwindow* setup(const char* title, int height, int width)
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
+    // no vsync: gameplay runs at a fixed tick rate (see simulation.h), so the frame rate does not change the game
+    glfwSwapInterval(0);
+
     // tell GLFW to capture the mouse
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
@@ -0,0 +1,151 @@
+#include "gpu_timer.h"
+
+#include <iostream>
+
+const int GpuTimer::FRAMES = 2;
+
+GpuTimer::GpuTimer()
+{
+    queries.resize(FRAMES * PASS_COUNT);
+    glGenQueries(static_cast<GLsizei>(queries.size()), queries.data());
+    issued.assign(queries.size(), false);
+    frameNumbers.assign(FRAMES, 0);
+    for (int pass = 0; pass < PASS_COUNT; pass++)
+    {
+        milliseconds[pass] = 0.0f;
+    }
+    frame = 0;
+    active = -1;
+}
+
+GpuTimer::~GpuTimer()
+{
+    glDeleteQueries(static_cast<GLsizei>(queries.size()), queries.data());
+}
+
+void GpuTimer::beginFrame()
+{
+    frame++;
+    int slot = static_cast<int>(frame % FRAMES);
+    GLuint *slotQueries = &queries[slot * PASS_COUNT];
+
+    // the results of the frame that used this slot, if the GPU has all of them (never wait for it)
+    bool ready = true;
+    bool any = false;
+    for (int pass = 0; pass < PASS_COUNT && ready; pass++)
+    {
+        if (issued[slot * PASS_COUNT + pass])
+        {
+            GLint available = 0;
+            glGetQueryObjectiv(slotQueries[pass], GL_QUERY_RESULT_AVAILABLE, &available);
+            ready = available != 0;
+            any = true;
+        }
+    }
+    if (any && ready)
+    {
+        for (int pass = 0; pass < PASS_COUNT; pass++)
+        {
+            GLuint64 nanoseconds = 0;
+            if (issued[slot * PASS_COUNT + pass])
+            {
+                glGetQueryObjectui64v(slotQueries[pass], GL_QUERY_RESULT, &nanoseconds);
+            }
+            milliseconds[pass] = static_cast<float>(nanoseconds / 1.0e6);
+        }
+
+        if (log.is_open())
+        {
+            log << frameNumbers[slot];
+            for (int pass = 0; pass < PASS_COUNT; pass++)
+            {
+                log << ',' << milliseconds[pass];
+            }
+            log << ',' << getTotalMilliseconds() << '\n';
+        }
+    }
+
+    // the slot is reused by this frame (a query that is started again simply drops its old result)
+    for (int pass = 0; pass < PASS_COUNT; pass++)
+    {
+        issued[slot * PASS_COUNT + pass] = false;
+    }
+    frameNumbers[slot] = frame;
+}
+
+void GpuTimer::begin(GpuPass pass)
+{
+    if (active >= 0)
+    {
+        std::cout << "ERROR::GPU_TIMER::Pass " << passName(pass) << " started while " << passName(static_cast<GpuPass>(active)) << " is running" << std::endl;
+        return;
+    }
+    int index = static_cast<int>(frame % FRAMES) * PASS_COUNT + static_cast<int>(pass);
+    glBeginQuery(GL_TIME_ELAPSED, queries[index]);
+    issued[index] = true;
+    active = static_cast<int>(pass);
+}
+
+void GpuTimer::end()
+{
+    if (active < 0)
+    {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+    active = -1;
+}
+
+float GpuTimer::getMilliseconds(GpuPass pass) const
+{
+    return milliseconds[static_cast<int>(pass)];
+}
+
+float GpuTimer::getTotalMilliseconds() const
+{
+    float total = 0.0f;
+    for (int pass = 0; pass < PASS_COUNT; pass++)
+    {
+        total += milliseconds[pass];
+    }
+    return total;
+}
+
+bool GpuTimer::openLog(const std::string &path)
+{
+    log.open(path, std::ios::app);
+    if (!log)
+    {
+        std::cout << "ERROR::GPU_TIMER::Could not open " << path << std::endl;
+        return false;
+    }
+
+    // header only for a new file, so several runs can be appended to the same log
+    log.seekp(0, std::ios::end);
+    if (log.tellp() > 0)
+    {
+        return true;
+    }
+    log << "frame";
+    for (int pass = 0; pass < PASS_COUNT; pass++)
+    {
+        log << ',' << passName(static_cast<GpuPass>(pass));
+    }
+    log << ",total\n";
+    return true;
+}
+
+const char *GpuTimer::passName(GpuPass pass)
+{
+    switch (pass)
+    {
+        case GpuPass::SKYBOX: return "skybox";
+        case GpuPass::GROUND: return "ground";
+        case GpuPass::SURROUNDINGS: return "surroundings";
+        case GpuPass::TREES: return "trees";
+        case GpuPass::DRONES: return "drones";
+        case GpuPass::GUN: return "gun";
+        case GpuPass::HUD: return "hud";
+        default: return "unknown";
+    }
+}
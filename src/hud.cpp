@@ -1,18 +1,30 @@
 #include "hud.h"
 #include "screen_renderer.h"
 #include "texture_loading.h"
+#include "profiler.h"
+#include "resource_registry.h"
 
 #include <algorithm>
+#include <cstdio>
 
-void startingScreen(TextRenderer &tr, Player &player, int selectedEnv)
-{
-    // update blink time
-    tr.blink += tr.deltaTime + 0.02; // add small offset to make text blink faster
+static const float BLINK_SPEED = 2.2f; // blink counter increase per second (text toggles at every whole number)
 
-    // render background image (lazy-initialized on first call)
+/// Renders the background image of the start and loading screen (lazy-initialized on first call).
+static void drawStartBackground()
+{
     static ScreenRenderer renderer("shaders/screen.vert", "shaders/screen.frag");
     static unsigned int bgTexture = TextureFromFile("game_start.png", "resources/screens", true);
     renderer.draw(bgTexture);
+}
+
+void startingScreen(TextRenderer &tr, Player &player, int selectedEnv)
+{
+    PROFILE_ZONE("startingScreen");
+    // update blink time
+    tr.blink += tr.deltaTime * BLINK_SPEED;
+
+    // render background image
+    drawStartBackground();
 
     // set projection matrix and render title screen with instructions on how to play
     tr.projection = player.getOrthoProjectionMatrix();
@@ -73,8 +85,75 @@ void startingScreen(TextRenderer &tr, Player &player, int selectedEnv)
     }
 }
 
+void loadingScreen(TextRenderer &tr, Player &player, int selectedEnv, float progress)
+{
+    PROFILE_ZONE("loadingScreen");
+    // update blink time
+    tr.blink += tr.deltaTime * BLINK_SPEED;
+
+    // render background image
+    drawStartBackground();
+
+    // set projection matrix and render the environment that is loaded and the progress
+    tr.projection = player.getOrthoProjectionMatrix();
+
+    // calculate scaling factors (all x-pos and y-pos in RenderText are based on a screen with height = 600 and width = 800)
+    float xScale = static_cast<float>(player.SCR_WIDTH) / 800.0f;
+    float yScale = static_cast<float>(player.SCR_HEIGHT) / 600.0f;
+
+    // also calculate text scale factor
+    float textScale = std::min(xScale, yScale);
+
+    const glm::vec3 purple(0.392f, 0.263f, 1.0f);
+    const glm::vec3 white(1.0f, 1.0f, 1.0f);
+
+    auto centeredX = [&](std::string_view text, float scale) {
+        return (static_cast<float>(player.SCR_WIDTH) - tr.MeasureText(text, scale)) * 0.5f;
+    };
+
+    // title
+    std::string_view title = "DRONE  SHOOTER";
+    float titleScale = 1.52f * textScale;
+    tr.RenderTextBordered(title, centeredX(title, titleScale), 475.0f * yScale, titleScale, purple, white);
+
+    // environment and progress
+    const std::string envNames[4] = {"DESERT", "FOREST", "SNOW", "NIGHT"};
+    std::string loading = "LOADING  " + envNames[selectedEnv];
+    float loadingScale = 0.62f * textScale;
+    tr.RenderTextBordered(loading, centeredX(loading, loadingScale), 315.0f * yScale, loadingScale, purple, white);
+
+    if (static_cast<int>(tr.blink) % 2 == 0 || progress >= 1.0f)
+    {
+        std::string percentage = std::to_string(static_cast<int>(progress * 100.0f)) + "  %";
+        float percentageScale = 0.55f * textScale;
+        tr.RenderText(percentage, centeredX(percentage, percentageScale), 260.0f * yScale, percentageScale, glm::vec3(0.82f, 0.82f, 0.82f));
+    }
+}
+
+/// HUD text whose quads are laid out once and only laid out again when the value it shows changes.
+struct RetainedText
+{
+    std::vector<TextVertex> vertices; // cached quads
+    int value = 0;                    // value the quads were laid out for
+    bool built = false;               // false until the quads are laid out for the first time
+
+    /// Returns true if the quads have to be laid out (again) to show value; starts over with no quads if so.
+    bool update(int newValue)
+    {
+        if (built && newValue == value)
+        {
+            return false;
+        }
+        vertices.clear();
+        value = newValue;
+        built = true;
+        return true;
+    }
+};
+
 void inGameScreen(TextRenderer &tr, Player &player)
 {
+    PROFILE_ZONE("inGameScreen");
     // set projection matrix and render in-game HUD
     tr.projection = player.getOrthoProjectionMatrix();
     int playerHealth = static_cast<int>(player.getHealth());
@@ -88,6 +167,32 @@ void inGameScreen(TextRenderer &tr, Player &player)
 
     const glm::vec3 black(0.0f, 0.0f, 0.0f);
     const glm::vec3 white(1.0f, 1.0f, 1.0f);
+    float leftMargin = 20.0f * xScale;
+
+    // the HUD only changes when health, ammo or kills change, so its text is laid out once and kept until then
+    static RetainedText staticText; // HEALTH label and cross hairs (never change)
+    static RetainedText healthText;
+    static RetainedText ammoText;
+    static RetainedText killsText;
+
+    if (staticText.update(0))
+    {
+        tr.LayoutTextBordered(staticText.vertices, "HEALTH", leftMargin, 565.0f * yScale, 0.48f * textScale, black, white);
+
+        // cross hairs
+        float textSize = 0.3f * textScale;
+        float centerX = static_cast<float>(player.SCR_WIDTH) * 0.5f;
+        float centerY = static_cast<float>(player.SCR_HEIGHT) * 0.5f;
+        float horizontalGap = 42.0f * textScale;
+        float verticalGap = 38.0f * textScale;
+        float dashWidth = tr.MeasureText("-", textSize);
+        float barWidth = tr.MeasureText("|", textSize);
+
+        tr.LayoutTextBordered(staticText.vertices, "-", centerX - horizontalGap - dashWidth * 0.5f, centerY, textSize, white, black);
+        tr.LayoutTextBordered(staticText.vertices, "-", centerX + horizontalGap - dashWidth * 0.5f, centerY, textSize, white, black);
+        tr.LayoutTextBordered(staticText.vertices, "|", centerX - barWidth * 0.5f, centerY + verticalGap, textSize, white, black);
+        tr.LayoutTextBordered(staticText.vertices, "|", centerX - barWidth * 0.5f, centerY - verticalGap, textSize, white, black);
+    }
 
     int visibleHealth = playerHealth;
     if (visibleHealth < 0)
@@ -99,71 +204,69 @@ void inGameScreen(TextRenderer &tr, Player &player)
         visibleHealth = 100;
     }
 
-    int filledBars = visibleHealth / 10;
-    std::string healthBar = "[" + std::string(filledBars, '#') + std::string(10 - filledBars, '-') + "]  " + std::to_string(visibleHealth);
-
-    glm::vec3 healthColor(0.13f, 0.59f, 0.00f);
-    if (visibleHealth < 30)
+    if (healthText.update(visibleHealth))
     {
-        healthColor = glm::vec3(0.86f, 0.0f, 0.12f);
-    }
-    else if (visibleHealth <= 60)
-    {
-        healthColor = glm::vec3(1.0f, 0.46f, 0.0f);
-    }
+        int filledBars = visibleHealth / 10;
+        std::string healthBar = "[" + std::string(filledBars, '#') + std::string(10 - filledBars, '-') + "]  " + std::to_string(visibleHealth);
 
-    float leftMargin = 20.0f * xScale;
-    tr.RenderTextBordered("HEALTH", leftMargin, 565.0f * yScale, 0.48f * textScale, black, white);
-    tr.RenderTextBordered(healthBar, leftMargin, 525.0f * yScale, 0.45f * textScale, healthColor, white);
+        glm::vec3 healthColor(0.13f, 0.59f, 0.00f);
+        if (visibleHealth < 30)
+        {
+            healthColor = glm::vec3(0.86f, 0.0f, 0.12f);
+        }
+        else if (visibleHealth <= 60)
+        {
+            healthColor = glm::vec3(1.0f, 0.46f, 0.0f);
+        }
+        tr.LayoutTextBordered(healthText.vertices, healthBar, leftMargin, 525.0f * yScale, 0.45f * textScale, healthColor, white);
+    }
 
     int shotsRemaining = player.getShotsRemaining();
-    int maxShots = player.getMaxShotsBeforeReload();
-    std::string ammoBar = "AMMO  [  ";
-    for (int i = 0; i < maxShots; i++)
+    if (ammoText.update(shotsRemaining))
     {
-        ammoBar += i < shotsRemaining ? "|" : "-";
-        if (i < maxShots - 1)
+        int maxShots = player.getMaxShotsBeforeReload();
+        std::string ammoBar = "AMMO  [  ";
+        for (int i = 0; i < maxShots; i++)
         {
-            ammoBar += " ";
+            ammoBar += i < shotsRemaining ? "|" : "-";
+            if (i < maxShots - 1)
+            {
+                ammoBar += " ";
+            }
         }
+        ammoBar += "  ]  " + std::to_string(shotsRemaining);
+        tr.LayoutTextBordered(ammoText.vertices, ammoBar, leftMargin, 485.0f * yScale, 0.45f * textScale, black, white);
     }
-    ammoBar += "  ]  " + std::to_string(shotsRemaining);
-    tr.RenderTextBordered(ammoBar, leftMargin, 485.0f * yScale, 0.45f * textScale, black, white);
-
-    std::string killsLabel = "KILLS";
-    std::string killCount = std::to_string(player.getKills());
-    float killsLabelScale = 0.48f * textScale;
-    float killCountScale = 0.68f * textScale;
-    float rightMargin = 24.0f * xScale;
-    float blockRight = static_cast<float>(player.SCR_WIDTH) - rightMargin;
-    float killsBlockWidth = std::max(tr.MeasureText(killsLabel, killsLabelScale), tr.MeasureText(killCount, killCountScale));
-    float killsCenter = blockRight - killsBlockWidth * 0.5f;
-
-    tr.RenderTextBordered(killsLabel, killsCenter - tr.MeasureText(killsLabel, killsLabelScale) * 0.5f,
-                          565.0f * yScale, killsLabelScale, black, white);
-    tr.RenderTextBordered(killCount, killsCenter - tr.MeasureText(killCount, killCountScale) * 0.5f,
-                          522.0f * yScale, killCountScale, black, white);
-
-    // cross hairs
-    float textSize = 0.3f * textScale;
-    float centerX = static_cast<float>(player.SCR_WIDTH) * 0.5f;
-    float centerY = static_cast<float>(player.SCR_HEIGHT) * 0.5f;
-    float horizontalGap = 42.0f * textScale;
-    float verticalGap = 38.0f * textScale;
-    float dashWidth = tr.MeasureText("-", textSize);
-    float barWidth = tr.MeasureText("|", textSize);
-
-    tr.RenderTextBordered("-", centerX - horizontalGap - dashWidth * 0.5f, centerY, textSize, white, black);
-    tr.RenderTextBordered("-", centerX + horizontalGap - dashWidth * 0.5f, centerY, textSize, white, black);
-    tr.RenderTextBordered("|", centerX - barWidth * 0.5f, centerY + verticalGap, textSize, white, black);
-    tr.RenderTextBordered("|", centerX - barWidth * 0.5f, centerY - verticalGap, textSize, white, black);
-    
+
+    // the KILLS label is centered above the count, so it moves when the count gets wider
+    if (killsText.update(player.getKills()))
+    {
+        std::string killsLabel = "KILLS";
+        std::string killCount = std::to_string(player.getKills());
+        float killsLabelScale = 0.48f * textScale;
+        float killCountScale = 0.68f * textScale;
+        float rightMargin = 24.0f * xScale;
+        float blockRight = static_cast<float>(player.SCR_WIDTH) - rightMargin;
+        float killsBlockWidth = std::max(tr.MeasureText(killsLabel, killsLabelScale), tr.MeasureText(killCount, killCountScale));
+        float killsCenter = blockRight - killsBlockWidth * 0.5f;
+
+        tr.LayoutTextBordered(killsText.vertices, killsLabel, killsCenter - tr.MeasureText(killsLabel, killsLabelScale) * 0.5f,
+                              565.0f * yScale, killsLabelScale, black, white);
+        tr.LayoutTextBordered(killsText.vertices, killCount, killsCenter - tr.MeasureText(killCount, killCountScale) * 0.5f,
+                              522.0f * yScale, killCountScale, black, white);
+    }
+
+    tr.RenderVertices(staticText.vertices);
+    tr.RenderVertices(healthText.vertices);
+    tr.RenderVertices(ammoText.vertices);
+    tr.RenderVertices(killsText.vertices);
 }
 
 void endingScreen(TextRenderer &tr, Player &player)
 {
+    PROFILE_ZONE("endingScreen");
     // update blink time
-    tr.blink += tr.deltaTime + 0.02;
+    tr.blink += tr.deltaTime * BLINK_SPEED;
 
     // render background image (lazy-initialized on first call)
     static ScreenRenderer renderer("shaders/screen.vert", "shaders/screen.frag");
@@ -203,3 +306,37 @@ void endingScreen(TextRenderer &tr, Player &player)
     renderCenteredBordered("[ENTER]    -    RESTART", 158.0f, 0.50f * textScale, white, red);
     renderCenteredBordered("[ESC]    -    QUIT", 118.0f, 0.50f * textScale, white, red);
 }
+
+void drawGpuTimings(TextRenderer &tr, const GpuTimer &timer, const RenderQueueStats &worldStats, const GLStateStats &stateStats)
+{
+    // bottom left corner, one line per pass and the total on top
+    tr.projection = glm::ortho(0.0f, static_cast<float>(Player::SCR_WIDTH), 0.0f, static_cast<float>(Player::SCR_HEIGHT));
+    float textScale = std::min(static_cast<float>(Player::SCR_WIDTH) / 800.0f, static_cast<float>(Player::SCR_HEIGHT) / 600.0f);
+    float scale = 0.3f * textScale;
+    float lineHeight = 16.0f * textScale;
+    float x = 10.0f * textScale;
+    float y = 10.0f * textScale;
+    const glm::vec3 color(1.0f, 0.85f, 0.2f);
+
+    char line[64];
+    ResourceRegistryStats resources = ResourceRegistry::getStats();
+    std::snprintf(line, sizeof(line), "shared %u models %u textures %u shaders", resources.models, resources.textures, resources.shaders);
+    tr.RenderText(line, x, y, scale, color);
+    y += lineHeight;
+    std::snprintf(line, sizeof(line), "GL state %u issued %u elided", stateStats.issued, stateStats.elided);
+    tr.RenderText(line, x, y, scale, color);
+    y += lineHeight;
+    unsigned int binds = worldStats.programBinds + worldStats.textureBinds + worldStats.vertexArrayBinds;
+    std::snprintf(line, sizeof(line), "world %u draws %u binds %u skipped", worldStats.draws, binds, worldStats.redundantBinds);
+    tr.RenderText(line, x, y, scale, color);
+    y += lineHeight;
+    for (int pass = static_cast<int>(GpuPass::COUNT) - 1; pass >= 0; pass--)
+    {
+        GpuPass gpuPass = static_cast<GpuPass>(pass);
+        std::snprintf(line, sizeof(line), "%-13s %6.2f ms", GpuTimer::passName(gpuPass), timer.getMilliseconds(gpuPass));
+        tr.RenderText(line, x, y, scale, color);
+        y += lineHeight;
+    }
+    std::snprintf(line, sizeof(line), "GPU total     %6.2f ms", timer.getTotalMilliseconds());
+    tr.RenderText(line, x, y, scale, color);
+}
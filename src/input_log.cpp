@@ -0,0 +1,218 @@
+#include "input_log.h"
+
+#include <cstring>
+#include <iostream>
+
+static const char MAGIC[4] = {'D', 'S', 'I', 'L'};
+static const uint8_t VERSION = 1;
+
+// key bits of a tick
+static const uint8_t KEY_FORWARD = 1 << 0;
+static const uint8_t KEY_BACKWARD = 1 << 1;
+static const uint8_t KEY_LEFT = 1 << 2;
+static const uint8_t KEY_RIGHT = 1 << 3;
+static const uint8_t KEY_SHOOT = 1 << 4;
+static const uint8_t MOUSE_X = 1 << 5;
+static const uint8_t MOUSE_Y = 1 << 6;
+
+// values are written byte by byte (little endian), so logs can be shared between machines
+static void writeUint(std::ofstream &file, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+    {
+        file.put(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+static void writeFloat(std::ofstream &file, float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeUint(file, bits, 4);
+}
+
+static bool readUint(std::ifstream &file, uint32_t &value, int bytes)
+{
+    value = 0;
+    for (int i = 0; i < bytes; i++)
+    {
+        int c = file.get();
+        if (c == EOF)
+        {
+            return false;
+        }
+        value |= static_cast<uint32_t>(c) << (8 * i);
+    }
+    return true;
+}
+
+static bool readFloat(std::ifstream &file, float &value)
+{
+    uint32_t bits;
+    if (!readUint(file, bits, 4))
+    {
+        return false;
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+InputRecorder::InputRecorder()
+{
+    ticks = 0;
+}
+
+InputRecorder::~InputRecorder()
+{
+    close();
+}
+
+bool InputRecorder::open(const std::string &path, const SessionInfo &info)
+{
+    close();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cout << "ERROR::INPUT_LOG::FAILED_TO_CREATE_FILE: " << path << std::endl;
+        return false;
+    }
+    ticks = 0;
+
+    std::string environment = info.environment.substr(0, 255);
+    file.write(MAGIC, sizeof(MAGIC));
+    writeUint(file, VERSION, 1);
+    writeUint(file, static_cast<uint32_t>(info.ticksPerSecond), 2);
+    writeUint(file, info.seed, 4);
+    writeUint(file, static_cast<uint32_t>(info.maxDrones), 4);
+    writeFloat(file, info.spawnInterval);
+    writeUint(file, static_cast<uint32_t>(environment.size()), 1);
+    file.write(environment.data(), environment.size());
+    return true;
+}
+
+void InputRecorder::record(const PlayerInput &input)
+{
+    if (!file.is_open())
+    {
+        return;
+    }
+
+    uint8_t keys = 0;
+    keys |= input.forward ? KEY_FORWARD : 0;
+    keys |= input.backward ? KEY_BACKWARD : 0;
+    keys |= input.left ? KEY_LEFT : 0;
+    keys |= input.right ? KEY_RIGHT : 0;
+    keys |= input.shoot ? KEY_SHOOT : 0;
+    keys |= input.mouseDX != 0.0f ? MOUSE_X : 0;
+    keys |= input.mouseDY != 0.0f ? MOUSE_Y : 0;
+    writeUint(file, keys, 1);
+    if (keys & MOUSE_X)
+    {
+        writeFloat(file, input.mouseDX);
+    }
+    if (keys & MOUSE_Y)
+    {
+        writeFloat(file, input.mouseDY);
+    }
+    ticks++;
+}
+
+void InputRecorder::close()
+{
+    if (file.is_open())
+    {
+        file.close();
+    }
+}
+
+bool InputRecorder::isOpen() const
+{
+    return file.is_open();
+}
+
+unsigned long long InputRecorder::getTicks() const
+{
+    return ticks;
+}
+
+InputReplay::InputReplay()
+{
+    ticks = 0;
+}
+
+bool InputReplay::open(const std::string &path)
+{
+    file.close();
+    file.clear();
+    file.open(path, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "ERROR::INPUT_LOG::FAILED_TO_OPEN_FILE: " << path << std::endl;
+        return false;
+    }
+    ticks = 0;
+
+    char magic[sizeof(MAGIC)];
+    uint32_t version, ticksPerSecond, seed, maxDrones, length;
+    float spawnInterval;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !readUint(file, version, 1) || version != VERSION)
+    {
+        std::cout << "ERROR::INPUT_LOG::NOT_AN_INPUT_LOG (or unsupported version): " << path << std::endl;
+        file.close();
+        return false;
+    }
+    if (!readUint(file, ticksPerSecond, 2) || !readUint(file, seed, 4) || !readUint(file, maxDrones, 4) ||
+        !readFloat(file, spawnInterval) || !readUint(file, length, 1))
+    {
+        std::cout << "ERROR::INPUT_LOG::TRUNCATED_HEADER: " << path << std::endl;
+        file.close();
+        return false;
+    }
+    std::string environment(length, '\0');
+    if (length > 0 && !file.read(&environment[0], length))
+    {
+        std::cout << "ERROR::INPUT_LOG::TRUNCATED_HEADER: " << path << std::endl;
+        file.close();
+        return false;
+    }
+
+    info.seed = seed;
+    info.environment = environment;
+    info.maxDrones = static_cast<int>(maxDrones);
+    info.spawnInterval = spawnInterval;
+    info.ticksPerSecond = static_cast<int>(ticksPerSecond);
+    return true;
+}
+
+const SessionInfo &InputReplay::getInfo() const
+{
+    return info;
+}
+
+bool InputReplay::next(PlayerInput &input)
+{
+    uint32_t keys;
+    if (!file.is_open() || !readUint(file, keys, 1))
+    {
+        return false;
+    }
+
+    input = PlayerInput();
+    input.forward = keys & KEY_FORWARD;
+    input.backward = keys & KEY_BACKWARD;
+    input.left = keys & KEY_LEFT;
+    input.right = keys & KEY_RIGHT;
+    input.shoot = keys & KEY_SHOOT;
+    if (((keys & MOUSE_X) && !readFloat(file, input.mouseDX)) || ((keys & MOUSE_Y) && !readFloat(file, input.mouseDY)))
+    {
+        return false; // log ends in the middle of a tick
+    }
+    ticks++;
+    return true;
+}
+
+unsigned long long InputReplay::getTicks() const
+{
+    return ticks;
+}
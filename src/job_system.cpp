@@ -0,0 +1,316 @@
+#include "job_system.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <iostream>
+
+const int JobSystem::DETERMINISTIC_GRAIN = 1024;
+const int JobSystem::MIN_GRAIN = 64;
+
+// queue of the current thread; threads that are not workers (like the main thread) share queue 0
+static thread_local int workerIndex = 0;
+
+int TaskGraph::add(std::function<void()> task)
+{
+    Node node;
+    node.task = std::move(task);
+    nodes.push_back(std::move(node));
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+void TaskGraph::precede(int before, int after)
+{
+    nodes[before].successors.push_back(after);
+    nodes[after].dependencies++;
+}
+
+void TaskGraph::clear()
+{
+    nodes.clear();
+}
+
+int TaskGraph::size() const
+{
+    return static_cast<int>(nodes.size());
+}
+
+JobSystem::JobSystem(int threads, bool deterministic)
+{
+    if (threads <= 0)
+    {
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    this->threads = threads;
+    this->deterministic = deterministic;
+    queues.reset(new WorkQueue[threads]);
+    queued = 0;
+    running = true;
+
+    for (int i = 1; i < threads; i++)
+    {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running = false;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void JobSystem::parallelFor(int begin, int end, int grain, const std::function<void(int, int)> &body)
+{
+    int count = end - begin;
+    if (count <= 0)
+    {
+        return;
+    }
+    int size = chunkSize(count, grain);
+    int chunks = (count + size - 1) / size;
+
+    // not worth handing out: run the chunks in order on this thread
+    if (chunks == 1 || threads == 1)
+    {
+        for (int b = begin; b < end; b += size)
+        {
+            body(b, std::min(b + size, end));
+        }
+        return;
+    }
+
+    // push all chunks but the first, which this thread runs right away
+    std::atomic<int> counter(chunks - 1);
+    for (int b = begin + size; b < end; b += size)
+    {
+        int e = std::min(b + size, end);
+        push({[&body, b, e]() { body(b, e); }, &counter});
+    }
+    notify();
+
+    body(begin, begin + size);
+    wait(counter);
+}
+
+void JobSystem::run(TaskGraph &graph)
+{
+    int n = graph.size();
+    if (n == 0)
+    {
+        return;
+    }
+
+    // a task in a cycle never runs and its successors would wait forever, so check that every task can be reached
+    // from the start tasks (Kahn's algorithm) before anything is launched
+    std::vector<int> unvisited(n);
+    std::vector<int> ready;
+    for (int i = 0; i < n; i++)
+    {
+        unvisited[i] = graph.nodes[i].dependencies;
+        if (unvisited[i] == 0)
+        {
+            ready.push_back(i);
+        }
+    }
+    int reachable = 0;
+    while (!ready.empty())
+    {
+        int node = ready.back();
+        ready.pop_back();
+        reachable++;
+        for (int successor : graph.nodes[node].successors)
+        {
+            if (--unvisited[successor] == 0)
+            {
+                ready.push_back(successor);
+            }
+        }
+    }
+    if (reachable < n)
+    {
+        std::cout << "ERROR::JOB_SYSTEM::TASK_GRAPH_HAS_A_CYCLE (" << n - reachable << " of " << n << " tasks can never start, nothing was run)" << std::endl;
+        return;
+    }
+
+    // number of unfinished dependencies per task
+    std::unique_ptr<std::atomic<int>[]> remaining(new std::atomic<int>[n]);
+    for (int i = 0; i < n; i++)
+    {
+        remaining[i] = graph.nodes[i].dependencies;
+    }
+
+    // a task pushes its successors before it counts as done, so counter only reaches zero at the very end
+    std::atomic<int> counter(n);
+    std::function<void(int)> launch = [&](int node)
+    {
+        push({[&, node]()
+              {
+                  graph.nodes[node].task();
+                  for (int successor : graph.nodes[node].successors)
+                  {
+                      if (remaining[successor].fetch_sub(1) == 1)
+                      {
+                          launch(successor);
+                      }
+                  }
+                  notify();
+              },
+              &counter});
+    };
+
+    for (int i = 0; i < n; i++)
+    {
+        if (graph.nodes[i].dependencies == 0)
+        {
+            launch(i);
+        }
+    }
+    notify();
+    wait(counter);
+}
+
+void JobSystem::async(std::function<void()> job)
+{
+    if (threads == 1)
+    {
+        job();
+        return;
+    }
+    push({std::move(job), nullptr});
+    notify();
+}
+
+int JobSystem::chunkSize(int count, int grain) const
+{
+    if (grain > 0)
+    {
+        return grain;
+    }
+    if (deterministic)
+    {
+        return DETERMINISTIC_GRAIN;
+    }
+    // about four chunks per thread leaves room for stealing when chunks take unequal time
+    return std::max(MIN_GRAIN, (count + threads * 4 - 1) / (threads * 4));
+}
+
+int JobSystem::getThreadCount() const
+{
+    return threads;
+}
+
+bool JobSystem::isDeterministic() const
+{
+    return deterministic;
+}
+
+void JobSystem::push(Job job)
+{
+    WorkQueue &queue = queues[workerIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+    queued++;
+}
+
+void JobSystem::notify()
+{
+    // taking the lock makes sure a worker that is about to sleep sees the new jobs
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_all();
+}
+
+bool JobSystem::runOne(int index)
+{
+    Job job;
+    bool found = false;
+
+    // own queue first (newest job, its data is most likely still in cache)
+    {
+        WorkQueue &queue = queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            found = true;
+        }
+    }
+
+    // steal the oldest job of another thread
+    for (int i = 1; i < threads && !found; i++)
+    {
+        WorkQueue &queue = queues[(index + i) % threads];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found)
+    {
+        return false;
+    }
+    queued--;
+    job.run();
+    if (job.counter != nullptr)
+    {
+        job.counter->fetch_sub(1, std::memory_order_release);
+    }
+    return true;
+}
+
+void JobSystem::wait(std::atomic<int> &counter)
+{
+    while (counter.load(std::memory_order_acquire) > 0)
+    {
+        if (!runOne(workerIndex))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::workerLoop(int index)
+{
+    workerIndex = index;
+    PROFILE_THREAD("worker " + std::to_string(index));
+    while (true)
+    {
+        if (runOne(index))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this]()
+                  { return !running || queued.load() > 0; });
+        if (!running && queued.load() == 0)
+        {
+            return;
+        }
+    }
+}
+
+void runParallel(JobSystem *jobs, int begin, int end, int grain, const std::function<void(int, int)> &body)
+{
+    if (jobs == nullptr)
+    {
+        if (begin < end)
+        {
+            body(begin, end);
+        }
+        return;
+    }
+    jobs->parallelFor(begin, end, grain, body);
+}
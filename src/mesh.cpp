@@ -1,17 +1,38 @@
 #include "mesh.h"
+#include "gl_state.h"
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+Mesh::Mesh(const Vertex *vertices, unsigned int vertexCount, const unsigned int *indices, unsigned int indexCount,
+           std::vector<Texture> textures, glm::vec3 boundsMin, glm::vec3 boundsMax)
 {
-    this->vertices = vertices;
-    this->indices = indices;
+    this->indexCount = indexCount;
     this->textures = textures;
+    this->boundsMin = boundsMin;
+    this->boundsMax = boundsMax;
 
     // now that we have all the required data, set the vertex buffers and its attribute pointers.
-    setupMesh();
+    setupMesh(vertices, vertexCount, indices);
 }
 
 /// render the mesh (here we give a shader to the Draw function; by passing the shader to the mesh we can set several uniforms before drawing (like linking samplers to texture units))
 void Mesh::Draw(Shader &shader)
+{
+    bindTextures(shader);
+
+    // draw mesh
+    GLState::bindVertexArray(VAO.get());
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+}
+
+void Mesh::DrawInstanced(Shader &shader, unsigned int instances)
+{
+    bindTextures(shader);
+
+    // draw all instances of the mesh
+    GLState::bindVertexArray(VAO.get());
+    glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, instances);
+}
+
+void Mesh::bindTextures(Shader &shader)
 {
     // bind appropriate textures
     unsigned int diffuseNr = 1;
@@ -20,7 +41,6 @@ void Mesh::Draw(Shader &shader)
     unsigned int heightNr = 1;
     for (unsigned int i = 0; i < textures.size(); i++)
     {
-        glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
         // retrieve texture number (the N in diffuse_textureN)
         std::string number;
         std::string name = textures[i].type;
@@ -34,34 +54,27 @@ void Mesh::Draw(Shader &shader)
             number = std::to_string(heightNr++); // transfer unsigned int to string
 
         // now set the sampler to the correct texture unit
-        glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), i);
-        // and finally bind the texture
-        glBindTexture(GL_TEXTURE_2D, textures[i].id);
+        shader.setInt(name + number, i);
+        // and finally bind the texture (skipped if it is still bound to that unit)
+        GLState::bindTexture(i, GL_TEXTURE_2D, textures[i].id);
     }
-
-    // draw mesh
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-
-    // always good practice to set everything back to defaults once configured.
-    glActiveTexture(GL_TEXTURE0);
 }
 
-void Mesh::setupMesh()
+void Mesh::setupMesh(const Vertex *vertices, unsigned int vertexCount, const unsigned int *indices)
 {
     // create buffers/arrays
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
+    VAO.create();
+    VBO.create();
+    EBO.create();
+    gpuBytes = vertexCount * sizeof(Vertex) + indexCount * sizeof(unsigned int);
 
-    glBindVertexArray(VAO);
+    GLState::bindVertexArray(VAO.get());
     // load data into vertex buffers
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
+    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertices, GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO.get());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indices, GL_STATIC_DRAW);
 
     // set the vertex attribute pointers
     // vertex Positions
@@ -86,5 +99,5 @@ void Mesh::setupMesh()
     // weights
     glEnableVertexAttribArray(6);
     glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, m_Weights));
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
\ No newline at end of file
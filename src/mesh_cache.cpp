@@ -0,0 +1,315 @@
+#include "mesh_cache.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char *MeshCache::EXTENSION = ".meshcache";
+const int MeshCache::VERSION = 1;
+
+// cache file header
+static const char CACHE_MAGIC[4] = {'D', 'M', 'S', 'H'};
+
+// the vertex and index blobs start at multiples of this (offsets from the start of the file)
+static const std::uint64_t BLOB_ALIGNMENT = 16;
+
+/*
+File layout: Header, MeshRecord per mesh, TextureRecord per texture, the names of the textures (one string table),
+then the vertices and indices of every mesh (aligned to BLOB_ALIGNMENT).
+*/
+struct Header
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t sourceHash;
+    std::uint32_t vertexSize; // sizeof(Vertex) of the program that wrote the file
+    std::uint32_t meshCount;
+    std::uint32_t textureCount;
+    std::uint32_t stringBytes;
+};
+
+struct MeshRecord
+{
+    std::uint64_t vertexOffset;
+    std::uint64_t indexOffset;
+    std::uint32_t vertexCount;
+    std::uint32_t indexCount;
+    std::uint32_t firstTexture;
+    std::uint32_t textureCount;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct TextureRecord
+{
+    std::uint32_t typeOffset; // offsets into the string table
+    std::uint32_t typeLength;
+    std::uint32_t pathOffset;
+    std::uint32_t pathLength;
+};
+
+// maps a whole file read-only, returns nullptr if it can not be opened or is empty
+static void *mapFile(const std::string &path, size_t &size)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+    struct stat info;
+    void *data = nullptr;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        size = static_cast<size_t>(info.st_size);
+        data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            data = nullptr;
+        }
+    }
+    ::close(fd); // the mapping stays valid
+    return data;
+}
+
+// FNV-1a over 8 byte words (the tail byte by byte), fast enough to hash the big models on every start
+static unsigned long long hashBytes(const unsigned char *bytes, size_t size, unsigned long long hash)
+{
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    for (; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// rounds an offset up to the blob alignment
+static std::uint64_t alignBlob(std::uint64_t offset)
+{
+    return (offset + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+}
+
+MeshCache::MeshCache() : data(nullptr), size(0) {}
+
+MeshCache::~MeshCache()
+{
+    close();
+}
+
+bool MeshCache::open(const std::string &path, unsigned long long sourceHash)
+{
+    close();
+    if (sourceHash == 0)
+    {
+        return false;
+    }
+    data = mapFile(path, size);
+    if (data == nullptr)
+    {
+        return false;
+    }
+    madvise(data, size, MADV_WILLNEED); // all of it is uploaded right away
+
+    // header
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    Header header;
+    if (size < sizeof(Header))
+    {
+        close();
+        return false;
+    }
+    std::memcpy(&header, bytes, sizeof(Header));
+    std::uint64_t recordsEnd = sizeof(Header) + static_cast<std::uint64_t>(header.meshCount) * sizeof(MeshRecord) +
+                               static_cast<std::uint64_t>(header.textureCount) * sizeof(TextureRecord);
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != static_cast<std::uint32_t>(VERSION) ||
+        header.sourceHash != sourceHash || header.vertexSize != sizeof(Vertex) || recordsEnd + header.stringBytes > size)
+    {
+        close();
+        return false;
+    }
+    const MeshRecord *meshRecords = reinterpret_cast<const MeshRecord *>(bytes + sizeof(Header));
+    const TextureRecord *textureRecords = reinterpret_cast<const TextureRecord *>(meshRecords + header.meshCount);
+    const char *strings = reinterpret_cast<const char *>(bytes + recordsEnd);
+
+    // meshes, every range is checked so a truncated or damaged file is never read past its end
+    meshes.reserve(header.meshCount);
+    for (std::uint32_t i = 0; i < header.meshCount; i++)
+    {
+        const MeshRecord &record = meshRecords[i];
+        std::uint64_t vertexBytes = static_cast<std::uint64_t>(record.vertexCount) * sizeof(Vertex);
+        std::uint64_t indexBytes = static_cast<std::uint64_t>(record.indexCount) * sizeof(unsigned int);
+        if (record.vertexOffset % BLOB_ALIGNMENT != 0 || record.indexOffset % BLOB_ALIGNMENT != 0 ||
+            record.vertexOffset > size || vertexBytes > size - record.vertexOffset ||
+            record.indexOffset > size || indexBytes > size - record.indexOffset ||
+            static_cast<std::uint64_t>(record.firstTexture) + record.textureCount > header.textureCount)
+        {
+            close();
+            return false;
+        }
+
+        CachedMesh mesh;
+        mesh.vertices = reinterpret_cast<const Vertex *>(bytes + record.vertexOffset);
+        mesh.vertexCount = record.vertexCount;
+        mesh.indices = reinterpret_cast<const unsigned int *>(bytes + record.indexOffset);
+        mesh.indexCount = record.indexCount;
+        mesh.boundsMin = glm::vec3(record.boundsMin[0], record.boundsMin[1], record.boundsMin[2]);
+        mesh.boundsMax = glm::vec3(record.boundsMax[0], record.boundsMax[1], record.boundsMax[2]);
+        for (std::uint32_t t = record.firstTexture; t < record.firstTexture + record.textureCount; t++)
+        {
+            const TextureRecord &texture = textureRecords[t];
+            if (static_cast<std::uint64_t>(texture.typeOffset) + texture.typeLength > header.stringBytes ||
+                static_cast<std::uint64_t>(texture.pathOffset) + texture.pathLength > header.stringBytes)
+            {
+                close();
+                return false;
+            }
+            mesh.textures.push_back({std::string(strings + texture.typeOffset, texture.typeLength),
+                                     std::string(strings + texture.pathOffset, texture.pathLength)});
+        }
+        meshes.push_back(std::move(mesh));
+    }
+    return true;
+}
+
+void MeshCache::close()
+{
+    if (data != nullptr)
+    {
+        munmap(data, size);
+    }
+    data = nullptr;
+    size = 0;
+    meshes.clear();
+}
+
+const std::vector<CachedMesh> &MeshCache::getMeshes() const
+{
+    return meshes;
+}
+
+bool MeshCache::write(const std::string &path, unsigned long long sourceHash, const std::vector<MeshData> &meshes)
+{
+    if (sourceHash == 0)
+    {
+        return false;
+    }
+
+    // records and string table
+    std::vector<MeshRecord> meshRecords;
+    std::vector<TextureRecord> textureRecords;
+    std::string strings;
+    for (const MeshData &mesh : meshes)
+    {
+        MeshRecord record = {};
+        record.vertexCount = static_cast<std::uint32_t>(mesh.vertices.size());
+        record.indexCount = static_cast<std::uint32_t>(mesh.indices.size());
+        record.firstTexture = static_cast<std::uint32_t>(textureRecords.size());
+        record.textureCount = static_cast<std::uint32_t>(mesh.textures.size());
+        for (int axis = 0; axis < 3; axis++)
+        {
+            record.boundsMin[axis] = mesh.boundsMin[axis];
+            record.boundsMax[axis] = mesh.boundsMax[axis];
+        }
+        for (const MeshTextureRef &texture : mesh.textures)
+        {
+            TextureRecord textureRecord;
+            textureRecord.typeOffset = static_cast<std::uint32_t>(strings.size());
+            textureRecord.typeLength = static_cast<std::uint32_t>(texture.type.size());
+            strings += texture.type;
+            textureRecord.pathOffset = static_cast<std::uint32_t>(strings.size());
+            textureRecord.pathLength = static_cast<std::uint32_t>(texture.path.size());
+            strings += texture.path;
+            textureRecords.push_back(textureRecord);
+        }
+        meshRecords.push_back(record);
+    }
+
+    // blob offsets
+    std::uint64_t offset = sizeof(Header) + meshRecords.size() * sizeof(MeshRecord) + textureRecords.size() * sizeof(TextureRecord) + strings.size();
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        meshRecords[i].vertexOffset = offset = alignBlob(offset);
+        offset += meshes[i].vertices.size() * sizeof(Vertex);
+        meshRecords[i].indexOffset = offset = alignBlob(offset);
+        offset += meshes[i].indices.size() * sizeof(unsigned int);
+    }
+
+    Header header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = static_cast<std::uint32_t>(VERSION);
+    header.sourceHash = sourceHash;
+    header.vertexSize = sizeof(Vertex);
+    header.meshCount = static_cast<std::uint32_t>(meshRecords.size());
+    header.textureCount = static_cast<std::uint32_t>(textureRecords.size());
+    header.stringBytes = static_cast<std::uint32_t>(strings.size());
+
+    // written to a temporary file first, so a cache that is being written is never opened; the name is unique per
+    // process and call, so the loader thread and a synchronous load writing the same cache do not share one file
+    static std::atomic<unsigned int> temporaryCounter(0);
+    std::string temporaryPath = path + "." + std::to_string(getpid()) + "." + std::to_string(temporaryCounter++) + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "ERROR::MESH_CACHE: Could not write mesh cache " << path << std::endl;
+        return false;
+    }
+    const char padding[BLOB_ALIGNMENT] = {};
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(meshRecords.data()), meshRecords.size() * sizeof(MeshRecord));
+    file.write(reinterpret_cast<const char *>(textureRecords.data()), textureRecords.size() * sizeof(TextureRecord));
+    file.write(strings.data(), strings.size());
+    std::uint64_t written = sizeof(Header) + meshRecords.size() * sizeof(MeshRecord) + textureRecords.size() * sizeof(TextureRecord) + strings.size();
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        file.write(padding, meshRecords[i].vertexOffset - written);
+        file.write(reinterpret_cast<const char *>(meshes[i].vertices.data()), meshes[i].vertices.size() * sizeof(Vertex));
+        written = meshRecords[i].vertexOffset + meshes[i].vertices.size() * sizeof(Vertex);
+        file.write(padding, meshRecords[i].indexOffset - written);
+        file.write(reinterpret_cast<const char *>(meshes[i].indices.data()), meshes[i].indices.size() * sizeof(unsigned int));
+        written = meshRecords[i].indexOffset + meshes[i].indices.size() * sizeof(unsigned int);
+    }
+    file.close();
+    if (!file || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::cout << "ERROR::MESH_CACHE: Could not write mesh cache " << path << std::endl;
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+unsigned long long MeshCache::hashSource(const std::string &path)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    size_t size = 0;
+    void *model = mapFile(path, size);
+    if (model == nullptr)
+    {
+        return 0;
+    }
+    hash = hashBytes(static_cast<const unsigned char *>(model), size, hash);
+    munmap(model, size);
+
+    // the material library decides which textures the meshes use
+    std::string materialPath = path.substr(0, path.find_last_of('.')) + ".mtl";
+    void *materials = mapFile(materialPath, size);
+    if (materials != nullptr)
+    {
+        hash = hashBytes(static_cast<const unsigned char *>(materials), size, hash);
+        munmap(materials, size);
+    }
+    return hash;
+}
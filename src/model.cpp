@@ -1,4 +1,7 @@
 #include "model.h"
+#include "resource_registry.h"
+
+#include <cstring>
 
 Model::Model(){};
 
@@ -14,6 +17,12 @@ void Model::Draw(Shader &shader)
         meshes[i].Draw(shader);
 }
 
+void Model::DrawInstanced(Shader &shader, unsigned int instances)
+{
+    for (unsigned int i = 0; i < meshes.size(); i++)
+        meshes[i].DrawInstanced(shader, instances);
+}
+
 void Model::drawSpecificMesh(Shader &shader, int index)
 {
     meshes[index].Draw(shader);
@@ -21,6 +30,53 @@ void Model::drawSpecificMesh(Shader &shader, int index)
 
 void Model::loadModel(std::string const &path)
 {
+    ModelFile file;
+    if (!file.read(path))
+    {
+        return;
+    }
+    directory = file.directory;
+    meshes.reserve(file.meshes.size());
+    for (const CachedMesh &mesh : file.meshes)
+    {
+        addMesh(mesh);
+    }
+}
+
+void Model::addMesh(const CachedMesh &mesh)
+{
+    meshes.push_back(Mesh(mesh.vertices, mesh.vertexCount, mesh.indices, mesh.indexCount,
+                          loadTextures(mesh.textures), mesh.boundsMin, mesh.boundsMax));
+}
+
+std::size_t Model::getGpuBytes() const
+{
+    std::size_t bytes = 0;
+    for (const Mesh &mesh : meshes)
+    {
+        bytes += mesh.gpuBytes;
+    }
+    for (const Texture &texture : textures_loaded)
+    {
+        bytes += texture.object ? texture.object->bytes : 0;
+    }
+    return bytes;
+}
+
+bool ModelFile::read(std::string const &path)
+{
+    // retrieve the directory path of the filepath
+    directory = path.substr(0, path.find_last_of('/'));
+
+    // meshes straight from the mapped cache if it was made from this model (uploaded without copying them)
+    std::string cachePath = path + MeshCache::EXTENSION;
+    unsigned long long sourceHash = MeshCache::hashSource(path);
+    if (cache.open(cachePath, sourceHash))
+    {
+        meshes = cache.getMeshes();
+        return true;
+    }
+
     // read file via ASSIMP
     Assimp::Importer importer; // declare importer object
     const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
@@ -28,22 +84,28 @@ void Model::loadModel(std::string const &path)
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
     {
         std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
-        return;
+        return false;
     }
-    // retrieve the directory path of the filepath
-    directory = path.substr(0, path.find_last_of('/'));
 
-    // process ASSIMP's root node recursively if no errors occured
+    // process ASSIMP's root node recursively if no errors occured, cache the result for the next load
     processNode(scene->mRootNode, scene);
+    MeshCache::write(cachePath, sourceHash, imported);
+
+    for (const MeshData &mesh : imported)
+    {
+        meshes.push_back({mesh.vertices.data(), static_cast<unsigned int>(mesh.vertices.size()), mesh.indices.data(),
+                          static_cast<unsigned int>(mesh.indices.size()), mesh.textures, mesh.boundsMin, mesh.boundsMax});
+    }
+    return true;
 }
 
-void Model::processNode(aiNode *node, const aiScene *scene)
+void ModelFile::processNode(aiNode *node, const aiScene *scene)
 {
     // process each mesh located at the current node
     for (unsigned int i = 0; i < node->mNumMeshes; i++)
     {
         aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-        meshes.push_back(processMesh(mesh, scene));
+        imported.push_back(processMesh(mesh, scene));
     }
     // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
     for (unsigned int i = 0; i < node->mNumChildren; i++)
@@ -52,23 +114,29 @@ void Model::processNode(aiNode *node, const aiScene *scene)
     }
 }
 
-Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
+MeshData ModelFile::processMesh(aiMesh *mesh, const aiScene *scene)
 {
     // data to fill
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<Texture> textures;
+    MeshData data;
+    data.vertices.reserve(mesh->mNumVertices);
+    data.indices.reserve(mesh->mNumFaces * 3);
+    data.boundsMin = glm::vec3(0.0f);
+    data.boundsMax = glm::vec3(0.0f);
 
     // walk through each of the mesh's vertices
     for (unsigned int i = 0; i < mesh->mNumVertices; i++)
     {
         Vertex vertex;
+        std::memset(&vertex, 0, sizeof(vertex)); // unused attributes are written to the mesh cache too
         glm::vec3 vector; // we declare a placeholder vector since assimp uses its own vector class that doesn't directly convert to glm's vec3 class so we transfer the data to this placeholder glm::vec3 first.
         // positions
         vector.x = mesh->mVertices[i].x; // Assimp calls their vertex position array mVertices
         vector.y = mesh->mVertices[i].y;
         vector.z = mesh->mVertices[i].z;
         vertex.Position = vector;
+        // bounds
+        data.boundsMin = i == 0 ? vector : glm::min(data.boundsMin, vector);
+        data.boundsMax = i == 0 ? vector : glm::max(data.boundsMax, vector);
         // normals
         if (mesh->HasNormals())
         {
@@ -98,14 +166,14 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
         else
             vertex.TexCoords = glm::vec2(0.0f, 0.0f);
 
-        vertices.push_back(vertex);
+        data.vertices.push_back(vertex);
     }
 
     for (unsigned int i = 0; i < mesh->mNumFaces; i++)
     {
         aiFace face = mesh->mFaces[i];
         for (unsigned int j = 0; j < face.mNumIndices; j++)
-            indices.push_back(face.mIndices[j]);
+            data.indices.push_back(face.mIndices[j]);
     }
     // process materials
     aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex]; // retrieve the aiMaterial object from the scene's mMaterials array
@@ -117,34 +185,37 @@ Mesh Model::processMesh(aiMesh *mesh, const aiScene *scene)
     Where N is a sequential number ranging from 1 to MAX_SAMPLER_NUMBER. */
 
     // 1. diffuse maps
-    std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-    textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+    materialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", data.textures);
     // 2. specular maps
-    std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-    textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+    materialTextures(material, aiTextureType_SPECULAR, "texture_specular", data.textures);
     // 3. normal maps
-    std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-    textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+    materialTextures(material, aiTextureType_HEIGHT, "texture_normal", data.textures);
     // 4. height maps
-    std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-    textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
+    materialTextures(material, aiTextureType_AMBIENT, "texture_height", data.textures);
 
-    // return a mesh object created from the extracted mesh data
-    return Mesh(vertices, indices, textures);
+    return data;
 }
 
-std::vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType type, std::string typeName)
+void ModelFile::materialTextures(aiMaterial *mat, aiTextureType type, std::string typeName, std::vector<MeshTextureRef> &textures)
 {
-    std::vector<Texture> textures;
     for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
     {
         aiString str;                   // stores texture path
         mat->GetTexture(type, i, &str); // retrieve the texture's file location
+        textures.push_back({typeName, str.C_Str()});
+    }
+}
+
+std::vector<Texture> Model::loadTextures(const std::vector<MeshTextureRef> &refs)
+{
+    std::vector<Texture> textures;
+    for (const MeshTextureRef &ref : refs)
+    {
         // check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
         bool skip = false;
         for (unsigned int j = 0; j < textures_loaded.size(); j++)
         {
-            if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
+            if (textures_loaded[j].path == ref.path)
             {
                 textures.push_back(textures_loaded[j]);
                 skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
@@ -155,10 +226,10 @@ std::vector<Texture> Model::loadMaterialTextures(aiMaterial *mat, aiTextureType
         { // if texture hasn't been loaded already, load it
             Texture texture;
             // note that we make the assumption that texture file paths in model files are local to the actual model object e.g. in the same directory as the location of the model itself.
-            if (flipVertically) {texture.id = TextureFromFile(str.C_Str(), this->directory, true);}
-            else {texture.id = TextureFromFile(str.C_Str(), this->directory, false);}
-            texture.type = typeName;
-            texture.path = str.C_Str();
+            texture.object = ResourceRegistry::getTexture(ref.path, this->directory, flipVertically);
+            texture.id = texture.object->id;
+            texture.type = ref.type;
+            texture.path = ref.path;
             textures.push_back(texture);
             textures_loaded.push_back(texture); // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
         }
@@ -1,71 +1,18 @@
 #include "player.h"
+#include "gl_state.h"
 
 // screen dimensions
 const int Player::SCR_HEIGHT = 600;
 const int Player::SCR_WIDTH = 800;
 
-// default player values
-const float Player::YAW = -90.0f;
-const float Player::PITCH = 0.0f;
-const float Player::SPEED = 5.0f;
-const float Player::SENSITIVITY = 0.1f;
+// default camera values
 const float Player::ZOOM = 45.0f;
 
-static constexpr int MAX_SHOTS_BEFORE_RELOAD = 5;
-static constexpr float RELOAD_DURATION = 1.5f;
+static constexpr float RECOIL_ANGLE = 60.0f;
 static constexpr float RELOAD_HIDDEN_Y = -1.35f;
 static constexpr float RELOAD_NOSE_DOWN_ANGLE = -55.0f;
 
-// player movement limitations
-const float Player::BOTTOM_LIMIT_X = -Terrain::SIZE / 2;
-const float Player::UPPER_LIMIT_X = Terrain::SIZE / 2;
-const float Player::BOTTOM_LIMIT_Z = -Terrain::SIZE / 2;
-const float Player::UPPER_LIMIT_Z = Terrain::SIZE / 2;
-
-Player::Player(glm::vec3 position, glm::vec3 up, float yaw, float pitch) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY)
-{
-    // default mouse related values
-    lastX = SCR_WIDTH / 2.0f;
-    lastY = SCR_HEIGHT / 2.0f;
-    firstMouse = true;
-
-    // set player values
-    angle = 0;
-    soundCount = 0;
-    shot = false;
-    startRecoil = false;
-    goDown = false;
-    shotsRemaining = MAX_SHOTS_BEFORE_RELOAD;
-    isReloading = false;
-    reloadStartTime = 0.0f;
-    reloadBaseModelMatrix = glm::mat4(1.0f);
-    kills = 0;
-    isAlive = true;
-    health = 100;
-    Position = position;
-    origPosition = position;
-    WorldUp = up;
-    Yaw = yaw;
-    Pitch = pitch;
-    range = Terrain::SIZE * 2;
-    updatePlayerVectors();
-
-    // set base position of gun
-    gunPosition = glm::vec3(0.45f, -0.5f, -1.5f); // bottom right corner of screen
-
-    // set matrices
-    setProjectionMatrix(); // this matrix does not change while running the program
-    setGunModelMatrix();
-
-    // load model and compile shaders
-    gun = Model("resources/models/handgun/Handgun_obj.obj", false);
-    shader = Shader("shaders/model.vert", "shaders/model.frag");
-
-    // audio setup
-    audioSetup();
-}
-
-Player::Player(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED), MouseSensitivity(SENSITIVITY)
+Player::Player()
 {
     // default mouse related values
     lastX = SCR_WIDTH / 2.0f;
@@ -73,24 +20,8 @@ Player::Player(float posX, float posY, float posZ, float upX, float upY, float u
     firstMouse = true;
 
     // set player values
-    angle = 0;
-    soundCount = 0;
-    shot = false;
-    startRecoil = false;
-    goDown = false;
-    shotsRemaining = MAX_SHOTS_BEFORE_RELOAD;
-    isReloading = false;
-    reloadStartTime = 0.0f;
-    reloadBaseModelMatrix = glm::mat4(1.0f);
-    kills = 0;
-    isAlive = true;
-    health = 100;
-    Position = glm::vec3(posX, posY, posZ);
-    origPosition = glm::vec3(posX, posY, posZ);
-    WorldUp = glm::vec3(upX, upY, upZ);
-    Yaw = yaw;
-    Pitch = pitch;
-    range = Terrain::SIZE * 2;
+    currentFrame = 0.0f;
+    showGunFire = false;
     updatePlayerVectors();
 
     // set base position of gun
@@ -101,8 +32,8 @@ Player::Player(float posX, float posY, float posZ, float upX, float upY, float u
     setGunModelMatrix();
 
     // load model and compile shaders
-    gun = Model("resources/models/handgun/Handgun_obj.obj", false);
-    shader = Shader("shaders/model.vert", "shaders/model.frag");
+    gun = ResourceRegistry::getModel("resources/models/handgun/Handgun_obj.obj", false);
+    shader = ResourceRegistry::getShader("shaders/model.vert", "shaders/model.frag");
 
     // audio setup
     audioSetup();
@@ -119,100 +50,19 @@ glm::mat4 Player::GetViewMatrix() const
     return glm::lookAt(Position, Position + Front, Up);
 }
 
-void Player::ProcessKeyboard(Player_Movement direction, float deltaTime)
+void Player::processKeyboardMouse(GLFWwindow *window, PlayerInput &input)
 {
-    float velocity = MovementSpeed * deltaTime;
-    if (direction == FORWARD)
-    {
-        Position += Front * velocity;
-    }
-    if (direction == BACKWARD)
-    {
-        Position -= Front * velocity;
-    }
-    if (direction == LEFT)
-    {
-        Position -= Right * velocity;
-    }
-    if (direction == RIGHT)
-    {
-        Position += Right * velocity;
-    }
-
-    // make sure player stays at ground level
-    Position.y = 0;
+    input.forward = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS;
+    input.backward = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS;
+    input.left = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS;
+    input.right = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS;
+    input.shoot = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
 
-    // also make sure player stays between the accepted x and z limits
-    if (Position.x < BOTTOM_LIMIT_X)
-    {
-        Position.x = BOTTOM_LIMIT_X;
-    }
-    if (Position.x > UPPER_LIMIT_X - 1.0f)
-    {
-        Position.x = UPPER_LIMIT_X - 1.0f;
-    }
-    if (Position.z < BOTTOM_LIMIT_Z)
-    {
-        Position.z = BOTTOM_LIMIT_Z;
-    }
-    if (Position.z > UPPER_LIMIT_Z - 1.0f)
-    {
-        Position.z = UPPER_LIMIT_Z - 1.0f;
-    }
-}
-
-void Player::processInput(GLFWwindow *window, float deltaTime)
-{
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
-    {
-        isWalking = true;
-        ProcessKeyboard(FORWARD, deltaTime);
-    }
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
-    {
-        isWalking = true;
-        ProcessKeyboard(BACKWARD, deltaTime);
-    }
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
-    {
-        isWalking = true;
-        ProcessKeyboard(LEFT, deltaTime);
-    }
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
-    {
-        isWalking = true;
-        ProcessKeyboard(RIGHT, deltaTime);
-    }
-
-    // player shoots gun
-    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && !shot && !isReloading && shotsRemaining > 0)
-    {
-        shotsRemaining--;
-        soundCount++;
-        ma_engine_set_volume(&engine, 2.0);
-        ma_engine_play_sound(&engine, gunshotSoundPath.c_str(), NULL);
-        shot = true;
-    }
-
-    // walking motion and audio
-    if (isWalking)
-    {
-        ma_sound_set_volume(&walkingSound, 0.6);
-        ma_sound_start(&walkingSound);
-        if (!isReloading)
-        {
-            walkingMotion();
-        }
-    }
-    else
-    {
-        ma_sound_stop(&walkingSound);
-    }
-
-    isWalking = false;
+    glfwGetCursorPos(window, &xPosIn, &yPosIn);
+    ProcessMouseMovement(input);
 }
 
-void Player::ProcessMouseMovement(GLboolean constrainPitch)
+void Player::ProcessMouseMovement(PlayerInput &input)
 {
     float xpos = static_cast<float>(xPosIn);
     float ypos = static_cast<float>(yPosIn);
@@ -229,79 +79,51 @@ void Player::ProcessMouseMovement(GLboolean constrainPitch)
     lastX = xpos;
     lastY = ypos;
 
-    xoffset *= MouseSensitivity;
-    yoffset *= MouseSensitivity;
-
-    Yaw += xoffset;
-    Pitch += yoffset;
-
-    // make sure that when pitch is out of bounds, screen doesn't get flipped
-    if (constrainPitch)
-    {
-        if (Pitch > 89.0f)
-        {
-            Pitch = 89.0f;
-        }
-        if (Pitch < -44.0f)
-        {
-            Pitch = -44.0f;
-        }
-    }
-
-    // update Front, Right and Up vectors using the updated Euler angles
-    updatePlayerVectors();
+    // the simulation applies the sensitivity and pitch constraints
+    input.mouseDX += xoffset;
+    input.mouseDY += yoffset;
 }
 
 void Player::passiveMotion()
 {
-    if (!isWalking)
-    {
-        Position.y = sin(currentFrame * 2) * 0.02f;
-    }
+    Position.y = state.position.y + sin(currentFrame * 2) * 0.02f;
 }
 
 void Player::walkingMotion()
 {
-    float newPosZ = gunPosition.z + sin(currentFrame * 15) * 0.004f;
-    if (newPosZ > -1.52 && newPosZ < -1.48)
-    {
-        gunPosition.z = newPosZ;
-    }
-    float newPosY = gunPosition.y + sin(currentFrame * 15) * 0.004f;
-    if (newPosY > -0.52 && newPosY < -0.48)
-    {
-        gunPosition.y = newPosY;
-    }
-    gunModelMatrix[3] = glm::vec4(gunPosition, 1.0);
+    // offset from the base position depends on the time only (not on the number of frames)
+    float offset = -cos(currentFrame * 15) * 0.016f;
+    gunPosition.z = -1.5f + offset;
+    gunPosition.y = -0.5f + offset;
 }
 
 void Player::drawGun()
 {
     // depth test
-    glEnable(GL_DEPTH_TEST);
+    GLState::setEnabled(GL_DEPTH_TEST, true);
     
     // set uniforms and draw gun
-    shader.use();
-    shader.setMat4("view", viewLocalMat);
-    shader.setMat4("projection", projection);
-    shader.setMat4("model", gunModelMatrix);
-    gun.drawSpecificMesh(shader, 1);
-    gun.drawSpecificMesh(shader, 3);
-    gun.drawSpecificMesh(shader, 4);
-    gun.drawSpecificMesh(shader, 6);
+    shader->use();
+    shader->setMat4("view", viewLocalMat);
+    shader->setMat4("projection", projection);
+    shader->setMat4("model", gunModelMatrix);
+    gun->drawSpecificMesh(*shader, 1);
+    gun->drawSpecificMesh(*shader, 3);
+    gun->drawSpecificMesh(*shader, 4);
+    gun->drawSpecificMesh(*shader, 6);
 }
 
 void Player::drawGunFire()
 {
     // depth test
-    glEnable(GL_DEPTH_TEST);
+    GLState::setEnabled(GL_DEPTH_TEST, true);
 
     // set uniforms and draw gun fire
-    shader.use();
-    shader.setMat4("view", viewLocalMat);
-    shader.setMat4("projection", projection);
-    shader.setMat4("model", gunModelMatrix);
-    gun.drawSpecificMesh(shader, 5);
+    shader->use();
+    shader->setMat4("view", viewLocalMat);
+    shader->setMat4("projection", projection);
+    shader->setMat4("model", gunModelMatrix);
+    gun->drawSpecificMesh(*shader, 5);
 }
 
 void Player::setProjectionMatrix()
@@ -311,19 +133,20 @@ void Player::setProjectionMatrix()
 
 void Player::setGunModelMatrix()
 {
-    gunModelMatrix = glm::mat4(1.0);
+    gunBaseMatrix = glm::mat4(1.0);
 
     // orient the gun in the same direction as where the player is looking at
-    gunModelMatrix[0] = glm::vec4(Right, 0.0);
-    gunModelMatrix[1] = glm::vec4(Up, 0.0);
-    gunModelMatrix[2] = glm::vec4(Front, 0.0);
-    gunModelMatrix[3] = glm::vec4(gunPosition, 1.0); // place gun in bottom right corner
-    gunModelMatrix = glm::scale(gunModelMatrix, glm::vec3(0.6f)); // make gun a bit smaller
+    gunBaseMatrix[0] = glm::vec4(Right, 0.0);
+    gunBaseMatrix[1] = glm::vec4(Up, 0.0);
+    gunBaseMatrix[2] = glm::vec4(Front, 0.0);
+    gunBaseMatrix[3] = glm::vec4(gunPosition, 1.0); // place gun in bottom right corner
+    gunBaseMatrix = glm::scale(gunBaseMatrix, glm::vec3(0.6f)); // make gun a bit smaller
     /* here two rotations are applied; one to make the gun barrel face the same direction as the player,
     so that it doesn't point towards the player's face and another rotation to make the gun
     point slightly inwards so that it matches the bullet direction (which is just the camera lookAt matrix) */
-    gunModelMatrix = glm::rotate(gunModelMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    gunModelMatrix = glm::rotate(gunModelMatrix, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    gunBaseMatrix = glm::rotate(gunBaseMatrix, glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    gunBaseMatrix = glm::rotate(gunBaseMatrix, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    gunModelMatrix = gunBaseMatrix;
 
     // position the gun relative to the player
     viewLocalMat = GetViewMatrix();
@@ -347,234 +170,139 @@ glm::mat4 Player::getGunModelMatrix() const
 
 float Player::getHealth() const
 {   
-    return health;
+    return state.health;
 }
 
 bool Player::getLifeState() const
 {
-    if (isAlive) {return true;}
+    if (state.isAlive) {return true;}
     else {return false;}
 }
 
 int Player::getKills() const
 {
-    return kills;
+    return state.kills;
 }
 
 int Player::getShotsRemaining() const
 {
-    return shotsRemaining;
+    return state.shotsRemaining;
 }
 
 int Player::getMaxShotsBeforeReload() const
 {
-    return MAX_SHOTS_BEFORE_RELOAD;
-}
-
-void Player::updateKills()
-{
-    kills++;
-}
-
-void Player::startRecoilAnimation()
-{
-    if (angle > 20.0f) // rotate up as long as angle has not surpassed this value
-    {
-        goDown = true;
-    }
-
-    gunModelMatrix = glm::rotate(gunModelMatrix, glm::radians(angle), glm::vec3(0.0f, 0.0f, 1.0f)); // rotate upwards
-
-    angle += 6.0; // increase angle with every frame
+    return PlayerState::MAX_SHOTS_BEFORE_RELOAD;
 }
 
-void Player::endRecoilAnimation()
+void Player::updateRecoilAnimation()
 {
-    if (angle > 0) // rotate down as long as base position is not reached
-    {
-        angle -= 6.0; // decrease angle with every frame
-        gunModelMatrix = glm::rotate(gunModelMatrix, glm::radians(angle), glm::vec3(0.0f, 0.0f, -1.0f)); // rotate downwards
-    }
-
-    if (angle <= 0) // set all values back to what they were before player shot gun
-    {
-        angle = 0;
-        soundCount = 0;
-        shot = false;
-        goDown = false;
-        startRecoil = false;
-        if (shotsRemaining == 0)
-        {
-            startReloadAnimation();
-        }
-    }
-}
-
-void Player::startReloadAnimation()
-{
-    isReloading = true;
-    reloadStartTime = currentFrame;
-    ma_engine_set_volume(&engine, 1.5f);
-    ma_engine_play_sound(&engine, reloadSoundPath.c_str(), NULL);
-    angle = 0.0f;
-    goDown = false;
-    startRecoil = false;
-    shot = false;
-    gunPosition = glm::vec3(0.45f, -0.5f, -1.5f);
-    gunModelMatrix[3] = glm::vec4(gunPosition, 1.0f);
-    reloadBaseModelMatrix = gunModelMatrix;
+    // rotate up during the first half of the recoil and back down to base position during the second half
+    float progress = glm::clamp(state.shotTime / PlayerState::RECOIL_DURATION, 0.0f, 1.0f);
+    float phase = progress < 0.5f ? progress * 2.0f : (1.0f - progress) * 2.0f;
+    gunModelMatrix = glm::rotate(gunModelMatrix, glm::radians(RECOIL_ANGLE * phase), glm::vec3(0.0f, 0.0f, 1.0f));
 }
 
 void Player::updateReloadAnimation()
 {
-    float progress = (currentFrame - reloadStartTime) / RELOAD_DURATION;
-    if (progress < 0.0f)
-    {
-        progress = 0.0f;
-    }
-    else if (progress > 1.0f)
-    {
-        progress = 1.0f;
-    }
+    float progress = glm::clamp(state.reloadTime / PlayerState::RELOAD_DURATION, 0.0f, 1.0f);
 
     float phase = progress < 0.5f ? progress * 2.0f : (1.0f - progress) * 2.0f;
     float easedPhase = phase * phase * (3.0f - 2.0f * phase);
     glm::vec3 reloadPosition = gunPosition;
     reloadPosition.y = -0.5f + (RELOAD_HIDDEN_Y + 0.5f) * easedPhase;
-    gunModelMatrix = reloadBaseModelMatrix;
     gunModelMatrix[3] = glm::vec4(reloadPosition, 1.0f);
     gunModelMatrix = glm::rotate(gunModelMatrix, glm::radians(RELOAD_NOSE_DOWN_ANGLE * easedPhase), glm::vec3(0.0f, 0.0f, 1.0f));
-
-    if (progress >= 1.0f)
-    {
-        isReloading = false;
-        shotsRemaining = MAX_SHOTS_BEFORE_RELOAD;
-        gunPosition = glm::vec3(0.45f, -0.5f, -1.5f);
-        gunModelMatrix = reloadBaseModelMatrix;
-        gunModelMatrix[3] = glm::vec4(gunPosition, 1.0f);
-    }
 }
 
-void Player::controlPlayerRendering()
+void Player::follow(const PlayerState &playerState, const std::vector<SimEvent> &events)
 {
-    // create bounding box
-    createBoundingBox();
+    // follow the simulated player
+    state = playerState;
+    updatePlayerVectors();
 
-    // player dies if no health left
-    if (health <= 0)
+    // play sounds for what happened since the last frame
+    for (const SimEvent &event : events)
     {
-        /* in case player took a shot while dying, let the recoil animation finish before
-        going to the ending screen and resetting the values if player presses enter,
-        otherwise the gun will spawn in a wrongly rotated way after restarting the game */
-        if (!shot)
+        switch (event.type)
         {
-            isAlive = false;
-            ma_sound_stop(&walkingSound); // stop walking sound if player dies mid-walk
+            case SimEventType::PLAYER_SHOT:
+                ma_engine_set_volume(&engine, 2.0);
+                ma_engine_play_sound(&engine, gunshotSoundPath.c_str(), NULL);
+                showGunFire = true;
+                break;
+            case SimEventType::PLAYER_HIT:
+                ma_engine_set_volume(&engine, 1.4);
+                ma_engine_play_sound(&engine, damageSoundPath.c_str(), NULL);
+                break;
+            case SimEventType::RELOAD_STARTED:
+                ma_engine_set_volume(&engine, 1.5f);
+                ma_engine_play_sound(&engine, reloadSoundPath.c_str(), NULL);
+                gunPosition = glm::vec3(0.45f, -0.5f, -1.5f);
+                break;
+            default:
+                break;
         }
     }
 
-    // add passive player motion
-    if (!isWalking)
+    // walking motion and audio
+    if (state.isWalking && state.isAlive)
     {
-        passiveMotion();
+        ma_sound_set_volume(&walkingSound, 0.6);
+        ma_sound_start(&walkingSound);
+        if (!state.isReloading)
+        {
+            walkingMotion();
+        }
+    }
+    else
+    {
+        ma_sound_stop(&walkingSound); // also stops walking sound if player dies mid-walk
+        passiveMotion(); // add passive player motion
     }
 
-    if (isReloading)
+    // animate the gun, starting from its base position
+    gunModelMatrix = gunBaseMatrix;
+    gunModelMatrix[3] = glm::vec4(gunPosition, 1.0f);
+    if (state.isReloading)
     {
         updateReloadAnimation();
-        drawGun();
-        return;
     }
-
-    // draw the handgun in base position
-    if (!shot)
+    else if (state.shot)
     {
-        drawGun();
+        updateRecoilAnimation();
     }
+}
+
+void Player::controlPlayerRendering()
+{
+    // draw the handgun
+    drawGun();
 
     // draw the gunfire (only for one frame, otherwise the gunfire is visible for too long, which just looks weird)
-    if (shot && !startRecoil)
+    if (showGunFire)
     {
         drawGunFire();
-        startRecoil = true;
-    }
-
-    // start the recoil animation
-    if (startRecoil)
-    {
-        if (!goDown)
-        {
-            startRecoilAnimation(); // start moving up
-        }
-        else
-        {
-            endRecoilAnimation(); // start moving down
-        }
-        drawGun(); // render rotating handgun
+        showGunFire = false;
     }
 }
 
 void Player::updatePlayerVectors()
 {
-    // calculate the new Front vector
-    glm::vec3 front;
-    front.x = cos(glm::radians(Yaw)) * cos(glm::radians(Pitch));
-    front.y = sin(glm::radians(Pitch));
-    front.z = sin(glm::radians(Yaw)) * cos(glm::radians(Pitch));
-    Front = glm::normalize(front);
-
-    // also re-calculate the Right and Up vector
-    Right = glm::normalize(glm::cross(Front, WorldUp)); // normalize the vectors
-    Up = glm::normalize(glm::cross(Right, Front));
-}
-
-void Player::gotAttacked(float damage)
-{
-    health -= damage;
-    ma_engine_set_volume(&engine, 1.4);
-    ma_engine_play_sound(&engine, damageSoundPath.c_str(), NULL); 
-}
-
-void Player::processKeyboardMouse(GLFWwindow *window, float deltaTime)
-{
-    processInput(window, deltaTime);
-    glfwGetCursorPos(window, &xPosIn, &yPosIn);
-    ProcessMouseMovement();
+    Position = state.position;
+    Front = state.front;
+    Right = state.right;
+    Up = state.up;
 }
 
 void Player::resetAll()
 {
-    angle = 0;
-    soundCount = 0;
-    shot = false;
-    startRecoil = false;
-    goDown = false;
-    shotsRemaining = MAX_SHOTS_BEFORE_RELOAD;
-    isReloading = false;
-    reloadStartTime = 0.0f;
-    reloadBaseModelMatrix = glm::mat4(1.0f);
-    isAlive = true;
-    kills = 0;
-    health = 100;
-    Pitch = PITCH;
-    Yaw = YAW;
-    Position = origPosition;
+    showGunFire = false;
+    state = PlayerState();
     gunPosition = {0.45f, -0.5f, -1.5f};
     updatePlayerVectors();
     setGunModelMatrix();
 }
 
-
-void Player::createBoundingBox()
-{
-    // create the min and max bound 
-    glm::vec3 vmin = {Position.x - 0.3, Position.y - 1.0f, Position.z - 0.6};
-    glm::vec3 vmax = {Position.x + 0.3, Position.y + 0.5f, Position.z};
-
-    // create bounding box (it's a cuboid; see docs/player_bbox for a visualization)
-    boundingBox = AABBox(vmin, vmax);
-}
-
 void Player::audioSetup()
 {
     // wav file paths
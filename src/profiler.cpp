@@ -0,0 +1,181 @@
+#include "profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+const int Profiler::RING_SIZE = 1 << 16;
+
+namespace
+{
+    enum class EventType : std::uint8_t
+    {
+        ZONE,
+        COUNTER,
+        FRAME
+    };
+
+    struct Event
+    {
+        const char *name;    // zone or counter name (string literal)
+        std::uint64_t start; // start time (ns)
+        std::uint64_t end;   // end time of a zone (ns)
+        double value;        // value of a counter
+        EventType type;
+    };
+
+    // events of one thread; only that thread writes, so recording needs no lock
+    struct ThreadRing
+    {
+        int id = 0;                            // thread id in the trace
+        std::string name;                      // thread name in the trace (guarded by the registry mutex)
+        std::unique_ptr<Event[]> events;       // ring of RING_SIZE events
+        std::atomic<std::uint64_t> written{0}; // number of events recorded so far
+    };
+
+    // all rings ever created; they live until the program exits, so a dump can still read threads that ended
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadRing>> rings;
+    };
+}
+
+static Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+static std::chrono::steady_clock::time_point epoch()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+// the calling thread's ring, created (the only locked step) the first time the thread records something
+static ThreadRing &threadRing()
+{
+    thread_local ThreadRing *ring = nullptr;
+    if (ring == nullptr)
+    {
+        std::unique_ptr<ThreadRing> created(new ThreadRing());
+        created->events.reset(new Event[Profiler::RING_SIZE]);
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        created->id = static_cast<int>(reg.rings.size());
+        created->name = "thread " + std::to_string(created->id);
+        ring = created.get();
+        reg.rings.push_back(std::move(created));
+    }
+    return *ring;
+}
+
+static void record(const Event &event)
+{
+    ThreadRing &ring = threadRing();
+    std::uint64_t index = ring.written.load(std::memory_order_relaxed);
+    ring.events[index % Profiler::RING_SIZE] = event;
+    ring.written.store(index + 1, std::memory_order_release); // publishes the event to writeChromeTrace
+}
+
+// names are literals from the code, but keep the JSON valid whatever they contain
+static void writeJsonString(std::ostream &out, const std::string &text)
+{
+    out << '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out << '\\';
+        }
+        out << (static_cast<unsigned char>(c) < 0x20 ? ' ' : c);
+    }
+    out << '"';
+}
+
+std::uint64_t Profiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch()).count();
+}
+
+void Profiler::zone(const char *name, std::uint64_t start, std::uint64_t end)
+{
+    record({name, start, end, 0.0, EventType::ZONE});
+}
+
+void Profiler::counter(const char *name, double value)
+{
+    record({name, now(), 0, value, EventType::COUNTER});
+}
+
+void Profiler::frame()
+{
+    record({"frame", now(), 0, 0.0, EventType::FRAME});
+}
+
+void Profiler::setThreadName(const std::string &name)
+{
+    ThreadRing &ring = threadRing();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    ring.name = name;
+}
+
+bool Profiler::writeChromeTrace(const std::string &path)
+{
+    std::ofstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::PROFILER::Could not open " << path << std::endl;
+        return false;
+    }
+
+    // timestamps in microseconds (with ns precision)
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    size_t count = 0;
+
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const std::unique_ptr<ThreadRing> &ring : reg.rings)
+    {
+        file << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << ring->id << ", \"args\": {\"name\": ";
+        writeJsonString(file, ring->name);
+        file << "}}";
+        first = false;
+
+        // only the last RING_SIZE events are still in the ring
+        std::uint64_t written = ring->written.load(std::memory_order_acquire);
+        std::uint64_t begin = written > static_cast<std::uint64_t>(RING_SIZE) ? written - RING_SIZE : 0;
+        for (std::uint64_t i = begin; i < written; i++)
+        {
+            const Event &event = ring->events[i % RING_SIZE];
+            file << ",\n{\"name\": ";
+            writeJsonString(file, event.name);
+            file << ", \"pid\": 1, \"tid\": " << ring->id << ", \"ts\": " << event.start / 1000.0;
+            switch (event.type)
+            {
+                case EventType::ZONE:
+                    file << ", \"ph\": \"X\", \"dur\": " << (event.end - event.start) / 1000.0 << "}";
+                    break;
+                case EventType::COUNTER:
+                    file << ", \"ph\": \"C\", \"args\": {\"value\": " << event.value << "}}";
+                    break;
+                case EventType::FRAME:
+                    file << ", \"ph\": \"i\", \"s\": \"g\"}";
+                    break;
+            }
+            count++;
+        }
+    }
+    file << "\n]}\n";
+
+    std::cout << "Saved " << count << " profiler events to " << path << std::endl;
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,27 @@
+#include "random_streams.h"
+
+unsigned int randomSeed()
+{
+    return std::random_device()();
+}
+
+std::mt19937 makeRandomStream(unsigned int seed, RandomStream stream)
+{
+    // seed_seq mixes the seed and the stream number, so neighbouring seeds/streams give unrelated sequences
+    std::seed_seq sequence = {seed, static_cast<unsigned int>(stream)};
+    return std::mt19937(sequence);
+}
+
+int randomInt(std::mt19937 &gen, int min, int max)
+{
+    // the modulo bias is negligible for the small ranges used in the game
+    unsigned int range = static_cast<unsigned int>(max - min) + 1;
+    return min + static_cast<int>(gen() % range);
+}
+
+float randomFloat(std::mt19937 &gen, float min, float max)
+{
+    // 24 random bits fill the mantissa of a float in [0, 1)
+    float unit = static_cast<float>(gen() >> 8) * (1.0f / 16777216.0f);
+    return min + unit * (max - min);
+}
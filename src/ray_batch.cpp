@@ -0,0 +1,193 @@
+#include "ray_batch.h"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#define RAY_BATCH_SSE
+#include <emmintrin.h>
+#endif
+
+/*
+All code paths use the same slab test. Per axis, the distances along the ray to the two planes of the box are
+t0 = (min - origin) / dir and t1 = (max - origin) / dir. The ray is inside the box between
+enter = max(min(t0, t1) over all axes, 0) and exit = min(max(t0, t1) over all axes, maxDistance),
+so it hits the box if enter <= exit. For the nearest hit, maxDistance shrinks to the best distance found so far.
+An inverted box (min > max on an axis, e.g. +inf/-inf for an unused slot) would pass that test at distance 0 for
+some rays, so every path also requires min <= max on all three axes.
+*/
+
+// keeps the nearest hit; on equal distances the lowest index wins
+static inline void keepNearest(float t, int index, float &bestT, int &bestIndex)
+{
+    if (index >= 0 && (bestIndex < 0 || t < bestT || (t == bestT && index < bestIndex)))
+    {
+        bestT = t;
+        bestIndex = index;
+    }
+}
+
+// scalar slab test for the boxes in [begin, end), starting from the best hit so far
+static void nearestScalar(const Ray &ray, const BoxArrays &boxes, int begin, int end, float maxDistance, float &bestT, int &bestIndex)
+{
+    for (int i = begin; i < end; i++)
+    {
+        float t0x = (boxes.minX[i] - ray.orig.x) * ray.invdir.x;
+        float t1x = (boxes.maxX[i] - ray.orig.x) * ray.invdir.x;
+        float t0y = (boxes.minY[i] - ray.orig.y) * ray.invdir.y;
+        float t1y = (boxes.maxY[i] - ray.orig.y) * ray.invdir.y;
+        float t0z = (boxes.minZ[i] - ray.orig.z) * ray.invdir.z;
+        float t1z = (boxes.maxZ[i] - ray.orig.z) * ray.invdir.z;
+
+        float enter = std::max(std::max(std::min(t0x, t1x), std::min(t0y, t1y)), std::max(std::min(t0z, t1z), 0.0f));
+        float exit = std::min(std::min(std::max(t0x, t1x), std::max(t0y, t1y)), std::min(std::max(t0z, t1z), maxDistance));
+        bool valid = boxes.minX[i] <= boxes.maxX[i] && boxes.minY[i] <= boxes.maxY[i] && boxes.minZ[i] <= boxes.maxZ[i];
+        if (valid && enter <= exit && (bestIndex < 0 || enter < bestT))
+        {
+            bestT = enter;
+            bestIndex = i;
+            maxDistance = enter;
+        }
+    }
+}
+
+int nearestRayHitScalar(const Ray &ray, const BoxArrays &boxes, int begin, int end, float maxDistance, float &distance)
+{
+    float bestT = maxDistance;
+    int bestIndex = -1;
+    nearestScalar(ray, boxes, begin, end, maxDistance, bestT, bestIndex);
+    if (bestIndex >= 0)
+    {
+        distance = bestT;
+    }
+    return bestIndex;
+}
+
+int nearestRayHit(const Ray &ray, const BoxArrays &boxes, int begin, int end, float maxDistance, float &distance)
+{
+    float bestT = maxDistance;
+    int bestIndex = -1;
+    int i = begin;
+
+#if defined(__AVX2__)
+    if (end - i >= 8)
+    {
+        const __m256 ox = _mm256_set1_ps(ray.orig.x), oy = _mm256_set1_ps(ray.orig.y), oz = _mm256_set1_ps(ray.orig.z);
+        const __m256 ix = _mm256_set1_ps(ray.invdir.x), iy = _mm256_set1_ps(ray.invdir.y), iz = _mm256_set1_ps(ray.invdir.z);
+        __m256 laneT = _mm256_set1_ps(maxDistance);  // best distance per lane
+        __m256i laneIndex = _mm256_set1_epi32(-1);   // best index per lane
+        __m256i index = _mm256_setr_epi32(i, i + 1, i + 2, i + 3, i + 4, i + 5, i + 6, i + 7);
+        const __m256i step = _mm256_set1_epi32(8);
+
+        for (; i + 8 <= end; i += 8)
+        {
+            __m256 minX = _mm256_loadu_ps(boxes.minX + i), maxX = _mm256_loadu_ps(boxes.maxX + i);
+            __m256 minY = _mm256_loadu_ps(boxes.minY + i), maxY = _mm256_loadu_ps(boxes.maxY + i);
+            __m256 minZ = _mm256_loadu_ps(boxes.minZ + i), maxZ = _mm256_loadu_ps(boxes.maxZ + i);
+            __m256 t0x = _mm256_mul_ps(_mm256_sub_ps(minX, ox), ix);
+            __m256 t1x = _mm256_mul_ps(_mm256_sub_ps(maxX, ox), ix);
+            __m256 t0y = _mm256_mul_ps(_mm256_sub_ps(minY, oy), iy);
+            __m256 t1y = _mm256_mul_ps(_mm256_sub_ps(maxY, oy), iy);
+            __m256 t0z = _mm256_mul_ps(_mm256_sub_ps(minZ, oz), iz);
+            __m256 t1z = _mm256_mul_ps(_mm256_sub_ps(maxZ, oz), iz);
+            __m256 valid = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(minX, maxX, _CMP_LE_OQ), _mm256_cmp_ps(minY, maxY, _CMP_LE_OQ)),
+                                         _mm256_cmp_ps(minZ, maxZ, _CMP_LE_OQ));
+
+            __m256 enter = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(t0x, t1x), _mm256_min_ps(t0y, t1y)),
+                                         _mm256_max_ps(_mm256_min_ps(t0z, t1z), _mm256_setzero_ps()));
+            __m256 exit = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(t0x, t1x), _mm256_max_ps(t0y, t1y)),
+                                        _mm256_min_ps(_mm256_max_ps(t0z, t1z), laneT));
+
+            // hit and nearer than the lane's best (or the lane's first hit)
+            __m256 hit = _mm256_and_ps(valid, _mm256_cmp_ps(enter, exit, _CMP_LE_OQ));
+            __m256 empty = _mm256_castsi256_ps(_mm256_cmpeq_epi32(laneIndex, _mm256_set1_epi32(-1)));
+            __m256 better = _mm256_and_ps(hit, _mm256_or_ps(empty, _mm256_cmp_ps(enter, laneT, _CMP_LT_OQ)));
+
+            laneT = _mm256_blendv_ps(laneT, enter, better);
+            laneIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(laneIndex), _mm256_castsi256_ps(index), better));
+            index = _mm256_add_epi32(index, step);
+        }
+
+        alignas(32) float t[8];
+        alignas(32) int indices[8];
+        _mm256_store_ps(t, laneT);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(indices), laneIndex);
+        for (int lane = 0; lane < 8; lane++)
+        {
+            keepNearest(t[lane], indices[lane], bestT, bestIndex);
+        }
+    }
+#endif
+
+#if defined(RAY_BATCH_SSE)
+    if (end - i >= 4)
+    {
+        const __m128 ox = _mm_set1_ps(ray.orig.x), oy = _mm_set1_ps(ray.orig.y), oz = _mm_set1_ps(ray.orig.z);
+        const __m128 ix = _mm_set1_ps(ray.invdir.x), iy = _mm_set1_ps(ray.invdir.y), iz = _mm_set1_ps(ray.invdir.z);
+        __m128 laneT = _mm_set1_ps(bestIndex >= 0 ? bestT : maxDistance); // best distance per lane
+        __m128i laneIndex = _mm_set1_epi32(-1);                            // best index per lane
+        __m128i index = _mm_setr_epi32(i, i + 1, i + 2, i + 3);
+        const __m128i step = _mm_set1_epi32(4);
+
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 minX = _mm_loadu_ps(boxes.minX + i), maxX = _mm_loadu_ps(boxes.maxX + i);
+            __m128 minY = _mm_loadu_ps(boxes.minY + i), maxY = _mm_loadu_ps(boxes.maxY + i);
+            __m128 minZ = _mm_loadu_ps(boxes.minZ + i), maxZ = _mm_loadu_ps(boxes.maxZ + i);
+            __m128 t0x = _mm_mul_ps(_mm_sub_ps(minX, ox), ix);
+            __m128 t1x = _mm_mul_ps(_mm_sub_ps(maxX, ox), ix);
+            __m128 t0y = _mm_mul_ps(_mm_sub_ps(minY, oy), iy);
+            __m128 t1y = _mm_mul_ps(_mm_sub_ps(maxY, oy), iy);
+            __m128 t0z = _mm_mul_ps(_mm_sub_ps(minZ, oz), iz);
+            __m128 t1z = _mm_mul_ps(_mm_sub_ps(maxZ, oz), iz);
+            __m128 valid = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(minX, maxX), _mm_cmple_ps(minY, maxY)), _mm_cmple_ps(minZ, maxZ));
+
+            __m128 enter = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)),
+                                      _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_setzero_ps()));
+            __m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)),
+                                     _mm_min_ps(_mm_max_ps(t0z, t1z), laneT));
+
+            // hit and nearer than the lane's best (or the lane's first hit); SSE2 has no blend, so select with masks
+            __m128 hit = _mm_and_ps(valid, _mm_cmple_ps(enter, exit));
+            __m128 empty = _mm_castsi128_ps(_mm_cmpeq_epi32(laneIndex, _mm_set1_epi32(-1)));
+            __m128 better = _mm_and_ps(hit, _mm_or_ps(empty, _mm_cmplt_ps(enter, laneT)));
+
+            laneT = _mm_or_ps(_mm_and_ps(better, enter), _mm_andnot_ps(better, laneT));
+            __m128i betterIndex = _mm_castps_si128(better);
+            laneIndex = _mm_or_si128(_mm_and_si128(betterIndex, index), _mm_andnot_si128(betterIndex, laneIndex));
+            index = _mm_add_epi32(index, step);
+        }
+
+        alignas(16) float t[4];
+        alignas(16) int indices[4];
+        _mm_store_ps(t, laneT);
+        _mm_store_si128(reinterpret_cast<__m128i *>(indices), laneIndex);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            keepNearest(t[lane], indices[lane], bestT, bestIndex);
+        }
+    }
+#endif
+
+    // remaining boxes one at a time (only boxes strictly nearer can win, they all have higher indices)
+    nearestScalar(ray, boxes, i, end, bestIndex >= 0 ? bestT : maxDistance, bestT, bestIndex);
+
+    if (bestIndex >= 0)
+    {
+        distance = bestT;
+    }
+    return bestIndex;
+}
+
+const char *rayBatchInstructionSet()
+{
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(RAY_BATCH_SSE)
+    return "SSE";
+#else
+    return "scalar";
+#endif
+}
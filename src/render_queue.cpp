@@ -0,0 +1,85 @@
+#include "render_queue.h"
+#include "gl_state.h"
+
+#include <algorithm>
+
+std::uint64_t RenderQueue::sortKey(const DrawItem &item)
+{
+    float depth = std::min(std::max(item.depth, 0.0f), 1.0f);
+    std::uint64_t key = 0;
+    key |= static_cast<std::uint64_t>(item.layer & 0xFu) << 60;
+    key |= static_cast<std::uint64_t>(item.program & 0xFFFu) << 48;
+    key |= static_cast<std::uint64_t>(item.texture & 0xFFFFu) << 32;
+    key |= static_cast<std::uint64_t>(item.VAO & 0xFFFFu) << 16;
+    key |= static_cast<std::uint64_t>(depth * 65535.0f);
+    return key;
+}
+
+void RenderQueue::submit(const DrawItem &item)
+{
+    entries.push_back({sortKey(item), item});
+}
+
+void RenderQueue::flush()
+{
+    // items with the same key keep the order they were submitted in
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.key < b.key; });
+
+    const DrawItem *previous = nullptr;
+    for (const Entry &entry : entries)
+    {
+        const DrawItem &item = entry.item;
+
+        // count the state changes between neighbouring items (GLState skips the binds that are not changes)
+        if (previous == nullptr || item.program != previous->program)
+        {
+            stats.programBinds++;
+        }
+        else
+        {
+            stats.redundantBinds++;
+        }
+        if (previous == nullptr || item.texture != previous->texture)
+        {
+            stats.textureBinds++;
+        }
+        else
+        {
+            stats.redundantBinds++;
+        }
+        if (previous == nullptr || item.VAO != previous->VAO)
+        {
+            stats.vertexArrayBinds++;
+        }
+        else
+        {
+            stats.redundantBinds++;
+        }
+        previous = &item;
+
+        GLState::useProgram(item.program);
+        GLState::bindTexture(0, GL_TEXTURE_2D, item.texture);
+        GLState::bindVertexArray(item.VAO);
+
+        if (item.indexed)
+        {
+            glDrawElementsInstanced(item.mode, item.count, GL_UNSIGNED_INT, 0, item.instanceCount);
+        }
+        else
+        {
+            glDrawArraysInstanced(item.mode, 0, item.count, item.instanceCount);
+        }
+        stats.draws++;
+    }
+    entries.clear();
+}
+
+void RenderQueue::resetStats()
+{
+    stats = RenderQueueStats();
+}
+
+const RenderQueueStats &RenderQueue::getStats() const
+{
+    return stats;
+}
@@ -0,0 +1,229 @@
+#include "resource_registry.h"
+#include "gl_state.h"
+#include "model.h"
+#include "texture_loading.h"
+
+#include <unordered_map>
+
+namespace
+{
+// resources by key; an entry expires when the last reference is released and is removed by the deleter
+std::unordered_map<std::string, std::weak_ptr<Model>> models;
+std::unordered_map<std::string, std::weak_ptr<const TextureObject>> textures;
+std::unordered_map<std::string, std::weak_ptr<Shader>> shaders;
+ResourceRegistryStats stats; // loads and hits (the counts of alive resources are filled in by getStats)
+
+/// Returns the resource of a key if it is alive, else nullptr.
+template <typename T>
+std::shared_ptr<T> find(std::unordered_map<std::string, std::weak_ptr<T>> &resources, const std::string &key)
+{
+    auto it = resources.find(key);
+    std::shared_ptr<T> resource = it != resources.end() ? it->second.lock() : nullptr;
+    if (resource)
+    {
+        stats.hits++;
+    }
+    return resource;
+}
+
+/// Removes the entry of a key, unless it was replaced by a resource that is alive.
+template <typename T>
+void forget(std::unordered_map<std::string, std::weak_ptr<T>> &resources, const std::string &key)
+{
+    auto it = resources.find(key);
+    if (it != resources.end() && it->second.expired())
+    {
+        resources.erase(it);
+    }
+}
+
+/// Counts the resources that are alive.
+template <typename T>
+unsigned int countAlive(const std::unordered_map<std::string, std::weak_ptr<T>> &resources)
+{
+    unsigned int alive = 0;
+    for (const auto &entry : resources)
+    {
+        alive += entry.second.expired() ? 0 : 1;
+    }
+    return alive;
+}
+
+/// Key of a model.
+std::string modelKey(const std::string &path, bool flipVertically)
+{
+    return path + (flipVertically ? "|flipped" : "");
+}
+
+/// Key of a 2D texture.
+std::string textureKey(const std::string &filename, const std::string &directory, bool flipVertically)
+{
+    return directory + '/' + filename + (flipVertically ? "|flipped" : "");
+}
+
+/// Key of a cubemap (in the same map as the 2D textures).
+std::string cubemapKey(const std::vector<std::string> &faces)
+{
+    std::string key = "cubemap";
+    for (const std::string &face : faces)
+    {
+        key += '|' + face;
+    }
+    return key;
+}
+
+/// Hands a model to the registry, it is deleted with its last reference.
+std::shared_ptr<Model> manageModel(const std::string &key, Model *model)
+{
+    std::shared_ptr<Model> managed(model, [key](Model *model)
+                                   {
+                                       delete model; // deletes the meshes, the textures go with their last reference
+                                       forget(models, key); });
+    models[key] = managed;
+    return managed;
+}
+
+/// Hands a texture (2D or cubemap) to the registry, it is deleted (also on the GPU) with its last reference.
+std::shared_ptr<const TextureObject> manageTexture(const std::string &key, unsigned int id, std::size_t bytes)
+{
+    std::shared_ptr<const TextureObject> managed(new TextureObject{id, bytes}, [key](const TextureObject *object)
+                                                 {
+                                                     GLState::forgetTexture(object->id);
+                                                     glDeleteTextures(1, &object->id);
+                                                     delete object;
+                                                     forget(textures, key); });
+    textures[key] = managed;
+    return managed;
+}
+} // namespace
+
+std::shared_ptr<Model> ResourceRegistry::getModel(const std::string &path, bool flipVertically)
+{
+    std::string key = modelKey(path, flipVertically);
+    if (std::shared_ptr<Model> model = find(models, key))
+    {
+        return model;
+    }
+
+    stats.loads++;
+    return manageModel(key, new Model(path, flipVertically));
+}
+
+std::shared_ptr<const TextureObject> ResourceRegistry::getTexture(const std::string &filename, const std::string &directory, bool flipVertically)
+{
+    std::string key = textureKey(filename, directory, flipVertically);
+    if (std::shared_ptr<const TextureObject> texture = find(textures, key))
+    {
+        return texture;
+    }
+
+    stats.loads++;
+    std::size_t bytes = 0;
+    unsigned int id = TextureFromFile(filename.c_str(), directory, flipVertically, false, &bytes);
+    return manageTexture(key, id, bytes);
+}
+
+std::shared_ptr<const TextureObject> ResourceRegistry::getCubemap(const std::vector<std::string> &faces)
+{
+    std::string key = cubemapKey(faces);
+    if (std::shared_ptr<const TextureObject> cubemap = find(textures, key))
+    {
+        return cubemap;
+    }
+
+    stats.loads++;
+    std::size_t bytes = 0;
+    unsigned int id = loadCubemap(faces, &bytes);
+    return manageTexture(key, id, bytes);
+}
+
+std::shared_ptr<Shader> ResourceRegistry::getShader(const std::string &vertexPath, const std::string &fragmentPath,
+                                                    const std::string &geometryPath, const std::vector<std::string> &defines)
+{
+    std::string key = vertexPath + '|' + fragmentPath + '|' + geometryPath;
+    for (const std::string &define : defines)
+    {
+        key += '|' + define;
+    }
+    if (std::shared_ptr<Shader> shader = find(shaders, key))
+    {
+        return shader;
+    }
+
+    stats.loads++;
+    Shader *program = new Shader(vertexPath.c_str(), fragmentPath.c_str(), geometryPath.empty() ? nullptr : geometryPath.c_str(), defines);
+    std::shared_ptr<Shader> shader(program, [key](Shader *program)
+                                   {
+                                       GLState::forgetProgram(program->ID);
+                                       glDeleteProgram(program->ID);
+                                       delete program;
+                                       forget(shaders, key); });
+    shaders[key] = shader;
+    return shader;
+}
+
+std::shared_ptr<Model> ResourceRegistry::findModel(const std::string &path, bool flipVertically)
+{
+    return find(models, modelKey(path, flipVertically));
+}
+
+std::shared_ptr<const TextureObject> ResourceRegistry::findTexture(const std::string &filename, const std::string &directory, bool flipVertically)
+{
+    return find(textures, textureKey(filename, directory, flipVertically));
+}
+
+std::shared_ptr<const TextureObject> ResourceRegistry::findCubemap(const std::vector<std::string> &faces)
+{
+    return find(textures, cubemapKey(faces));
+}
+
+std::shared_ptr<Model> ResourceRegistry::addModel(const std::string &path, bool flipVertically, Model *model)
+{
+    std::string key = modelKey(path, flipVertically);
+    if (std::shared_ptr<Model> alive = find(models, key))
+    {
+        delete model;
+        return alive;
+    }
+
+    stats.loads++;
+    return manageModel(key, model);
+}
+
+std::shared_ptr<const TextureObject> ResourceRegistry::addTexture(const std::string &filename, const std::string &directory, bool flipVertically,
+                                                                  unsigned int id, std::size_t bytes)
+{
+    std::string key = textureKey(filename, directory, flipVertically);
+    if (std::shared_ptr<const TextureObject> alive = find(textures, key))
+    {
+        GLState::forgetTexture(id);
+        glDeleteTextures(1, &id);
+        return alive;
+    }
+
+    stats.loads++;
+    return manageTexture(key, id, bytes);
+}
+
+std::shared_ptr<const TextureObject> ResourceRegistry::addCubemap(const std::vector<std::string> &faces, unsigned int id, std::size_t bytes)
+{
+    std::string key = cubemapKey(faces);
+    if (std::shared_ptr<const TextureObject> alive = find(textures, key))
+    {
+        GLState::forgetTexture(id);
+        glDeleteTextures(1, &id);
+        return alive;
+    }
+
+    stats.loads++;
+    return manageTexture(key, id, bytes);
+}
+
+ResourceRegistryStats ResourceRegistry::getStats()
+{
+    ResourceRegistryStats current = stats;
+    current.models = countAlive(models);
+    current.textures = countAlive(textures);
+    current.shaders = countAlive(shaders);
+    return current;
+}
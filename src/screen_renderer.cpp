@@ -1,4 +1,5 @@
 #include "screen_renderer.h"
+#include "gl_state.h"
 
 ScreenRenderer::ScreenRenderer(const std::string& vertPath, const std::string& fragPath)
     : shader(vertPath.c_str(), fragPath.c_str())
@@ -22,24 +23,22 @@ void ScreenRenderer::setupQuad()
 
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
+    GLState::bindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
 
 void ScreenRenderer::draw(unsigned int textureID)
 {
-    glDisable(GL_DEPTH_TEST);
+    GLState::setEnabled(GL_DEPTH_TEST, false);
     shader.use();
     shader.setInt("screenTexture", 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glBindVertexArray(VAO);
+    GLState::bindTexture(0, GL_TEXTURE_2D, textureID);
+    GLState::bindVertexArray(VAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
 }
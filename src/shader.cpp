@@ -1,8 +1,45 @@
 #include "shader.h"
+#include "camera_uniforms.h"
+#include "gl_state.h"
 
-Shader::Shader(){};
+#include <algorithm>
+#include <vector>
 
-Shader::Shader(const char *vertexPath, const char *fragmentPath, const char *geometryPath)
+/**
+ * @brief Adds a #define line for every name after the #version line of a shader source
+ * (#version has to come first, the other lines may use the defines).
+ *
+ * @param code shader source.
+ * @param defines names to define.
+ */
+static void addDefines(std::string &code, const std::vector<std::string> &defines)
+{
+    if (defines.empty() || code.empty())
+    {
+        return;
+    }
+    std::string lines;
+    for (const std::string &define : defines)
+    {
+        lines += "#define " + define + "\n";
+    }
+    size_t position = 0;
+    size_t version = code.find("#version");
+    if (version != std::string::npos)
+    {
+        size_t end = code.find('\n', version);
+        position = end == std::string::npos ? code.size() : end + 1;
+        if (end == std::string::npos)
+        {
+            lines = "\n" + lines;
+        }
+    }
+    code.insert(position, lines);
+}
+
+Shader::Shader() : ID(0) {};
+
+Shader::Shader(const char *vertexPath, const char *fragmentPath, const char *geometryPath, const std::vector<std::string> &defines)
 {
     // 1. retrieve the vertex/fragment source code from filePath
     std::string vertexCode;
@@ -44,6 +81,9 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath, const char *geo
     {
         std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << e.what() << std::endl;
     }
+    addDefines(vertexCode, defines);
+    addDefines(fragmentCode, defines);
+    addDefines(geometryCode, defines);
     const char *vShaderCode = vertexCode.c_str();
     const char *fShaderCode = fragmentCode.c_str();
     // 2. compile shaders
@@ -77,6 +117,7 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath, const char *geo
     }
     glLinkProgram(ID);
     checkCompileErrors(ID, "PROGRAM");
+    reflectUniforms();
     // delete the shaders as they're linked into our program now and no longer necessery
     glDeleteShader(vertex);
     glDeleteShader(fragment);
@@ -88,67 +129,104 @@ Shader::Shader(const char *vertexPath, const char *fragmentPath, const char *geo
 
 void Shader::use() const
 {
-    glUseProgram(ID);
+    GLState::useProgram(ID);
 }
 
 void Shader::setBool(const std::string &name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    glUniform1i(getUniformLocation(name), (int)value);
 }
 
 void Shader::setInt(const std::string &name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string &name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setVec2(const std::string &name, const glm::vec2 &value) const
 {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform2fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec2(const std::string &name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+    glUniform2f(getUniformLocation(name), x, y);
 }
 
 void Shader::setVec3(const std::string &name, const glm::vec3 &value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform3fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec3(const std::string &name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    glUniform3f(getUniformLocation(name), x, y, z);
 }
 
 void Shader::setVec4(const std::string &name, const glm::vec4 &value) const
 {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform4fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec4(const std::string &name, float x, float y, float z, float w) const
 {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+    glUniform4f(getUniformLocation(name), x, y, z, w);
 }
 
 void Shader::setMat2(const std::string &name, const glm::mat2 &mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setMat3(const std::string &name, const glm::mat3 &mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+}
+
+GLint Shader::getUniformLocation(const std::string &name) const
+{
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
+void Shader::reflectUniforms()
+{
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<GLchar> buffer(static_cast<size_t>(std::max(maxLength, 1)));
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, static_cast<GLuint>(i), maxLength, &length, &size, &type, buffer.data());
+        std::string name(buffer.data(), static_cast<size_t>(length));
+        GLint location = glGetUniformLocation(ID, name.c_str());
+        if (location < 0) continue; // member of a uniform block
+        uniformLocations[name] = location;
+        // arrays are reported as "name[0]", but can also be set by their plain name
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+        {
+            uniformLocations[name.substr(0, name.size() - 3)] = location;
+        }
+    }
+
+    GLuint cameraBlock = glGetUniformBlockIndex(ID, CameraUniforms::BLOCK_NAME);
+    if (cameraBlock != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(ID, cameraBlock, CameraUniforms::BINDING);
+    }
 }
 
 void Shader::checkCompileErrors(GLuint shader, std::string type)
@@ -0,0 +1,53 @@
+#include "shader_permutations.h"
+
+ShaderPermutations::ShaderPermutations() : geometryFeatures(0) {}
+
+ShaderPermutations::ShaderPermutations(const std::string &vertexPath, const std::string &fragmentPath, const std::string &geometryPath,
+                                       const std::vector<std::string> &features, unsigned int geometryFeatures)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath), geometryPath(geometryPath), features(features), geometryFeatures(geometryFeatures)
+{
+    if (features.size() > 32)
+    {
+        std::cout << "ERROR::SHADER_PERMUTATIONS::TOO_MANY_FEATURES: " << features.size() << " (at most 32)" << std::endl;
+        this->features.resize(32);
+    }
+}
+
+Shader &ShaderPermutations::get(unsigned int permutation)
+{
+    auto it = cache.find(permutation);
+    if (it != cache.end())
+    {
+        return *it->second;
+    }
+
+    // define the names of the enabled features
+    std::vector<std::string> defines;
+    for (size_t i = 0; i < features.size(); i++)
+    {
+        if (permutation & (1u << i))
+        {
+            defines.push_back(features[i]);
+        }
+    }
+    bool useGeometry = !geometryPath.empty() && (permutation & geometryFeatures) != 0;
+    std::shared_ptr<Shader> shader = ResourceRegistry::getShader(vertexPath, fragmentPath, useGeometry ? geometryPath : "", defines);
+    return *cache.emplace(permutation, shader).first->second;
+}
+
+unsigned int ShaderPermutations::feature(const std::string &name) const
+{
+    for (size_t i = 0; i < features.size(); i++)
+    {
+        if (features[i] == name)
+        {
+            return 1u << i;
+        }
+    }
+    return 0;
+}
+
+size_t ShaderPermutations::compiledCount() const
+{
+    return cache.size();
+}
@@ -0,0 +1,28 @@
+#include "sim_state.h"
+
+// default player values
+const float PlayerState::YAW = -90.0f;
+const float PlayerState::PITCH = 0.0f;
+const float PlayerState::SPEED = 5.0f;
+const float PlayerState::SENSITIVITY = 0.1f;
+const float PlayerState::MAX_HEALTH = 100.0f;
+const int PlayerState::MAX_SHOTS_BEFORE_RELOAD = 5;
+const float PlayerState::RECOIL_DURATION = 0.18f;
+const float PlayerState::RELOAD_DURATION = 1.5f;
+
+// player movement limits
+const float PlayerState::BOTTOM_LIMIT_X = -Terrain::SIZE / 2;
+const float PlayerState::UPPER_LIMIT_X = Terrain::SIZE / 2;
+const float PlayerState::BOTTOM_LIMIT_Z = -Terrain::SIZE / 2;
+const float PlayerState::UPPER_LIMIT_Z = Terrain::SIZE / 2;
+
+// default drone values
+const float DroneState::MAX_FLOAT_HEIGHT = 4.0f;
+const float DroneState::MIN_FLOAT_HEIGHT = 2.5f;
+const float DroneState::ATTACK_INTERVAL = 2.0f;
+const float DroneState::SPAWN_INTERVAL = 3.0f;
+const float DroneState::EXPLODE_DURATION = 0.25f;
+const float DroneState::DAMAGE = 10.0f;
+const float DroneState::SPEED = 0.02f;
+const float DroneState::SCALE = 0.6f;
+const float DroneState::RANGE = Terrain::SIZE * 2;
@@ -0,0 +1,325 @@
+#include "simulation.h"
+#include "profiler.h"
+
+#include <cmath>
+
+const float Simulation::TIMESTEP = 1.0f / 60.0f;
+const float Simulation::MAX_FRAME_TIME = 0.25f;
+const int Simulation::MAX_DRONES = 3;
+const float Simulation::SPAWN_INTERVAL = 3.0f;
+
+Simulation::Simulation(int maxDrones, float spawnInterval)
+{
+    this->maxDrones = maxDrones;
+    this->spawnInterval = spawnInterval;
+    jobs = nullptr;
+    seed = randomSeed();
+    drones.reserve(maxDrones);
+    reset();
+}
+
+void Simulation::step(const PlayerInput &input)
+{
+    PROFILE_ZONE("Simulation::step");
+    if (!player.isAlive)
+    {
+        return;
+    }
+
+    time += TIMESTEP;
+    tick++;
+    previousPlayer = player;
+
+    // player first, so that drones aim at (and collisions use) the player's new position
+    updatePlayer(input);
+    updateSpawning();
+    updateDrones();
+
+    // collisions between bullet and drones and between lasers and player
+    detector.Detect(player, drones, firing, events, jobs);
+
+    // player dies if no health left
+    /* in case player took a shot while dying, let the recoil finish before
+    dying, otherwise the gun will spawn in a wrongly rotated way after restarting the game */
+    if (player.health <= 0 && !player.shot)
+    {
+        player.isAlive = false;
+        events.push_back({SimEventType::PLAYER_DIED, -1});
+    }
+}
+
+PlayerState Simulation::interpolatePlayer(float alpha) const
+{
+    PlayerState state = player;
+    state.position = glm::mix(previousPlayer.position, player.position, alpha);
+    state.yaw = glm::mix(previousPlayer.yaw, player.yaw, alpha);
+    state.pitch = glm::mix(previousPlayer.pitch, player.pitch, alpha);
+    updatePlayerVectors(state);
+    return state;
+}
+
+void Simulation::setSeed(unsigned int seed)
+{
+    this->seed = seed;
+    reset();
+}
+
+unsigned int Simulation::getSeed() const
+{
+    return seed;
+}
+
+void Simulation::setJobSystem(JobSystem *jobs)
+{
+    this->jobs = jobs;
+}
+
+void Simulation::setObstacles(const std::vector<AABBox> &obstacles)
+{
+    detector.SetObstacles(obstacles);
+}
+
+void Simulation::findDrones(glm::vec3 center, float radius, std::vector<int> &out)
+{
+    detector.FindDrones(center, radius, out);
+}
+
+void Simulation::reset()
+{
+    player = PlayerState();
+    updatePlayerVectors(player);
+    createPlayerBoundingBox();
+    previousPlayer = player;
+
+    drones.clear();
+    detector.Reset();
+    spawnRng = makeRandomStream(seed, RandomStream::DRONE_SPAWN);
+    aimRng = makeRandomStream(seed, RandomStream::DRONE_AIM);
+    spawnTime = 0;
+    time = 0;
+    tick = 0;
+    events.clear();
+}
+
+const std::vector<SimEvent> &Simulation::getEvents() const
+{
+    return events;
+}
+
+void Simulation::clearEvents()
+{
+    events.clear();
+}
+
+void Simulation::updatePlayer(const PlayerInput &input)
+{
+    // movement
+    float velocity = PlayerState::SPEED * TIMESTEP;
+    if (input.forward)
+    {
+        player.position += player.front * velocity;
+    }
+    if (input.backward)
+    {
+        player.position -= player.front * velocity;
+    }
+    if (input.left)
+    {
+        player.position -= player.right * velocity;
+    }
+    if (input.right)
+    {
+        player.position += player.right * velocity;
+    }
+    player.isWalking = input.forward || input.backward || input.left || input.right;
+
+    // make sure player stays at ground level
+    player.position.y = 0;
+
+    // also make sure player stays between the accepted x and z limits
+    player.position.x = glm::clamp(player.position.x, PlayerState::BOTTOM_LIMIT_X, PlayerState::UPPER_LIMIT_X - 1.0f);
+    player.position.z = glm::clamp(player.position.z, PlayerState::BOTTOM_LIMIT_Z, PlayerState::UPPER_LIMIT_Z - 1.0f);
+
+    // looking around
+    player.yaw += input.mouseDX * PlayerState::SENSITIVITY;
+    player.pitch += input.mouseDY * PlayerState::SENSITIVITY;
+
+    // make sure that when pitch is out of bounds, screen doesn't get flipped
+    if (player.pitch > 89.0f)
+    {
+        player.pitch = 89.0f;
+    }
+    if (player.pitch < -44.0f)
+    {
+        player.pitch = -44.0f;
+    }
+    updatePlayerVectors(player);
+
+    // recoil: the gun can not fire again until it is back in base position
+    player.bulletFired = false;
+    if (player.shot)
+    {
+        player.shotTime += TIMESTEP;
+        if (player.shotTime >= PlayerState::RECOIL_DURATION)
+        {
+            player.shot = false;
+            if (player.shotsRemaining == 0)
+            {
+                player.isReloading = true;
+                player.reloadTime = 0;
+                events.push_back({SimEventType::RELOAD_STARTED, -1});
+            }
+        }
+    }
+
+    // reload
+    if (player.isReloading)
+    {
+        player.reloadTime += TIMESTEP;
+        if (player.reloadTime >= PlayerState::RELOAD_DURATION)
+        {
+            player.isReloading = false;
+            player.shotsRemaining = PlayerState::MAX_SHOTS_BEFORE_RELOAD;
+        }
+    }
+
+    // player shoots gun
+    if (input.shoot && !player.shot && !player.isReloading && player.shotsRemaining > 0)
+    {
+        player.shotsRemaining--;
+        player.shot = true;
+        player.bulletFired = true;
+        player.shotTime = 0;
+        events.push_back({SimEventType::PLAYER_SHOT, -1});
+    }
+
+    createPlayerBoundingBox();
+}
+
+void Simulation::updateSpawning()
+{
+    if (drones.count() >= maxDrones)
+    {
+        return;
+    }
+
+    // horde mode: everyone joins at once
+    if (spawnInterval <= 0)
+    {
+        while (drones.count() < maxDrones)
+        {
+            drones.spawn(generateDronePosition());
+        }
+        return;
+    }
+
+    spawnTime += TIMESTEP;
+    if (spawnTime >= spawnInterval)
+    {
+        drones.spawn(generateDronePosition());
+        spawnTime = 0;
+    }
+}
+
+void Simulation::updateDrones()
+{
+    int slots = drones.slots();
+
+    // move living drones towards the player, update their bounding boxes and timers
+    // (every slot only touches its own data, so chunks can run on any thread)
+    glm::vec3 playerPos = player.position;
+    runParallel(jobs, 0, slots, 0, [this, playerPos](int begin, int end)
+                {
+                    drones.storePrevious(begin, end);
+                    drones.moveToPlayer(playerPos, DroneState::SPEED, begin, end);
+                    drones.calculateBoundingBoxes(begin, end);
+                    drones.advanceTimers(TIMESTEP, begin, end); });
+
+    // gather the drones that attack or spawn again this tick (in slot order, so events are ordered)
+    firing.clear();
+    aimOffset.clear();
+    for (int i = 0; i < slots; i++)
+    {
+        if (drones.flags[i] == DroneSwarm::FLAG_FIRED)
+        {
+            firing.push_back(i);
+            aimOffset.push_back(generateAimOffset());
+            events.push_back({SimEventType::LASER_FIRED, i});
+        }
+        else if (drones.flags[i] == DroneSwarm::FLAG_RESPAWNED)
+        {
+            drones.respawn(i, generateDronePosition());
+            events.push_back({SimEventType::DRONE_RESPAWNED, i});
+        }
+    }
+
+    // aim the lasers of the attacking drones
+    drones.calculateLaserDirections(firing.data(), aimOffset.data(), static_cast<int>(firing.size()), player.position);
+}
+
+void Simulation::updatePlayerVectors(PlayerState &state)
+{
+    // calculate the new Front vector
+    glm::vec3 front;
+    front.x = cos(glm::radians(state.yaw)) * cos(glm::radians(state.pitch));
+    front.y = sin(glm::radians(state.pitch));
+    front.z = sin(glm::radians(state.yaw)) * cos(glm::radians(state.pitch));
+    state.front = glm::normalize(front);
+
+    // also re-calculate the Right and Up vector
+    state.right = glm::normalize(glm::cross(state.front, glm::vec3(0.0f, 1.0f, 0.0f)));
+    state.up = glm::normalize(glm::cross(state.right, state.front));
+}
+
+void Simulation::createPlayerBoundingBox()
+{
+    // create the min and max bound
+    glm::vec3 vmin = {player.position.x - 0.3f, player.position.y - 1.0f, player.position.z - 0.6f};
+    glm::vec3 vmax = {player.position.x + 0.3f, player.position.y + 0.5f, player.position.z};
+
+    // create bounding box (it's a cuboid; see docs/player_bbox for a visualization)
+    player.boundingBox = AABBox(vmin, vmax);
+}
+
+glm::vec3 Simulation::generateDronePosition()
+{
+    // define the range for x and z axis
+    const int xzMin = static_cast<int>(-Terrain::SIZE) + 2;
+    const int xzMax = static_cast<int>(Terrain::SIZE) - 2;
+
+    float posX = randomInt(spawnRng, xzMin, xzMax); // generate x position
+    float posZ = randomInt(spawnRng, xzMin, xzMax); // generate z position
+
+    // add limitation: drone can not spawn in the inner square of the terrain square
+    if (posX > -Terrain::SIZE / 2 && posX < Terrain::SIZE / 2)
+    {
+        if (posX < 0)
+        {
+            posX = -Terrain::SIZE / 2;
+        }
+        else
+        {
+            posX = Terrain::SIZE / 2;
+        }
+    }
+    if (posZ > -Terrain::SIZE / 2 && posZ < Terrain::SIZE / 2)
+    {
+        if (posZ < 0)
+        {
+            posZ = -Terrain::SIZE / 2;
+        }
+        else
+        {
+            posZ = Terrain::SIZE / 2;
+        }
+    }
+
+    float posY = randomInt(spawnRng, static_cast<int>(DroneState::MIN_FLOAT_HEIGHT), static_cast<int>(DroneState::MAX_FLOAT_HEIGHT));
+    return glm::vec3(posX, posY, posZ);
+}
+
+float Simulation::generateAimOffset()
+{
+    // random offset between min and max (otherwise the drone's aim would too good)
+    return randomFloat(aimRng, -0.1f, 0.1f);
+}
@@ -1,4 +1,6 @@
 #include "skybox.h"
+#include "gl_state.h"
+#include "resource_registry.h"
 
 SkyBox::SkyBox(){};
 
@@ -7,25 +9,23 @@ SkyBox::SkyBox(std::vector< std::string > filenames, std::string dirName)
     this->filenames = filenames;
     this->dirName = dirName;
 
-    skyboxTexture = 8; // skybox texture ID
-
     configureSkybox();
 }
 
-void SkyBox::Draw(Shader &shader, glm::mat4 cameraView, glm::mat4 projection)
+void SkyBox::Draw(Shader &shader)
 {
-    // set uniforms
+    // the camera matrices come from the camera uniform buffer, the shader removes the translation from the view matrix
     shader.use();
-    glm::mat4 view = glm::mat4(glm::mat3(cameraView)); // remove translation from the view matrix
-    shader.setMat4("view", view);
-    shader.setMat4("projection", projection);
 
     // bind texture and draw
-    glBindVertexArray(VAO);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, skyboxTexture);
+    GLState::bindVertexArray(VAO.get());
+    GLState::bindTexture(0, GL_TEXTURE_CUBE_MAP, skyboxTexture->id);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    glBindVertexArray(0);
+}
+
+std::size_t SkyBox::getGpuBytes() const
+{
+    return (skyboxTexture ? skyboxTexture->bytes : 0) + skyboxVertices.size() * sizeof(float);
 }
 
 void SkyBox::configureSkybox()
@@ -33,24 +33,29 @@ void SkyBox::configureSkybox()
     skyboxVertices = getSkyboxVertexData();
 
     // configure buffer/array
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
+    VAO.create();
+    VBO.create();
+    GLState::bindVertexArray(VAO.get());
     // load vertex data into vertex buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.get());
     glBufferData(GL_ARRAY_BUFFER, skyboxVertices.size()*sizeof(float), &skyboxVertices[0], GL_STATIC_DRAW);
     // set the vertex attribute pointer
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
 
-    // load skybox texture, but first create vector containing paths to skybox textures
+    // load skybox texture (or share it if it is loaded already)
+    skyboxTexture = ResourceRegistry::getCubemap(getFacePaths(filenames, dirName));
+}
+
+std::vector<std::string> SkyBox::getFacePaths(const std::vector<std::string> &filenames, const std::string &dirName)
+{
     std::vector< std::string > faces;
     for (unsigned int i = 0; i < filenames.size(); i++)
     {
         std::string s = dirName + "/" + filenames[i];
         faces.push_back(s);
     }
-    loadCubemap(faces, skyboxTexture);
+    return faces;
 }
 
 std::vector<float> SkyBox::getSkyboxVertexData()
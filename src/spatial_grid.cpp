@@ -0,0 +1,339 @@
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SpatialGrid::SpatialGrid(glm::vec3 min, glm::vec3 max, float cellSize)
+{
+    this->origin = min;
+    this->cellSize = cellSize;
+    inverseCellSize = 1.0f / cellSize;
+    dims = glm::max(glm::ivec3(glm::ceil((max - min) / cellSize)), glm::ivec3(1));
+    cells.resize(dims.x * dims.y * dims.z);
+    stamp = 0;
+}
+
+void SpatialGrid::insert(int id, glm::vec3 min, glm::vec3 max)
+{
+    grow(id);
+    glm::ivec3 cellMin = cellCoords(min);
+    glm::ivec3 cellMax = cellCoords(max);
+    items[id].min = min;
+    items[id].max = max;
+
+    // still in the same cells, nothing to do
+    if (items[id].used && !items[id].isRay && items[id].cellMin == cellMin && items[id].cellMax == cellMax)
+    {
+        return;
+    }
+
+    removeFromCells(id);
+    Item &item = items[id];
+    item.used = true;
+    item.isRay = false;
+    item.cellMin = cellMin;
+    item.cellMax = cellMax;
+    for (int z = cellMin.z; z <= cellMax.z; z++)
+    {
+        for (int y = cellMin.y; y <= cellMax.y; y++)
+        {
+            for (int x = cellMin.x; x <= cellMax.x; x++)
+            {
+                addToCell(id, cellIndex(glm::ivec3(x, y, z)));
+            }
+        }
+    }
+}
+
+bool SpatialGrid::update(int id, glm::vec3 min, glm::vec3 max)
+{
+    Item &item = items[id];
+    item.min = min;
+    item.max = max;
+    return !item.used || item.isRay || item.cellMin != cellCoords(min) || item.cellMax != cellCoords(max);
+}
+
+void SpatialGrid::reserve(int count)
+{
+    if (count > 0)
+    {
+        grow(count - 1);
+    }
+}
+
+void SpatialGrid::insertRay(int id, glm::vec3 orig, glm::vec3 dir, float length)
+{
+    grow(id);
+    removeFromCells(id);
+    Item &item = items[id];
+    item.used = true;
+    item.isRay = true;
+
+    scratch.clear();
+    rayCells(orig, dir, length, scratch);
+    for (int cell : scratch)
+    {
+        addToCell(id, cell);
+    }
+}
+
+void SpatialGrid::remove(int id)
+{
+    if (!contains(id))
+    {
+        return;
+    }
+    removeFromCells(id);
+    items[id].used = false;
+}
+
+void SpatialGrid::clear()
+{
+    for (std::vector<Entry> &cell : cells)
+    {
+        cell.clear();
+    }
+    for (size_t id = 0; id < items.size(); id++)
+    {
+        items[id].used = false;
+        itemCells[id].clear();
+        itemPositions[id].clear();
+    }
+}
+
+bool SpatialGrid::contains(int id) const
+{
+    return id >= 0 && id < static_cast<int>(items.size()) && items[id].used;
+}
+
+void SpatialGrid::queryRay(glm::vec3 orig, glm::vec3 dir, float length, std::vector<int> &out)
+{
+    nextStamp();
+    scratch.clear();
+    rayCells(orig, dir, length, scratch);
+    for (int cell : scratch)
+    {
+        for (const Entry &entry : cells[cell])
+        {
+            if (stamps[entry.item] != stamp)
+            {
+                stamps[entry.item] = stamp;
+                out.push_back(entry.item);
+            }
+        }
+    }
+}
+
+void SpatialGrid::queryRadius(glm::vec3 center, float radius, std::vector<int> &out)
+{
+    nextStamp();
+    glm::ivec3 cellMin = cellCoords(center - radius);
+    glm::ivec3 cellMax = cellCoords(center + radius);
+    for (int z = cellMin.z; z <= cellMax.z; z++)
+    {
+        for (int y = cellMin.y; y <= cellMax.y; y++)
+        {
+            for (int x = cellMin.x; x <= cellMax.x; x++)
+            {
+                for (const Entry &entry : cells[cellIndex(glm::ivec3(x, y, z))])
+                {
+                    if (stamps[entry.item] == stamp)
+                    {
+                        continue;
+                    }
+                    stamps[entry.item] = stamp;
+
+                    // distance between the center and the closest point of the box
+                    const Item &item = items[entry.item];
+                    if (!item.isRay)
+                    {
+                        glm::vec3 closest = glm::clamp(center, item.min, item.max);
+                        glm::vec3 d = closest - center;
+                        if (glm::dot(d, d) > radius * radius)
+                        {
+                            continue;
+                        }
+                    }
+                    out.push_back(entry.item);
+                }
+            }
+        }
+    }
+}
+
+void SpatialGrid::queryBox(glm::vec3 min, glm::vec3 max, std::vector<int> &out)
+{
+    nextStamp();
+    glm::ivec3 cellMin = cellCoords(min);
+    glm::ivec3 cellMax = cellCoords(max);
+    for (int z = cellMin.z; z <= cellMax.z; z++)
+    {
+        for (int y = cellMin.y; y <= cellMax.y; y++)
+        {
+            for (int x = cellMin.x; x <= cellMax.x; x++)
+            {
+                for (const Entry &entry : cells[cellIndex(glm::ivec3(x, y, z))])
+                {
+                    if (stamps[entry.item] == stamp)
+                    {
+                        continue;
+                    }
+                    stamps[entry.item] = stamp;
+
+                    const Item &item = items[entry.item];
+                    if (!item.isRay && (glm::any(glm::lessThan(item.max, min)) || glm::any(glm::greaterThan(item.min, max))))
+                    {
+                        continue;
+                    }
+                    out.push_back(entry.item);
+                }
+            }
+        }
+    }
+}
+
+glm::ivec3 SpatialGrid::cellCoords(glm::vec3 point) const
+{
+    // truncating instead of flooring is fine here: negative coordinates are clamped to cell 0 either way
+    glm::vec3 p = (point - origin) * inverseCellSize;
+    return glm::ivec3(std::min(std::max(static_cast<int>(p.x), 0), dims.x - 1),
+                      std::min(std::max(static_cast<int>(p.y), 0), dims.y - 1),
+                      std::min(std::max(static_cast<int>(p.z), 0), dims.z - 1));
+}
+
+int SpatialGrid::cellIndex(glm::ivec3 coords) const
+{
+    return (coords.z * dims.y + coords.y) * dims.x + coords.x;
+}
+
+void SpatialGrid::grow(int id)
+{
+    if (id >= static_cast<int>(items.size()))
+    {
+        // grow geometrically, ids usually arrive one by one
+        size_t size = std::max(static_cast<size_t>(id) + 1, items.size() * 2);
+        items.resize(size);
+        itemCells.resize(size);
+        itemPositions.resize(size);
+        stamps.resize(size, 0);
+    }
+}
+
+void SpatialGrid::addToCell(int id, int cell)
+{
+    cells[cell].push_back({id, static_cast<int>(itemCells[id].size())});
+    itemCells[id].push_back(cell);
+    itemPositions[id].push_back(static_cast<int>(cells[cell].size()) - 1);
+}
+
+void SpatialGrid::removeFromCells(int id)
+{
+    std::vector<int> &cellList = itemCells[id];
+    for (size_t i = 0; i < cellList.size(); i++)
+    {
+        // swap with the last entry of the cell and fix the position stored by the moved item
+        std::vector<Entry> &cell = cells[cellList[i]];
+        int position = itemPositions[id][i];
+        Entry moved = cell.back();
+        cell[position] = moved;
+        itemPositions[moved.item][moved.index] = position;
+        cell.pop_back();
+    }
+    cellList.clear();
+    itemPositions[id].clear();
+}
+
+void SpatialGrid::nextStamp()
+{
+    stamp++;
+    if (stamp == 0)
+    {
+        // wrapped around, forget all old stamps
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stamp = 1;
+    }
+}
+
+void SpatialGrid::rayCells(glm::vec3 orig, glm::vec3 dir, float length, std::vector<int> &out) const
+{
+    float dirLength = glm::length(dir);
+    if (dirLength == 0 || length <= 0)
+    {
+        return;
+    }
+    dir /= dirLength;
+
+    // clip the ray against the grid area (slab test)
+    const float infinity = std::numeric_limits<float>::infinity();
+    glm::vec3 gridMax = origin + glm::vec3(dims) * cellSize;
+    float tEnter = 0.0f;
+    float tExit = length;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (dir[axis] == 0)
+        {
+            if (orig[axis] < origin[axis] || orig[axis] > gridMax[axis])
+            {
+                return;
+            }
+            continue;
+        }
+        float t0 = (origin[axis] - orig[axis]) / dir[axis];
+        float t1 = (gridMax[axis] - orig[axis]) / dir[axis];
+        tEnter = std::max(tEnter, std::min(t0, t1));
+        tExit = std::min(tExit, std::max(t0, t1));
+    }
+    if (tEnter > tExit)
+    {
+        return;
+    }
+
+    // cell where the ray enters the grid
+    glm::vec3 start = orig + dir * tEnter;
+    glm::ivec3 cell = cellCoords(start);
+
+    // per axis: direction of the steps, distance along the ray between two cell borders
+    // and distance along the ray to the next cell border
+    glm::ivec3 step;
+    glm::vec3 tDelta, tMax;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (dir[axis] > 0)
+        {
+            step[axis] = 1;
+            tDelta[axis] = cellSize / dir[axis];
+            tMax[axis] = tEnter + (origin[axis] + (cell[axis] + 1) * cellSize - start[axis]) / dir[axis];
+        }
+        else if (dir[axis] < 0)
+        {
+            step[axis] = -1;
+            tDelta[axis] = -cellSize / dir[axis];
+            tMax[axis] = tEnter + (origin[axis] + cell[axis] * cellSize - start[axis]) / dir[axis];
+        }
+        else
+        {
+            step[axis] = 0;
+            tDelta[axis] = infinity;
+            tMax[axis] = infinity;
+        }
+    }
+
+    while (true)
+    {
+        out.push_back(cellIndex(cell));
+
+        // step into the neighbouring cell whose border is closest
+        int axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+        if (tMax[axis] > tExit)
+        {
+            return;
+        }
+        cell[axis] += step[axis];
+        if (cell[axis] < 0 || cell[axis] >= dims[axis])
+        {
+            return;
+        }
+        tMax[axis] += tDelta[axis];
+    }
+}
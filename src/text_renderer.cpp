@@ -1,27 +1,195 @@
 #include "text_renderer.h"
+#include "gl_state.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+const int TextRenderer::ATLAS_WIDTH = 1024;
+const int TextRenderer::GLYPH_SIZE = 48;
+const int TextRenderer::SDF_SPREAD = 8;
+const float TextRenderer::BORDER_SIZE = 2.0f;
+
+// empty pixels around every glyph in the atlas, so linear filtering never picks up a neighbouring glyph
+static const int ATLAS_PADDING = 2;
+
+// cache file header
+static const char CACHE_MAGIC[4] = {'D', 'S', 'D', 'F'};
+static const int CACHE_VERSION = 1;
+
+// FNV-1a hash of a file's contents (0 if it can not be read), so a changed font invalidates the cache
+static unsigned long long hashFile(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return 0;
+    }
+    unsigned long long hash = 14695981039346656037ULL;
+    char buffer[4096];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+    {
+        for (std::streamsize i = 0; i < file.gcount(); i++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(buffer[i])) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+/*
+Squared euclidean distance transform of one row or column (Felzenszwalb & Huttenlocher):
+f holds 0 for feature pixels and a large value elsewhere, d is set to the squared distance to the nearest feature.
+v and z are scratch arrays of size n and n + 1.
+*/
+static void distanceTransform1D(const float *f, int n, float *d, int *v, float *z)
+{
+    const float infinity = 1e20f;
+    int k = 0;
+    v[0] = 0;
+    z[0] = -infinity;
+    z[1] = infinity;
+    for (int q = 1; q < n; q++)
+    {
+        float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+        while (s <= z[k])
+        {
+            k--;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0f * q - 2.0f * v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = infinity;
+    }
+    k = 0;
+    for (int q = 0; q < n; q++)
+    {
+        while (z[k + 1] < q)
+        {
+            k++;
+        }
+        d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+// squared distance of every pixel to the nearest pixel where feature is true (columns first, then rows)
+static std::vector<float> distanceTransform(const std::vector<bool> &feature, int width, int height)
+{
+    const float infinity = 1e20f;
+    int n = std::max(width, height);
+    std::vector<float> grid(width * height), f(n), d(n), z(n + 1);
+    std::vector<int> v(n);
+    for (int i = 0; i < width * height; i++)
+    {
+        grid[i] = feature[i] ? 0.0f : infinity;
+    }
+    for (int x = 0; x < width; x++)
+    {
+        for (int y = 0; y < height; y++) f[y] = grid[y * width + x];
+        distanceTransform1D(f.data(), height, d.data(), v.data(), z.data());
+        for (int y = 0; y < height; y++) grid[y * width + x] = d[y];
+    }
+    for (int y = 0; y < height; y++)
+    {
+        distanceTransform1D(&grid[y * width], width, d.data(), v.data(), z.data());
+        std::copy(d.begin(), d.begin() + width, grid.begin() + y * width);
+    }
+    return grid;
+}
+
+/*
+Turns a rendered glyph (coverage per pixel) into a distance field with SDF_SPREAD pixels of room on every side.
+The signed distance to the outline is estimated from the distance to the nearest pixel on the other side of it
+(minus half a pixel), and from the coverage for pixels the outline passes through.
+It is stored as 0.5 - distance / (2 * SDF_SPREAD): 0.5 on the outline, more inside, less outside.
+*/
+static std::vector<unsigned char> glyphDistanceField(const FT_Bitmap &bmp, int spread, int &width, int &height)
+{
+    width = static_cast<int>(bmp.width) + 2 * spread;
+    height = static_cast<int>(bmp.rows) + 2 * spread;
+    std::vector<float> coverage(width * height, 0.0f);
+    for (unsigned int row = 0; row < bmp.rows; row++)
+    {
+        for (unsigned int col = 0; col < bmp.width; col++)
+        {
+            coverage[(row + spread) * width + col + spread] = bmp.buffer[row * bmp.pitch + col] / 255.0f;
+        }
+    }
+
+    std::vector<bool> inside(width * height), outside(width * height);
+    for (int i = 0; i < width * height; i++)
+    {
+        inside[i] = coverage[i] >= 0.5f;
+        outside[i] = !inside[i];
+    }
+    std::vector<float> toInside = distanceTransform(inside, width, height);
+    std::vector<float> toOutside = distanceTransform(outside, width, height);
+
+    std::vector<unsigned char> field(width * height);
+    for (int i = 0; i < width * height; i++)
+    {
+        float distance; // positive outside the glyph
+        if (coverage[i] > 0.0f && coverage[i] < 1.0f)
+        {
+            distance = 0.5f - coverage[i];
+        }
+        else if (inside[i])
+        {
+            distance = -(std::sqrt(toOutside[i]) - 0.5f);
+        }
+        else
+        {
+            distance = std::sqrt(toInside[i]) - 0.5f;
+        }
+        float value = 0.5f - distance / (2.0f * spread);
+        field[i] = static_cast<unsigned char>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+    }
+    return field;
+}
 
 TextRenderer::TextRenderer(std::string pathToFont, std::string pathVertexShader, std::string pathFragmentShader)
 {
     this->font = pathToFont;
     blink = 0;
+    atlasTexture = 0;
+    bufferCapacity = 0;
+    projection = glm::mat4(1.0f);
+    batchProjection = glm::mat4(1.0f);
 
     // compile shader
     shader = Shader(pathVertexShader.c_str(), pathFragmentShader.c_str());
 
-    // All functions return a value different than 0 whenever an error occurred
-    if (FT_Init_FreeType(&ft))
-    {
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-    }
-
     // find path to font
     if (font.empty())
     {
         std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
     }
 
-    // load font as face
-    loadFace();
+    // glyph atlas: from the cache if it was made from this font, otherwise generated (and cached for the next start)
+    std::vector<unsigned char> atlas;
+    int atlasHeight = 0;
+    std::string cachePath = font + ".sdf";
+    unsigned long long fontHash = hashFile(font);
+    if (!loadCache(cachePath, fontHash, atlas, atlasHeight) && loadFace(atlas, atlasHeight))
+    {
+        saveCache(cachePath, fontHash, atlas, atlasHeight);
+    }
+
+    if (atlasHeight > 0)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glGenTextures(1, &atlasTexture);
+        GLState::bindTexture(0, GL_TEXTURE_2D, atlasTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, ATLAS_WIDTH, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        GLState::bindTexture(0, GL_TEXTURE_2D, 0);
+    }
 
     // configure VAO and VBO
     configBuffers();
@@ -29,64 +197,24 @@ TextRenderer::TextRenderer(std::string pathToFont, std::string pathVertexShader,
 
 void TextRenderer::RenderText(std::string_view text, float x, float y, float scale, glm::vec3 color)
 {
-    GLboolean depthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean depthMask;
-    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
-
-    // set OpenGL state
-    glDisable(GL_DEPTH_TEST);
-    glDepthMask(GL_FALSE);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    prepareBatch();
+    addQuads(batch, text, x, y, scale, color, color, 0.0f);
+}
 
-    // activate corresponding render state
-    shader.use();
-    glUniformMatrix4fv(glGetUniformLocation(shader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-    glUniform3f(glGetUniformLocation(shader.ID, "textColor"), color.x, color.y, color.z);
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(VAO);
-
-    // iterate through all characters
-    std::string_view::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++)
-    {
-        const Character ch = characters[*c - 32];
+void TextRenderer::LayoutText(std::vector<TextVertex> &vertices, std::string_view text, float x, float y, float scale, glm::vec3 color) const
+{
+    addQuads(vertices, text, x, y, scale, color, color, 0.0f);
+}
 
-        float xpos = x + ch.Bearing.x * scale;
-        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
+void TextRenderer::LayoutTextBordered(std::vector<TextVertex> &vertices, std::string_view text, float x, float y, float scale, glm::vec3 fillColor, glm::vec3 borderColor) const
+{
+    addQuads(vertices, text, x, y, scale, fillColor, borderColor, BORDER_SIZE / (2.0f * SDF_SPREAD));
+}
 
-        float w = ch.Size.x * scale;
-        float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            {xpos, ypos + h, 0.0f, 0.0f},
-            {xpos, ypos, 0.0f, 1.0f},
-            {xpos + w, ypos, 1.0f, 1.0f},
-
-            {xpos, ypos + h, 0.0f, 0.0f},
-            {xpos + w, ypos, 1.0f, 1.0f},
-            {xpos + w, ypos + h, 1.0f, 0.0f}};
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
-    }
-    // reset
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glDisable(GL_BLEND);
-    glDepthMask(depthMask);
-    if (depthTestEnabled)
-    {
-        glEnable(GL_DEPTH_TEST);
-    }
+void TextRenderer::RenderVertices(const std::vector<TextVertex> &vertices)
+{
+    prepareBatch();
+    batch.insert(batch.end(), vertices.begin(), vertices.end());
 }
 
 float TextRenderer::MeasureText(std::string_view text, float scale) const
@@ -103,191 +231,245 @@ float TextRenderer::MeasureText(std::string_view text, float scale) const
     return width;
 }
 
-// Border stroke width in FreeType's 26.6 fixed-point format
-// (64 units = 1 pixel). FreeType uses this representation to
-// achieve sub-pixel precision for smoother text rendering.
-// A stroke radius of 2 pixels therefore becomes 2 * 64 = 128 units.
-static constexpr int BORDER_STROKE_RADIUS = 2 * 64; 
-
-static void uploadGlyphTexture(unsigned int &texID, const FT_Bitmap &bmp)
-{
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED,
-                 bmp.width, bmp.rows, 0,
-                 GL_RED, GL_UNSIGNED_BYTE, bmp.buffer);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-}
-
-void TextRenderer::loadFace()
+bool TextRenderer::loadFace(std::vector<unsigned char> &atlas, int &atlasHeight)
 {
+    // All functions return a value different than 0 whenever an error occurred
+    if (FT_Init_FreeType(&ft))
+    {
+        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+        return false;
+    }
     if (FT_New_Face(ft, font.c_str(), 0, &face))
     {
         std::cout << "ERROR::FREETYPE: Failed to load font as face" << std::endl;
-        return;
+        FT_Done_FreeType(ft);
+        return false;
     }
 
-    FT_Set_Pixel_Sizes(face, 0, 48);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    // set up stroker for border glyphs
-    FT_Stroker stroker;
-    FT_Stroker_New(ft, &stroker);
-    FT_Stroker_Set(stroker, BORDER_STROKE_RADIUS,
-                   FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+    FT_Set_Pixel_Sizes(face, 0, GLYPH_SIZE);
 
+    // render every glyph and turn it into a distance field
+    std::vector<std::vector<unsigned char>> fields(95);
     for (unsigned char c = 32; c < 127; c++)
     {
-        // load as vector outline so the stroker can work with it
-        if (FT_Load_Char(face, c, FT_LOAD_NO_BITMAP))
+        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
         {
             std::cout << "ERROR::FREETYPE: Failed to load glyph" << std::endl;
+            characters[c - 32] = {glm::vec2(0.0f), glm::vec2(0.0f), glm::ivec2(0), glm::ivec2(0), 0};
             continue;
         }
 
-        unsigned int fillAdvance = static_cast<unsigned int>(face->glyph->advance.x);
-
-        // save a copy of the outline before rendering destroys it
-        FT_Glyph outlineGlyph;
-        FT_Get_Glyph(face->glyph, &outlineGlyph);
-
-        // fill glyph
-        FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
-        unsigned int fillTex;
-        uploadGlyphTexture(fillTex, face->glyph->bitmap);
+        int width = 0, height = 0;
+        const FT_Bitmap &bmp = face->glyph->bitmap;
+        if (bmp.width > 0 && bmp.rows > 0)
+        {
+            fields[c - 32] = glyphDistanceField(bmp, SDF_SPREAD, width, height);
+        }
         characters[c - 32] = {
-            fillTex,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left,  face->glyph->bitmap_top),
-            fillAdvance
+            glm::vec2(0.0f),
+            glm::vec2(0.0f),
+            glm::ivec2(width, height),
+            glm::ivec2(face->glyph->bitmap_left - SDF_SPREAD, face->glyph->bitmap_top + SDF_SPREAD),
+            static_cast<unsigned int>(face->glyph->advance.x)
         };
+    }
 
-        // border glyph
-        // FT_Glyph_Stroke modifies outlineGlyph in place; destroy=true frees input on success
-        if (FT_Glyph_Stroke(&outlineGlyph, stroker, true) == 0)
+    FT_Done_Face(face);
+    FT_Done_FreeType(ft);
+
+    // pack the glyphs in rows (shelves) from left to right, a new row starts when a glyph does not fit anymore
+    std::vector<glm::ivec2> positions(95);
+    int x = ATLAS_PADDING;
+    int y = ATLAS_PADDING;
+    int rowHeight = 0;
+    for (int i = 0; i < 95; i++)
+    {
+        if (x + characters[i].Size.x + ATLAS_PADDING > ATLAS_WIDTH)
         {
-            FT_Glyph_To_Bitmap(&outlineGlyph, FT_RENDER_MODE_NORMAL, nullptr, true);
-            FT_BitmapGlyph borderBmp = reinterpret_cast<FT_BitmapGlyph>(outlineGlyph);
-            unsigned int borderTex;
-            uploadGlyphTexture(borderTex, borderBmp->bitmap);
-            borderCharacters[c - 32] = {
-                borderTex,
-                glm::ivec2(borderBmp->bitmap.width, borderBmp->bitmap.rows),
-                glm::ivec2(borderBmp->left,          borderBmp->top),
-                fillAdvance
-            };
-            FT_Done_Glyph(outlineGlyph);
+            x = ATLAS_PADDING;
+            y += rowHeight + ATLAS_PADDING;
+            rowHeight = 0;
         }
-        else
+        positions[i] = glm::ivec2(x, y);
+        x += characters[i].Size.x + ATLAS_PADDING;
+        rowHeight = std::max(rowHeight, characters[i].Size.y);
+    }
+    atlasHeight = y + rowHeight + ATLAS_PADDING;
+
+    atlas.assign(ATLAS_WIDTH * atlasHeight, 0);
+    for (int i = 0; i < 95; i++)
+    {
+        Character &ch = characters[i];
+        for (int row = 0; row < ch.Size.y; row++)
         {
-            // no outline to stroke (e.g. space) —> fall back to fill metrics
-            FT_Done_Glyph(outlineGlyph);
-            borderCharacters[c - 32] = characters[c - 32];
+            std::copy(fields[i].begin() + row * ch.Size.x, fields[i].begin() + (row + 1) * ch.Size.x,
+                      atlas.begin() + (positions[i].y + row) * ATLAS_WIDTH + positions[i].x);
         }
+        ch.UVMin = glm::vec2(positions[i]) / glm::vec2(ATLAS_WIDTH, atlasHeight);
+        ch.UVMax = glm::vec2(positions[i] + ch.Size) / glm::vec2(ATLAS_WIDTH, atlasHeight);
     }
+    return true;
+}
 
-    glBindTexture(GL_TEXTURE_2D, 0);
-    FT_Stroker_Done(stroker);
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+// the cache is a plain memory dump (it is only read on the machine that wrote it); it is regenerated if anything differs
+bool TextRenderer::loadCache(const std::string &path, unsigned long long fontHash, std::vector<unsigned char> &atlas, int &atlasHeight)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file || fontHash == 0)
+    {
+        return false;
+    }
+
+    char magic[4];
+    int version = 0, glyphSize = 0, spread = 0, width = 0, height = 0;
+    unsigned long long hash = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    file.read(reinterpret_cast<char *>(&hash), sizeof(hash));
+    file.read(reinterpret_cast<char *>(&glyphSize), sizeof(glyphSize));
+    file.read(reinterpret_cast<char *>(&spread), sizeof(spread));
+    file.read(reinterpret_cast<char *>(&width), sizeof(width));
+    file.read(reinterpret_cast<char *>(&height), sizeof(height));
+    if (!file || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 || version != CACHE_VERSION || hash != fontHash ||
+        glyphSize != GLYPH_SIZE || spread != SDF_SPREAD || width != ATLAS_WIDTH || height <= 0)
+    {
+        return false;
+    }
+
+    Character cached[95];
+    atlas.resize(static_cast<size_t>(width) * height);
+    file.read(reinterpret_cast<char *>(cached), sizeof(cached));
+    file.read(reinterpret_cast<char *>(atlas.data()), atlas.size());
+    if (!file)
+    {
+        return false;
+    }
+    std::copy(cached, cached + 95, characters);
+    atlasHeight = height;
+    return true;
+}
+
+void TextRenderer::saveCache(const std::string &path, unsigned long long fontHash, const std::vector<unsigned char> &atlas, int atlasHeight) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file || fontHash == 0)
+    {
+        std::cout << "ERROR::TEXT_RENDERER: Could not write glyph cache " << path << std::endl;
+        return;
+    }
+    file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    file.write(reinterpret_cast<const char *>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+    file.write(reinterpret_cast<const char *>(&fontHash), sizeof(fontHash));
+    file.write(reinterpret_cast<const char *>(&GLYPH_SIZE), sizeof(GLYPH_SIZE));
+    file.write(reinterpret_cast<const char *>(&SDF_SPREAD), sizeof(SDF_SPREAD));
+    file.write(reinterpret_cast<const char *>(&ATLAS_WIDTH), sizeof(ATLAS_WIDTH));
+    file.write(reinterpret_cast<const char *>(&atlasHeight), sizeof(atlasHeight));
+    file.write(reinterpret_cast<const char *>(characters), sizeof(characters));
+    file.write(reinterpret_cast<const char *>(atlas.data()), atlas.size());
 }
 
 void TextRenderer::RenderTextBordered(std::string_view text, float x, float y, float scale, glm::vec3 fillColor, glm::vec3 borderColor)
 {
-    GLboolean depthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean depthMask;
-    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
-
-    glDisable(GL_DEPTH_TEST);
-    glDepthMask(GL_FALSE);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    shader.use();
-    glUniformMatrix4fv(glGetUniformLocation(shader.ID, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(VAO);
-
-    // pass 1: border (rendered first so fill sits nicely on top)
-    glUniform3f(glGetUniformLocation(shader.ID, "textColor"), borderColor.x, borderColor.y, borderColor.z);
-    float cx = x;
-    for (auto c = text.begin(); c != text.end(); c++)
+    prepareBatch();
+    LayoutTextBordered(batch, text, x, y, scale, fillColor, borderColor);
+}
+
+void TextRenderer::prepareBatch()
+{
+    // the batch is drawn with one projection matrix
+    if (!batch.empty() && projection != batchProjection)
     {
-        const Character &fill   = characters[*c - 32];
-        const Character &border = borderCharacters[*c - 32];
-
-        float xpos = cx + border.Bearing.x * scale;
-        float ypos = y  - (border.Size.y - border.Bearing.y) * scale;
-        float w = border.Size.x * scale;
-        float h = border.Size.y * scale;
-        
-        // verts array defines the rectangle where one character texture is drawn:
-        float verts[6][4] = {
-            {xpos,     ypos + h, 0.0f, 0.0f},
-            {xpos,     ypos,     0.0f, 1.0f},
-            {xpos + w, ypos,     1.0f, 1.0f},
-            {xpos,     ypos + h, 0.0f, 0.0f},
-            {xpos + w, ypos,     1.0f, 1.0f},
-            {xpos + w, ypos + h, 1.0f, 0.0f}
-        };
-        glBindTexture(GL_TEXTURE_2D, border.TextureID);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        cx += (fill.Advance >> 6) * scale; 
+        Flush();
     }
+    batchProjection = projection;
+}
 
-    // pass 2: fill
-    glUniform3f(glGetUniformLocation(shader.ID, "textColor"), fillColor.x, fillColor.y, fillColor.z);
-    cx = x;
-    for (auto c = text.begin(); c != text.end(); c++)
+void TextRenderer::addQuads(std::vector<TextVertex> &vertices, std::string_view text, float x, float y, float scale, glm::vec3 color, glm::vec3 borderColor, float borderWidth) const
+{
+    for (char c : text)
     {
-        const Character &ch = characters[*c - 32];
+        if (c < 32 || c > 126)
+        {
+            continue;
+        }
+        const Character &ch = characters[c - 32];
 
-        float xpos = cx + ch.Bearing.x * scale;
-        float ypos = y  - (ch.Size.y - ch.Bearing.y) * scale;
+        float xpos = x + ch.Bearing.x * scale;
+        float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
         float w = ch.Size.x * scale;
         float h = ch.Size.y * scale;
 
-        float verts[6][4] = {
-            {xpos,     ypos + h, 0.0f, 0.0f},
-            {xpos,     ypos,     0.0f, 1.0f},
-            {xpos + w, ypos,     1.0f, 1.0f},
-            {xpos,     ypos + h, 0.0f, 0.0f},
-            {xpos + w, ypos,     1.0f, 1.0f},
-            {xpos + w, ypos + h, 1.0f, 0.0f}
-        };
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(verts), verts);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        cx += (ch.Advance >> 6) * scale;
+        // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
+        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
+        if (ch.Size.x == 0 || ch.Size.y == 0)
+        {
+            continue; // nothing to draw (e.g. space)
+        }
+
+        // two triangles, the top of the quad samples the top row of the glyph in the atlas
+        TextVertex topLeft = {glm::vec2(xpos, ypos + h), glm::vec2(ch.UVMin.x, ch.UVMin.y), color, borderColor, borderWidth};
+        TextVertex bottomLeft = {glm::vec2(xpos, ypos), glm::vec2(ch.UVMin.x, ch.UVMax.y), color, borderColor, borderWidth};
+        TextVertex bottomRight = {glm::vec2(xpos + w, ypos), glm::vec2(ch.UVMax.x, ch.UVMax.y), color, borderColor, borderWidth};
+        TextVertex topRight = {glm::vec2(xpos + w, ypos + h), glm::vec2(ch.UVMax.x, ch.UVMin.y), color, borderColor, borderWidth};
+        vertices.insert(vertices.end(), {topLeft, bottomLeft, bottomRight, topLeft, bottomRight, topRight});
+    }
+}
+
+void TextRenderer::Flush()
+{
+    if (batch.empty())
+    {
+        return;
     }
 
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glDisable(GL_BLEND);
-    glDepthMask(depthMask);
-    if (depthTestEnabled)
+    // the depth state is restored afterwards; it is read from GLState, asking OpenGL could make the CPU wait for the driver
+    bool depthTestEnabled = GLState::isEnabled(GL_DEPTH_TEST);
+    bool depthMask = GLState::getDepthMask();
+
+    // set OpenGL state
+    GLState::setEnabled(GL_DEPTH_TEST, false);
+    GLState::depthMask(false);
+    GLState::setEnabled(GL_BLEND, true);
+    GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // activate corresponding render state
+    shader.use();
+    shader.setMat4("projection", batchProjection);
+    GLState::bindTexture(0, GL_TEXTURE_2D, atlasTexture);
+    GLState::bindVertexArray(VAO);
+
+    // upload the batch; the buffer only grows, and is orphaned every flush so the driver never waits for the previous draw
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    if (batch.size() > bufferCapacity)
     {
-        glEnable(GL_DEPTH_TEST);
+        bufferCapacity = std::max(batch.size(), 2 * bufferCapacity);
     }
+    glBufferData(GL_ARRAY_BUFFER, bufferCapacity * sizeof(TextVertex), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, batch.size() * sizeof(TextVertex), batch.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(batch.size()));
+    batch.clear();
+
+    // reset
+    GLState::setEnabled(GL_BLEND, false);
+    GLState::depthMask(depthMask);
+    GLState::setEnabled(GL_DEPTH_TEST, depthTestEnabled);
 }
 
 void TextRenderer::configBuffers()
 {
-    // each 2D quad requires 6 vertices of 4 floats each
+    // quads are added to the batch as 6 vertices (position, texture coordinates, color, border color and width); the buffer is sized by Flush
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
+    GLState::bindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void *)offsetof(TextVertex, Position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void *)offsetof(TextVertex, Color));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(TextVertex), (void *)offsetof(TextVertex, BorderColor)); // border color and width
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bindVertexArray(0);
 }
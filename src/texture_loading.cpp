@@ -1,11 +1,15 @@
 #include "texture_loading.h"
+#include "gl_state.h"
 
-void loadCubemap(std::vector<std::string> faces, unsigned int ID)
+unsigned int loadCubemap(std::vector<std::string> faces, std::size_t *bytes)
 {
+    unsigned int ID;
+    std::size_t size = 0;
     glGenTextures(1, &ID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, ID);
+    GLState::bindTexture(0, GL_TEXTURE_CUBE_MAP, ID);
 
     stbi_set_flip_vertically_on_load(false); 
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // rows of stb_image pixels are tightly packed
     int width, height, nrChannels;
     for (unsigned int i = 0; i < faces.size(); i++)
     {
@@ -13,6 +17,7 @@ void loadCubemap(std::vector<std::string> faces, unsigned int ID)
         if (data)
         {
             glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+            size += static_cast<std::size_t>(width) * height * 3;
             stbi_image_free(data);
         }
         else
@@ -26,6 +31,12 @@ void loadCubemap(std::vector<std::string> faces, unsigned int ID)
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    if (bytes != nullptr)
+    {
+        *bytes = size;
+    }
+    return ID;
 }
 
 void loadTexture(std::string path, unsigned int ID, bool flipVertically)
@@ -50,7 +61,8 @@ void loadTexture(std::string path, unsigned int ID, bool flipVertically)
             format = GL_RGBA;
         }
 
-        glBindTexture(GL_TEXTURE_2D, ID);
+        GLState::bindTexture(0, GL_TEXTURE_2D, ID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // tightly packed rows, like the faces above
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -68,7 +80,7 @@ void loadTexture(std::string path, unsigned int ID, bool flipVertically)
     }
 }
 
-unsigned int TextureFromFile(const char *filename, const std::string &directory, bool flipVertically, bool gamma)
+unsigned int TextureFromFile(const char *filename, const std::string &directory, bool flipVertically, bool gamma, std::size_t *bytes)
 {
     std::string fileName = std::string(filename);
     fileName = directory + '/' + fileName;
@@ -99,9 +111,14 @@ unsigned int TextureFromFile(const char *filename, const std::string &directory,
             dataFormat = GL_RGBA;
         }
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GLState::bindTexture(0, GL_TEXTURE_2D, textureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // tightly packed rows
         glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, dataFormat, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
+        if (bytes != nullptr)
+        {
+            *bytes = static_cast<std::size_t>(width) * height * nrComponents * 4 / 3; // the mipmaps add a third
+        }
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -1,23 +1,143 @@
 #include "world.h"
+#include "asset_loader.h"
+#include "gl_state.h"
+#include "profiler.h"
 
-const unsigned int World::N_TREES = 20;
-const unsigned int World::N_SURROUNDINGS = 30;
+#include <algorithm>
+#include <limits>
+#include <map>
+
+const unsigned int World::N_TREES = WorldLayout::N_TREES;
+const unsigned int World::N_SURROUNDINGS = WorldLayout::N_SURROUNDINGS;
+const std::size_t World::DEFAULT_CACHE_BUDGET = 512 * 1024 * 1024;
+
+/// Files that make up an environment.
+struct EnvironmentAssets
+{
+    std::string surrounding; // flower/rock/pumpkin model
+    std::string tree;        // tree model
+    std::string skybox;      // directory of the skybox faces
+    std::string ground;      // ground texture (in GROUND_DIRECTORY)
+};
+
+static const std::map<std::string, EnvironmentAssets> ENVIRONMENT_ASSETS = {
+    {"desert", {"resources/models/rocks/rock_desert/rock.obj", "resources/models/trees/desert_land_tree/hoewa_Forsteriana_1.obj",
+                "resources/skybox/desert_land/", "desert_ground.png"}},
+    {"forest", {"resources/models/flowers/anemone_hybrida.obj", "resources/models/trees/forest_land_tree/trees9.obj",
+                "resources/skybox/forest_land/", "forest_ground.png"}},
+    {"snow", {"resources/models/rocks/rock_snow/rock.obj", "resources/models/trees/snow_land_tree/Tree_Red-spruce.obj",
+              "resources/skybox/snow_land/", "snow_ground.png"}},
+    {"night", {"resources/models/pumpkin/pumpkin face.obj", "resources/models/trees/night_land_tree/Tree_001.obj",
+               "resources/skybox/night_land/", "night_ground.png"}}};
+
+static const char *GROUND_DIRECTORY = "resources/textures";
+static const std::vector<std::string> SKYBOX_FACES = {"px.jpg", "nx.jpg", "py.jpg", "ny.jpg", "pz.jpg", "nz.jpg"};
+
+/// Mesh of a model drawn with one of the textures of the model.
+struct MeshTexture
+{
+    unsigned int mesh;    // index in Model::meshes
+    unsigned int texture; // index in Model::textures_loaded
+};
+
+// the parts of the tree models that are drawn per environment (the forest and snow models contain multiple trees,
+// only one of them is drawn; the desert tree is drawn with all three textures of each of its two meshes)
+static const std::map<std::string, std::vector<MeshTexture>> TREE_PARTS = {
+    {"desert", {{0, 0}, {0, 1}, {0, 2}, {1, 3}, {1, 4}, {1, 5}}},
+    {"forest", {{1, 1}}},
+    {"snow", {{5, 0}}},
+    {"night", {{0, 0}, {0, 1}}}};
+
+// the parts of the flower/rock/pumpkin models that are drawn per environment (not all flower meshes are used,
+// desert and snow have the same rocks, just different colors, the pumpkin has three meshes and one texture)
+static const std::map<std::string, std::vector<MeshTexture>> SURROUNDING_PARTS = {
+    {"desert", {{0, 0}}},
+    {"forest", {{0, 0}, {1, 1}, {2, 3}, {4, 6}, {5, 6}, {6, 8}}},
+    {"snow", {{0, 0}}},
+    {"night", {{0, 0}, {1, 0}, {2, 0}}}};
+
+/**
+ * @brief Makes the draw items of the parts of an instanced model.
+ *
+ * @param model model.
+ * @param parts meshes and textures to draw.
+ * @param program shader program.
+ * @param instances number of instances.
+ * @return std::vector<DrawItem> one item per part.
+ */
+static std::vector<DrawItem> makeModelDraws(const Model &model, const std::vector<MeshTexture> &parts, GLuint program, unsigned int instances)
+{
+    std::vector<DrawItem> items;
+    for (const MeshTexture &part : parts)
+    {
+        DrawItem item;
+        item.program = program;
+        item.VAO = model.meshes[part.mesh].VAO.get();
+        item.texture = model.textures_loaded[part.texture].id;
+        item.count = static_cast<GLsizei>(model.meshes[part.mesh].indexCount);
+        item.instanceCount = static_cast<GLsizei>(instances);
+        items.push_back(item);
+    }
+    return items;
+}
+
+/**
+ * @brief Adds a bounding sphere per instance of a model: the sphere around the drawn meshes, moved and scaled by the model matrix.
+ *
+ * @param model model.
+ * @param parts meshes that are drawn.
+ * @param modelMatrices model matrix per instance.
+ * @param spheres spheres are added here.
+ */
+static void addBoundingSpheres(const Model &model, const std::vector<MeshTexture> &parts, const std::vector<glm::mat4> &modelMatrices, BoundingSpheres &spheres)
+{
+    // sphere around the bounding box of the drawn meshes, in model space
+    glm::vec3 minimum(std::numeric_limits<float>::max());
+    glm::vec3 maximum(-std::numeric_limits<float>::max());
+    for (const MeshTexture &part : parts)
+    {
+        minimum = glm::min(minimum, model.meshes[part.mesh].boundsMin);
+        maximum = glm::max(maximum, model.meshes[part.mesh].boundsMax);
+    }
+    if (minimum.x > maximum.x)
+    {
+        minimum = maximum = glm::vec3(0.0f);
+    }
+    glm::vec3 center = 0.5f * (minimum + maximum);
+    float radius = glm::length(maximum - center);
+
+    for (const glm::mat4 &modelMatrix : modelMatrices)
+    {
+        float scale = std::max(glm::length(glm::vec3(modelMatrix[0])), std::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+        spheres.add(glm::vec3(modelMatrix * glm::vec4(center, 1.0f)), radius * scale);
+    }
+}
 
 World::World()
 {
     isLoaded = false;
+    seed = 0;
+    cacheBudget = DEFAULT_CACHE_BUDGET;
+    gpuTimer = nullptr;
+    visibleTrees = 0;
+    visibleSurroundings = 0;
 }
 
 World::World(const std::string& envType)
 {
     isLoaded = false;
-    load(envType);
+    cacheBudget = DEFAULT_CACHE_BUDGET;
+    gpuTimer = nullptr;
+    visibleTrees = 0;
+    visibleSurroundings = 0;
+    load(envType, randomSeed());
 }
 
-void World::load(const std::string& envType)
+void World::load(const std::string& envType, unsigned int seed)
 {
     clearWorldData();
     environmentType = "";
+    this->seed = seed;
 
     // convert envType to lowercase
     std::string lowercaseEnvType = envType;
@@ -40,35 +160,166 @@ void World::load(const std::string& envType)
     isLoaded = true;
 }
 
+void World::requestAssets(const std::string& envType, AssetLoader &loader)
+{
+    auto it = ENVIRONMENT_ASSETS.find(envType);
+    if (it == ENVIRONMENT_ASSETS.end())
+    {
+        return;
+    }
+    const EnvironmentAssets &assets = it->second;
+    loader.loadModel(assets.tree, true);
+    loader.loadModel(assets.surrounding, true);
+    loader.loadTexture(assets.ground, GROUND_DIRECTORY, false);
+    loader.loadCubemap(SkyBox::getFacePaths(SKYBOX_FACES, assets.skybox));
+}
+
+void World::prefetchAssets(const std::string& envType, AssetLoader &loader)
+{
+    auto it = ENVIRONMENT_ASSETS.find(envType);
+    if (it == ENVIRONMENT_ASSETS.end())
+    {
+        return;
+    }
+    const EnvironmentAssets &assets = it->second;
+    loader.prefetchModel(assets.tree, true);
+    loader.prefetchModel(assets.surrounding, true);
+    loader.prefetchTexture(assets.ground, GROUND_DIRECTORY, false);
+    loader.prefetchCubemap(SkyBox::getFacePaths(SKYBOX_FACES, assets.skybox));
+}
+
+void World::setCacheBudget(std::size_t bytes)
+{
+    cacheBudget = bytes;
+}
+
+std::shared_ptr<EnvironmentResources> World::useEnvironment(const std::string& envType)
+{
+    std::shared_ptr<EnvironmentResources> resources;
+    auto cached = std::find_if(environmentCache.begin(), environmentCache.end(), [&envType](const std::shared_ptr<EnvironmentResources> &entry)
+                               { return entry->type == envType; });
+    if (cached != environmentCache.end())
+    {
+        resources = *cached;
+        environmentCache.erase(cached);
+    }
+    else
+    {
+        // load correct models, skybox and ground texture (taken from the registry if they were loaded ahead, see requestAssets)
+        const EnvironmentAssets &assets = ENVIRONMENT_ASSETS.at(envType);
+        resources = std::make_shared<EnvironmentResources>();
+        resources->type = envType;
+        resources->surrounding = ResourceRegistry::getModel(assets.surrounding, true);
+        resources->tree = ResourceRegistry::getModel(assets.tree, true);
+        resources->groundTexture = ResourceRegistry::getTexture(assets.ground, GROUND_DIRECTORY, false);
+        resources->skybox = SkyBox(SKYBOX_FACES, assets.skybox);
+        resources->bytes = resources->tree->getGpuBytes() + resources->surrounding->getGpuBytes() +
+                           resources->groundTexture->bytes + resources->skybox.getGpuBytes();
+    }
+    environmentCache.insert(environmentCache.begin(), resources);
+
+    // drop the least recently loaded environments while over budget (their GPU memory is freed once nobody else holds it)
+    std::size_t cachedBytes = 0;
+    for (const std::shared_ptr<EnvironmentResources> &entry : environmentCache)
+    {
+        cachedBytes += entry->bytes;
+    }
+    while (cachedBytes > cacheBudget && environmentCache.size() > 1)
+    {
+        cachedBytes -= environmentCache.back()->bytes;
+        environmentCache.pop_back();
+    }
+    return resources;
+}
+
 void World::clearWorldData()
 {
-    treePos.clear();
-    surroundingPos.clear();
+    layout = WorldLayout();
     groundVertices.clear();
     treeModelMatrices.clear();
     surroundingModelMatrices.clear();
+    treeDraws.clear();
+    surroundingDraws.clear();
+    treeSpheres.clear();
+    surroundingSpheres.clear();
 }
 
-void World::Draw(glm::mat4 View, glm::mat4 Projection)
+void World::Draw(const glm::mat4 &viewProjection)
 {
+    PROFILE_ZONE("World::Draw");
     if (!isLoaded) return;
 
-    view = View;
-    projection = Projection;
+    // only the trees and flowers/rocks/pumpkins in view are uploaded and drawn
+    {
+        PROFILE_ZONE("frustum culling");
+        Frustum frustum = Frustum::fromMatrix(viewProjection);
+        visibleTrees = uploadVisibleInstances(frustum, treeSpheres, treeModelMatrices, treeBuffer.get());
+        visibleSurroundings = uploadVisibleInstances(frustum, surroundingSpheres, surroundingModelMatrices, surroundingBuffer.get());
+    }
+    PROFILE_COUNTER("visible trees", visibleTrees);
+    PROFILE_COUNTER("visible surroundings", visibleSurroundings);
 
     // depth test
-    glEnable(GL_DEPTH_TEST);
+    GLState::setEnabled(GL_DEPTH_TEST, true);
+
+    // draw objects (every pass is timed on the GPU if a timer is set)
+    {
+        GpuTimer::Scope timing(gpuTimer, GpuPass::SKYBOX);
+        drawSkyBox(false);
+    }
+    renderQueue.resetStats();
+    {
+        GpuTimer::Scope timing(gpuTimer, GpuPass::GROUND);
+        drawGround();
+    }
+    {
+        GpuTimer::Scope timing(gpuTimer, GpuPass::SURROUNDINGS);
+        drawSurroundings();
+    }
+    {
+        GpuTimer::Scope timing(gpuTimer, GpuPass::TREES);
+        drawTrees();
+    }
+
+    PROFILE_COUNTER("world draws", renderQueue.getStats().draws);
+    PROFILE_COUNTER("world redundant binds", renderQueue.getStats().redundantBinds);
+}
 
-    // draw objects
-    drawSkyBox(false);
-    drawGround();
-    drawSurroundings();
-    drawTrees();
+unsigned int World::uploadVisibleInstances(const Frustum &frustum, const BoundingSpheres &spheres, const std::vector<glm::mat4> &modelMatrices, unsigned int buffer)
+{
+    int count = cullSpheres(frustum, spheres, visible);
+    visibleMatrices.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        visibleMatrices[i] = modelMatrices[visible[i]];
+    }
+
+    // the buffer is orphaned every frame so the driver never waits for the previous draw
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, modelMatrices.size() * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4), visibleMatrices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return static_cast<unsigned int>(count);
+}
+
+const RenderQueueStats &World::getRenderStats() const
+{
+    return renderQueue.getStats();
+}
+
+void World::setGpuTimer(GpuTimer *timer)
+{
+    gpuTimer = timer;
 }
 
 std::vector<glm::vec3> World::getTreePositions() const
 {
-    return treePos;
+    return layout.treePositions;
+}
+
+std::vector<AABBox> World::getObstacles() const
+{
+    return layout.getObstacles();
 }
 
 void World::setupWorld()
@@ -77,147 +328,83 @@ void World::setupWorld()
     {
         // select environment type randomly
         std::vector<std::string> envTypes = {"desert", "forest", "snow", "night"};
-        // set up a random number gen that picks an index
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, envTypes.size() - 1);
-        int idx = dis(gen);
+        // pick an index with the environment stream of the seed
+        std::mt19937 gen = makeRandomStream(seed, RandomStream::WORLD_ENVIRONMENT);
+        int idx = randomInt(gen, 0, static_cast<int>(envTypes.size()) - 1);
         // use the selected environment type
         environmentType = envTypes[idx];
     }
     
     // create shaders
-    shaderModel = Shader("shaders/instancing.vert", "shaders/model.frag");
-    shaderGround = Shader("shaders/ground.vert", "shaders/ground.frag");
-    shaderSkybox = Shader("shaders/skybox.vert", "shaders/skybox.frag");
-
-    // load correct models, skybox and ground texture
-    std::string dirName;
-    if (environmentType == "desert")
-    {
-        surrounding = Model("resources/models/rocks/rock_desert/rock.obj", true);
-        tree = Model("resources/models/trees/desert_land_tree/hoewa_Forsteriana_1.obj", true);
-        dirName = "resources/skybox/desert_land/";
-        groundTexture = TextureFromFile("desert_ground.png", "resources/textures", false);
-    }
-    if (environmentType == "forest")
-    {
-        surrounding = Model("resources/models/flowers/anemone_hybrida.obj", true);
-        tree = Model("resources/models/trees/forest_land_tree/trees9.obj", true);
-        dirName = "resources/skybox/forest_land/";
-        groundTexture = TextureFromFile("forest_ground.png", "resources/textures", false);
-    }
-    if (environmentType == "snow")
-    {   
-        surrounding = Model("resources/models/rocks/rock_snow/rock.obj", true);
-        tree = Model("resources/models/trees/snow_land_tree/Tree_Red-spruce.obj", true);
-        dirName = "resources/skybox/snow_land/";
-        groundTexture = TextureFromFile("snow_ground.png", "resources/textures", false);
-    }
-    if (environmentType == "night")
-    {   
-        surrounding = Model("resources/models/pumpkin/pumpkin face.obj", true);
-        tree = Model("resources/models/trees/night_land_tree/Tree_001.obj", true);
-        dirName = "resources/skybox/night_land/";
-        groundTexture = TextureFromFile("night_ground.png", "resources/textures", false);
-    }
+    shaderModel = ResourceRegistry::getShader("shaders/instancing.vert", "shaders/model.frag");
+    shaderGround = ResourceRegistry::getShader("shaders/ground.vert", "shaders/ground.frag");
+    shaderSkybox = ResourceRegistry::getShader("shaders/skybox.vert", "shaders/skybox.frag");
+    shaderModel->use();
+    shaderModel->setInt("texture_diffuse1", 0);
+
+    // models, skybox and ground texture (cached if this environment was loaded recently)
+    environment = useEnvironment(environmentType);
+    Model &tree = *environment->tree;
+    Model &surrounding = *environment->surrounding;
     
     // generate positions, model matrices and set up instanced array buffers for trees and flowers
-    createTreePositions();
-    createSurroundingPositions();
+    layout = WorldLayout(environmentType, seed);
     createTreeModelMatrices();
     createSurroundingModelMatrices();
     setupInstancedArray(tree, treeBuffer, treeModelMatrices, N_TREES);
     setupInstancedArray(surrounding, surroundingBuffer, surroundingModelMatrices, N_SURROUNDINGS);
 
-    // initialize skybox object
-    std::vector<std::string> filenames = {"px.jpg", "nx.jpg", "py.jpg", "ny.jpg", "pz.jpg", "nz.jpg"};
-    skybox = SkyBox(filenames, dirName);
-
-    // get ground vertex data and set up the buffers
+    // get ground vertex data and set up the buffers (once, the ground is the same in every environment)
     groundVertices = getGroundVertexData();
-    glGenVertexArrays(1, &groundVAO);
-    glGenBuffers(1, &groundVBO);
-    glBindVertexArray(groundVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, groundVBO);
-    glBufferData(GL_ARRAY_BUFFER, groundVertices.size() * sizeof(float), &groundVertices[0], GL_STATIC_DRAW);
-    // positions
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
-    // texture coords
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
-    glBindVertexArray(0);
+    if (groundVAO.get() == 0)
+    {
+        groundVAO.create();
+        groundVBO.create();
+        GLState::bindVertexArray(groundVAO.get());
+        glBindBuffer(GL_ARRAY_BUFFER, groundVBO.get());
+        glBufferData(GL_ARRAY_BUFFER, groundVertices.size() * sizeof(float), &groundVertices[0], GL_STATIC_DRAW);
+        // positions
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)0);
+        // texture coords
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void *)(3 * sizeof(float)));
+        GLState::bindVertexArray(0);
+    }
+
+    // draw items of the ground, trees and flowers/rocks/pumpkins
+    groundDraw = DrawItem();
+    groundDraw.program = shaderGround->ID;
+    groundDraw.VAO = groundVAO.get();
+    groundDraw.texture = environment->groundTexture->id;
+    groundDraw.count = 6;
+    groundDraw.indexed = false;
+    treeDraws = makeModelDraws(tree, TREE_PARTS.at(environmentType), shaderModel->ID, N_TREES);
+    surroundingDraws = makeModelDraws(surrounding, SURROUNDING_PARTS.at(environmentType), shaderModel->ID, N_SURROUNDINGS);
+
+    // bounding spheres for frustum culling (around the drawn meshes only, some models contain more than is drawn)
+    addBoundingSpheres(tree, TREE_PARTS.at(environmentType), treeModelMatrices, treeSpheres);
+    addBoundingSpheres(surrounding, SURROUNDING_PARTS.at(environmentType), surroundingModelMatrices, surroundingSpheres);
+    visibleTrees = 0;
+    visibleSurroundings = 0;
 }
 
 void World::drawTrees()
 {
-    // set uniforms and draw the trees
-    shaderModel.use();
-    shaderModel.setMat4("projection", projection);
-    shaderModel.setMat4("view", view);
-    shaderModel.setInt("texture_diffuse1", 0);
+    if (visibleTrees == 0) return;
 
-    if (environmentType == "desert")
-    {
-        int meshID = 0;
-        for (unsigned int i = 0; i < 6; i++)
-        {
-            // mesh at index 0 has textures at indices 0,1,2
-            // mesh at index 1 has textures at indices 3,4,5
-            if (i >= 3) {meshID = 1;}
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, tree.textures_loaded[i].id);
-            glBindVertexArray(tree.meshes[meshID].VAO);
-            glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(tree.meshes[meshID].indices.size()), GL_UNSIGNED_INT, 0, N_TREES);
-            glBindVertexArray(0);
-            glActiveTexture(GL_TEXTURE0);
-        }
-    }
-    if (environmentType == "forest" or environmentType == "snow")
-    {
-        int meshIdx = 1;
-        int textureIdx = 1; 
-        if (environmentType == "snow")
-        {
-            meshIdx = 5;
-            textureIdx = 0;
-        }
-        // render only one specific tree (both the forest and snow tree model is made up of multiple trees)
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, tree.textures_loaded[textureIdx].id); 
-        glBindVertexArray(tree.meshes[meshIdx].VAO); 
-        glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(tree.meshes[meshIdx].indices.size()), GL_UNSIGNED_INT, 0, N_TREES);
-        glBindVertexArray(0);
-    }
-    if (environmentType == "night")
+    for (DrawItem item : treeDraws)
     {
-        // tree model consists of one meshes and two textures
-        for (unsigned int i = 0; i < 2; i++)
-        {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, tree.textures_loaded[i].id); 
-            glBindVertexArray(tree.meshes[0].VAO); 
-            glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(tree.meshes[0].indices.size()), GL_UNSIGNED_INT, 0, N_TREES);
-            glBindVertexArray(0); 
-        }  
+        item.instanceCount = static_cast<GLsizei>(visibleTrees);
+        renderQueue.submit(item);
     }
+    renderQueue.flush();
 }
 
 void World::drawGround()
 {
-    // set uniforms and draw the ground
-    shaderGround.use();
-    shaderGround.setMat4("projection", projection);
-    shaderGround.setMat4("view", view);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, groundTexture);
-    glBindVertexArray(groundVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-
-    // set everything back to default
-    glBindVertexArray(0);
-    glActiveTexture(GL_TEXTURE0);
+    renderQueue.submit(groundDraw);
+    renderQueue.flush();
 }
 
 void World::drawSkyBox(bool grayscale)
@@ -225,69 +412,32 @@ void World::drawSkyBox(bool grayscale)
     if (!isLoaded) return;
 
     // render skybox
-    glDepthFunc(GL_LEQUAL);
-    shaderSkybox.use();
+    GLState::depthFunc(GL_LEQUAL);
+    shaderSkybox->use();
 
     if (grayscale)
     {
-        shaderSkybox.setBool("grayscale", true);
+        shaderSkybox->setBool("grayscale", true);
     }
     else
     {
-        shaderSkybox.setBool("grayscale", false);
+        shaderSkybox->setBool("grayscale", false);
     }
 
-    skybox.Draw(shaderSkybox, view, projection);
-    glDepthFunc(GL_LESS);
+    environment->skybox.Draw(*shaderSkybox);
+    GLState::depthFunc(GL_LESS);
 }
 
 void World::drawSurroundings()
 {
-    // set uniforms 
-    shaderModel.use();
-    shaderModel.setMat4("projection", projection);
-    shaderModel.setMat4("view", view);
-    shaderModel.setInt("texture_diffuse1", 0);
-
-    // desert and snow environment have the same rocks, just different colors
-    if (environmentType == "desert" or environmentType == "snow")
-    {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, surrounding.textures_loaded[0].id);
-        glBindVertexArray(surrounding.meshes[0].VAO);
-        glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(surrounding.meshes[0].indices.size()), GL_UNSIGNED_INT, 0, N_SURROUNDINGS);
-        glBindVertexArray(0);
-        glActiveTexture(GL_TEXTURE0);
-    }
-    if (environmentType == "forest")
-    {
-        // note that not all textures and meshes are used to render the model
-        int textureIDs[] = {0, 1, 3, 6, 6, 8};
-        int meshIDs[] = {0, 1, 2, 4, 5, 6}; 
-        for (unsigned int i = 0; i < 6; i++)
-        {
-            // draw flowers
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, surrounding.textures_loaded[textureIDs[i]].id);
-            glBindVertexArray(surrounding.meshes[meshIDs[i]].VAO);
-            glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(surrounding.meshes[meshIDs[i]].indices.size()), GL_UNSIGNED_INT, 0, N_SURROUNDINGS);
-            glBindVertexArray(0);
-            glActiveTexture(GL_TEXTURE0);
-        }
-    }
-    if (environmentType == "night")
+    if (visibleSurroundings == 0) return;
+
+    for (DrawItem item : surroundingDraws)
     {
-        // pumpkin model consists three meshes and one texture
-        for (unsigned int i = 0; i < 3; i++)
-        {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, surrounding.textures_loaded[0].id);
-            glBindVertexArray(surrounding.meshes[i].VAO);
-            glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(surrounding.meshes[i].indices.size()), GL_UNSIGNED_INT, 0, N_SURROUNDINGS);
-            glBindVertexArray(0);
-            glActiveTexture(GL_TEXTURE0);
-        }
+        item.instanceCount = static_cast<GLsizei>(visibleSurroundings);
+        renderQueue.submit(item);
     }
+    renderQueue.flush();
 }
 
 std::vector<float> World::getGroundVertexData() const
@@ -306,66 +456,12 @@ std::vector<float> World::getGroundVertexData() const
     return v;
 }
 
-void World::createTreePositions()
-{
-    std::random_device rd;  // obtain a random number from hardware
-    std::mt19937 gen(rd()); // seed the generator
-
-    // define range for x and z axis
-    int a = (-Terrain::SIZE / 2) + 2;
-    int b = (Terrain::SIZE / 2) - 2;
-    std::uniform_int_distribution<> xzPlane(a, b);
-
-    // create random positions for trees
-    for (unsigned int i = 0; i < N_TREES; i++)
-    {
-        float posX = xzPlane(gen);
-        float posZ = xzPlane(gen);
-        glm::vec3 vec = {posX, Terrain::GROUND_Y, posZ};
-        treePos.push_back(vec);
-    }
-}
-
-void World::createSurroundingPositions()
-{
-    std::random_device rd;  // obtain a random number from hardware
-    std::mt19937 gen(rd()); // seed the generator
-
-    // define range for x and z axis
-    int a = (-Terrain::SIZE / 2) + 2;
-    int b = (Terrain::SIZE / 2) - 2;
-    std::uniform_int_distribution<> xzPlane(a, b);
-
-    // create random positions for surroundings
-    for (unsigned int i = 0; i < N_SURROUNDINGS; i++)
-    {
-        // generate positions until a unique position is found
-        glm::vec3 vec;
-        do
-        {
-            vec = {xzPlane(gen), Terrain::GROUND_Y, xzPlane(gen)};
-        } while (std::find(treePos.begin(), treePos.end(), vec) != treePos.end());
-
-        // adjust y value where needed (otherwise some models are too high/low)
-        if (environmentType == "desert" or environmentType == "snow")
-        {
-            vec.y += 0.2;
-        }
-        if (environmentType == "forest")
-        {
-            vec.y -= 0.1;
-        }
-
-        surroundingPos.push_back(vec);
-    }
-}
-
 void World::createTreeModelMatrices()
 {
     for (unsigned int i = 0; i < N_TREES; i++)
     {
         glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, treePos[i]); // translation
+        model = glm::translate(model, layout.treePositions[i]); // translation
         if (environmentType == "desert")
         {
             model = glm::scale(model, glm::vec3(0.06)); // scale down
@@ -387,9 +483,8 @@ void World::createSurroundingModelMatrices()
     for (unsigned int i = 0; i < N_SURROUNDINGS; i++)
     {
         glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, surroundingPos[i]); // translation
-        float rotAngle = static_cast<float>((rand() % 360)); 
-        model = glm::rotate(model, rotAngle, glm::vec3(0.0f, 1.0f, 0.0f)); // add (semi)random rotation
+        model = glm::translate(model, layout.surroundingPositions[i]); // translation
+        model = glm::rotate(model, layout.surroundingRotations[i], glm::vec3(0.0f, 1.0f, 0.0f)); // add (semi)random rotation
         if (environmentType == "desert" or environmentType == "snow")
         {
             model = glm::scale(model, glm::vec3(0.4)); // scale down
@@ -406,18 +501,21 @@ void World::createSurroundingModelMatrices()
     }
 }
 
-void World::setupInstancedArray(Model &model, unsigned int buffer, std::vector<glm::mat4> modelMatrices, int amount)
+void World::setupInstancedArray(Model &model, GLBuffer &buffer, const std::vector<glm::mat4> &modelMatrices, int amount)
 {
-    // configure instanced array
-    glGenBuffers(1, &buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, buffer);
-    glBufferData(GL_ARRAY_BUFFER, amount * sizeof(glm::mat4), &modelMatrices[0], GL_STATIC_DRAW);
+    // configure instanced array (rewritten every frame with the visible instances)
+    if (buffer.get() == 0)
+    {
+        buffer.create();
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.get());
+    glBufferData(GL_ARRAY_BUFFER, amount * sizeof(glm::mat4), &modelMatrices[0], GL_STREAM_DRAW);
 
     // set transformation matrices as an instance vertex attribute 
     for (unsigned int i = 0; i < model.meshes.size(); i++)
     {
-        unsigned int VAO = model.meshes[i].VAO;
-        glBindVertexArray(VAO);
+        unsigned int VAO = model.meshes[i].VAO.get();
+        GLState::bindVertexArray(VAO);
         // set attribute pointers for matrix (4 times vec4)
         glEnableVertexAttribArray(3);
         glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)0);
@@ -433,6 +531,6 @@ void World::setupInstancedArray(Model &model, unsigned int buffer, std::vector<g
         glVertexAttribDivisor(5, 1);
         glVertexAttribDivisor(6, 1);
 
-        glBindVertexArray(0);
+        GLState::bindVertexArray(0);
     }
 }
@@ -0,0 +1,93 @@
+#include "world_layout.h"
+
+#include <algorithm>
+
+#include <glm/gtc/constants.hpp>
+
+const unsigned int WorldLayout::N_TREES = 20;
+const unsigned int WorldLayout::N_SURROUNDINGS = 30;
+
+WorldLayout::WorldLayout() {}
+
+WorldLayout::WorldLayout(const std::string &environmentType, unsigned int seed)
+{
+    std::mt19937 layoutGen = makeRandomStream(seed, RandomStream::WORLD_LAYOUT);
+    createTreePositions(layoutGen);
+    createSurroundingPositions(environmentType, layoutGen);
+
+    // (semi)random rotation of the flowers/rocks/pumpkins
+    std::mt19937 rotationGen = makeRandomStream(seed, RandomStream::WORLD_ROTATION);
+    for (unsigned int i = 0; i < N_SURROUNDINGS; i++)
+    {
+        surroundingRotations.push_back(randomFloat(rotationGen, 0.0f, glm::two_pi<float>()));
+    }
+}
+
+std::vector<AABBox> WorldLayout::getObstacles() const
+{
+    // rough boxes around the models: trees are taller than the highest drone, flowers/rocks/pumpkins stay close to the ground
+    const float treeHalfWidth = 0.4f;
+    const float treeHeight = 7.0f;
+    const float surroundingHalfWidth = 0.4f;
+    const float surroundingHeight = 0.6f;
+
+    std::vector<AABBox> obstacles;
+    for (const glm::vec3 &pos : treePositions)
+    {
+        obstacles.push_back(AABBox(glm::vec3(pos.x - treeHalfWidth, pos.y, pos.z - treeHalfWidth),
+                                   glm::vec3(pos.x + treeHalfWidth, pos.y + treeHeight, pos.z + treeHalfWidth)));
+    }
+    for (const glm::vec3 &pos : surroundingPositions)
+    {
+        obstacles.push_back(AABBox(glm::vec3(pos.x - surroundingHalfWidth, pos.y, pos.z - surroundingHalfWidth),
+                                   glm::vec3(pos.x + surroundingHalfWidth, pos.y + surroundingHeight, pos.z + surroundingHalfWidth)));
+    }
+    return obstacles;
+}
+
+void WorldLayout::createTreePositions(std::mt19937 &gen)
+{
+    // define range for x and z axis
+    int a = static_cast<int>(-Terrain::SIZE / 2) + 2;
+    int b = static_cast<int>(Terrain::SIZE / 2) - 2;
+
+    // create random positions for trees
+    for (unsigned int i = 0; i < N_TREES; i++)
+    {
+        float posX = randomInt(gen, a, b);
+        float posZ = randomInt(gen, a, b);
+        treePositions.push_back(glm::vec3(posX, Terrain::GROUND_Y, posZ));
+    }
+}
+
+void WorldLayout::createSurroundingPositions(const std::string &environmentType, std::mt19937 &gen)
+{
+    // define range for x and z axis
+    int a = static_cast<int>(-Terrain::SIZE / 2) + 2;
+    int b = static_cast<int>(Terrain::SIZE / 2) - 2;
+
+    // create random positions for surroundings
+    for (unsigned int i = 0; i < N_SURROUNDINGS; i++)
+    {
+        // generate positions until a unique position is found
+        glm::vec3 vec;
+        do
+        {
+            float posX = randomInt(gen, a, b);
+            float posZ = randomInt(gen, a, b);
+            vec = glm::vec3(posX, Terrain::GROUND_Y, posZ);
+        } while (std::find(treePositions.begin(), treePositions.end(), vec) != treePositions.end());
+
+        // adjust y value where needed (otherwise some models are too high/low)
+        if (environmentType == "desert" or environmentType == "snow")
+        {
+            vec.y += 0.2;
+        }
+        if (environmentType == "forest")
+        {
+            vec.y -= 0.1;
+        }
+
+        surroundingPositions.push_back(vec);
+    }
+}
@@ -0,0 +1,92 @@
+/// === BVH regression test === ///
+/// Casts rays through trees in which some items are disabled (dead drones, free slots) and checks
+/// that only enabled items are hit. Exits with 1 if a check fails (run by ctest).
+/// Usage: bvh-test
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "bvh.h"
+
+static int failures = 0;
+
+/**
+ * @brief Casts a ray along +x from the origin and compares the result with the expected hit.
+ *
+ * @param name name shown if the check fails.
+ * @param tree tree to cast the ray through.
+ * @param expectedId id that should be hit (-1 = nothing).
+ * @param expectedDistance distance of the expected hit.
+ */
+static void expectHit(const char *name, const BVH &tree, int expectedId, float expectedDistance)
+{
+    int id = -1;
+    float distance = 0.0f;
+    bool hit = tree.raycast(Ray(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f)), 100.0f, id, distance);
+    if (!hit)
+    {
+        id = -1;
+    }
+    if (id != expectedId || (hit && std::abs(distance - expectedDistance) > 1e-4f))
+    {
+        std::cout << "FAILED: " << name << ": hit id " << id << " at " << distance
+                  << ", expected id " << expectedId << " at " << expectedDistance << std::endl;
+        failures++;
+    }
+}
+
+/// Returns a unit box on the x axis, starting at x.
+static AABBox boxAt(float x)
+{
+    return AABBox(glm::vec3(x, -1.0f, -1.0f), glm::vec3(x + 2.0f, 1.0f, 1.0f));
+}
+
+int main()
+{
+    // three items in one leaf, the one in the middle is disabled
+    BVH tree;
+    tree.build({0, 1, 2}, {boxAt(9.0f), boxAt(20.0f), boxAt(30.0f)});
+    tree.disable(1);
+    tree.refit();
+    expectHit("disabled item in a leaf", tree, 0, 9.0f);
+
+    // the nearest items are disabled, the ray has to reach the one behind them
+    tree.disable(0);
+    tree.refit();
+    expectHit("disabled items in front", tree, 2, 30.0f);
+
+    // an item that gets a box again can be hit again
+    tree.update(0, boxAt(5.0f).bounds[0], boxAt(5.0f).bounds[1]);
+    tree.refit();
+    expectHit("item enabled again", tree, 0, 5.0f);
+
+    // everything disabled
+    tree.disable(0);
+    tree.disable(2);
+    tree.refit();
+    expectHit("all items disabled", tree, -1, 0.0f);
+
+    // several leaves, every other item disabled
+    std::vector<int> ids;
+    std::vector<AABBox> boxes;
+    for (int i = 0; i < 40; i++)
+    {
+        ids.push_back(i);
+        boxes.push_back(boxAt(4.0f + 2.0f * i));
+    }
+    BVH large;
+    large.build(ids, boxes);
+    for (int i = 0; i < 40; i += 2)
+    {
+        large.disable(i);
+    }
+    large.refit();
+    expectHit("every other item disabled", large, 1, 6.0f);
+
+    if (failures == 0)
+    {
+        std::cout << "all BVH checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
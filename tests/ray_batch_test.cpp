@@ -0,0 +1,79 @@
+/// === Batched ray vs box regression test === ///
+/// Casts random rays against boxes of which some are inverted (min > max, like the +inf/-inf boxes of unused slots
+/// or a single flipped axis) and checks that nearestRayHit (SIMD) and nearestRayHitScalar agree and never return an
+/// inverted box. Exits with 1 if a check fails (run by ctest; configure with -DENABLE_AVX2=ON to cover AVX2 too).
+/// Usage: ray-batch-test
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "ray_batch.h"
+
+int main()
+{
+    const int boxCount = 37; // not a multiple of 8 or 4, so the SIMD loops and the scalar tail are all used
+    const float infinity = std::numeric_limits<float>::infinity();
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> size(0.5f, 3.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    // every third box is empty (+inf/-inf), every fifth has one flipped axis, the rest are normal boxes
+    std::vector<float> minX(boxCount), minY(boxCount), minZ(boxCount), maxX(boxCount), maxY(boxCount), maxZ(boxCount);
+    std::vector<bool> inverted(boxCount, false);
+    for (int i = 0; i < boxCount; i++)
+    {
+        float x = position(rng), y = position(rng), z = position(rng), half = size(rng);
+        minX[i] = x - half;
+        minY[i] = y - half;
+        minZ[i] = z - half;
+        maxX[i] = x + half;
+        maxY[i] = y + half;
+        maxZ[i] = z + half;
+        if (i % 3 == 0)
+        {
+            minX[i] = minY[i] = minZ[i] = infinity;
+            maxX[i] = maxY[i] = maxZ[i] = -infinity;
+            inverted[i] = true;
+        }
+        else if (i % 5 == 0)
+        {
+            std::swap(minY[i], maxY[i]);
+            inverted[i] = true;
+        }
+    }
+    const BoxArrays boxes = {minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data()};
+
+    int failures = 0;
+    for (int r = 0; r < 10000; r++)
+    {
+        glm::vec3 direction = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)));
+        Ray ray(glm::vec3(position(rng), position(rng), position(rng)), direction);
+        for (int begin : {0, 1, 3})
+        {
+            float simdDistance = 0.0f, scalarDistance = 0.0f;
+            int simd = nearestRayHit(ray, boxes, begin, boxCount, 40.0f, simdDistance);
+            int scalar = nearestRayHitScalar(ray, boxes, begin, boxCount, 40.0f, scalarDistance);
+            if (simd != scalar || (simd >= 0 && simdDistance != scalarDistance))
+            {
+                std::cout << "FAILED: ray " << r << ": " << rayBatchInstructionSet() << " hit " << simd << " at " << simdDistance
+                          << ", scalar hit " << scalar << " at " << scalarDistance << std::endl;
+                failures++;
+            }
+            if ((simd >= 0 && inverted[simd]) || (scalar >= 0 && inverted[scalar]))
+            {
+                std::cout << "FAILED: ray " << r << " hit inverted box " << (simd >= 0 && inverted[simd] ? simd : scalar) << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    if (failures == 0)
+    {
+        std::cout << "all ray batch checks passed (" << rayBatchInstructionSet() << ")" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
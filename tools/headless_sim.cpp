@@ -0,0 +1,326 @@
+/// === Headless simulation driver === ///
+/// Plays matches without a window, GPU or audio device, using a simple bot as the player.
+/// Usage: drone-sim [matches] [max seconds per match] [drones] [threads] [deterministic] [seed]
+///        drone-sim --record <file> [same options as above]   (records the input of the first match)
+///        drone-sim --replay <file> [threads] [deterministic] (replays a session recorded here or in the game)
+/// With more drones than Simulation::MAX_DRONES all drones join at once (horde mode).
+/// threads = 0 uses one thread per core; deterministic = 1 runs the job system in deterministic mode.
+/// Match n uses seed + n (a random seed if none is given), so runs with a seed can be repeated.
+/// When built with -DENABLE_PROFILER=ON, a Chrome trace of the last ticks is saved to drone_sim_profile.json.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "simulation.h"
+#include "input_log.h"
+#include "world_layout.h"
+#include "profiler.h"
+
+/// State the bot keeps between ticks, a new bot is created for every match.
+struct Bot
+{
+    std::vector<int> found;    // scratch: candidates for the nearest living drone
+    float searchRadius = 2.0f; // radius the search for the nearest drone starts with
+};
+
+/**
+ * @brief Bot that aims at the nearest living drone and shoots once it is lined up,
+ * while strafing from side to side.
+ *
+ * @param bot state of the bot.
+ * @param sim simulation.
+ * @return PlayerInput input for the next tick.
+ */
+static PlayerInput botInput(Bot &bot, Simulation &sim)
+{
+    PlayerInput input;
+    const PlayerState &player = sim.player;
+
+    // strafe direction changes every two seconds
+    bool strafeLeft = static_cast<int>(sim.time / 2.0f) % 2 == 0;
+    input.left = strafeLeft;
+    input.right = !strafeLeft;
+
+    // candidates for the nearest living drone: all drones when there are few of them,
+    // otherwise the drones in a small circle around the player (using the collision grid), starting
+    // just beyond the distance of the previous target since drones only move a little per tick
+    const DroneSwarm &drones = sim.drones;
+    std::vector<int> &found = bot.found;
+    found.clear();
+    if (drones.count() <= 64)
+    {
+        for (int i = 0; i < drones.slots(); i++)
+        {
+            if (drones.inUse[i] && !drones.isDead[i])
+            {
+                found.push_back(i);
+            }
+        }
+    }
+    else
+    {
+        for (float radius = bot.searchRadius; found.empty() && radius < Terrain::SIZE * 4; radius *= 1.5f)
+        {
+            sim.findDrones(player.position, radius, found);
+        }
+    }
+
+    // find nearest living drone
+    int target = -1;
+    float nearest = 0.0f;
+    for (int i : found)
+    {
+        float d = glm::distance(glm::vec3(drones.posX[i], drones.posY[i], drones.posZ[i]), player.position);
+        if (target == -1 || d < nearest)
+        {
+            target = i;
+            nearest = d;
+        }
+    }
+    if (target == -1)
+    {
+        return input;
+    }
+    bot.searchRadius = std::max(2.0f, nearest + 1.0f);
+
+    // aim at the center of the drone's bounding box
+    AABBox box = drones.getBoundingBox(target);
+    glm::vec3 toTarget = (box.bounds[0] + box.bounds[1]) * 0.5f - player.position;
+    float yaw = glm::degrees(atan2(toTarget.z, toTarget.x));
+    float pitch = glm::degrees(atan2(toTarget.y, glm::length(glm::vec2(toTarget.x, toTarget.z))));
+    float yawError = std::remainder(yaw - player.yaw, 360.0f);
+    float pitchError = pitch - player.pitch;
+
+    // turn at most 10 degrees per tick, like a human flicking the mouse
+    input.mouseDX = glm::clamp(yawError, -10.0f, 10.0f) / PlayerState::SENSITIVITY;
+    input.mouseDY = glm::clamp(pitchError, -10.0f, 10.0f) / PlayerState::SENSITIVITY;
+    input.shoot = std::abs(yawError) < 2.0f && std::abs(pitchError) < 2.0f;
+    return input;
+}
+
+/**
+ * @brief Returns a hash of the player and drone state, two runs that end with the same checksum played out the same.
+ *
+ * @param sim simulation.
+ * @return unsigned long long checksum (FNV-1a).
+ */
+static unsigned long long stateChecksum(const Simulation &sim)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    auto add = [&hash](float value)
+    {
+        unsigned char bytes[sizeof(float)];
+        std::memcpy(bytes, &value, sizeof(float));
+        for (unsigned char byte : bytes)
+        {
+            hash = (hash ^ byte) * 1099511628211ull;
+        }
+    };
+    add(sim.player.position.x);
+    add(sim.player.position.z);
+    add(sim.player.yaw);
+    add(sim.player.pitch);
+    add(sim.player.health);
+    add(static_cast<float>(sim.player.kills));
+    for (int i = 0; i < sim.drones.slots(); i++)
+    {
+        add(sim.drones.inUse[i] ? sim.drones.posX[i] : 0.0f);
+        add(sim.drones.inUse[i] ? sim.drones.posZ[i] : 0.0f);
+    }
+    return hash;
+}
+
+/**
+ * @brief Replays a recorded session as fast as possible and prints its result and timing.
+ *
+ * @param path path of the input log.
+ * @param threads number of job system threads (0 = one per core).
+ * @param deterministic run the job system in deterministic mode?
+ * @return int exit code.
+ */
+static int replaySession(const std::string &path, int threads, bool deterministic)
+{
+    InputReplay replay;
+    if (!replay.open(path))
+    {
+        return 1;
+    }
+    const SessionInfo &info = replay.getInfo();
+    if (info.ticksPerSecond != static_cast<int>(std::lround(1.0f / Simulation::TIMESTEP)))
+    {
+        std::cout << "WARNING: session was recorded at " << info.ticksPerSecond << " ticks per second, the replay will differ" << std::endl;
+    }
+
+    JobSystem jobs(threads, deterministic);
+    Simulation sim(info.maxDrones, info.spawnInterval);
+    sim.setJobSystem(&jobs);
+    if (!info.environment.empty())
+    {
+        sim.setObstacles(WorldLayout(info.environment, info.seed).getObstacles());
+    }
+    sim.setSeed(info.seed);
+
+    PlayerInput input;
+    std::chrono::duration<double> stepTime(0);
+    while (replay.next(input))
+    {
+        auto stepStart = std::chrono::steady_clock::now();
+        sim.step(input);
+        stepTime += std::chrono::steady_clock::now() - stepStart;
+        sim.clearEvents();
+    }
+
+    std::cout << "session:          " << path << " (seed " << info.seed << ", "
+              << (info.environment.empty() ? "no world" : info.environment) << ")\n";
+    std::cout << "threads:          " << jobs.getThreadCount() << (jobs.isDeterministic() ? " (deterministic)" : "") << "\n";
+    std::cout << "ticks replayed:   " << replay.getTicks() << "\n";
+    std::cout << "kills:            " << sim.player.kills << "\n";
+    std::cout << "health:           " << sim.player.health << "\n";
+    std::cout << "survival (s):     " << sim.time << "\n";
+    std::cout << "checksum:         " << std::hex << stateChecksum(sim) << std::dec << "\n";
+    std::cout << "step time (ms):   " << stepTime.count() * 1000.0 / std::max(1ull, replay.getTicks()) << " per tick" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Reads a whole command line argument as a number in a range.
+ *
+ * @param text argument.
+ * @param min smallest allowed value.
+ * @param max largest allowed value.
+ * @param value set to the number.
+ * @return true if the argument is a number (and nothing else) in the range, else false.
+ */
+template <typename T>
+static bool parseNumber(const char *text, T min, T max, T &value)
+{
+    char *end = nullptr;
+    double number = std::is_integral<T>::value ? static_cast<double>(std::strtoll(text, &end, 10)) : std::strtod(text, &end);
+    if (end == text || *end != '\0' || !(number >= static_cast<double>(min) && number <= static_cast<double>(max)))
+    {
+        return false;
+    }
+    value = static_cast<T>(number);
+    return true;
+}
+
+/// Prints how drone-sim is used.
+static void printUsage()
+{
+    std::cout << "Usage: drone-sim [matches] [max seconds per match] [drones] [threads] [deterministic] [seed]\n"
+              << "       drone-sim --record <file> [same options as above]\n"
+              << "       drone-sim --replay <file> [threads] [deterministic]" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+    PROFILE_THREAD("main");
+    std::string mode = argc > 2 ? argv[1] : "";
+    if (mode == "--replay")
+    {
+        int threads = 0;
+        int deterministic = 0;
+        if ((argc > 3 && !parseNumber(argv[3], 0, 1024, threads)) || (argc > 4 && !parseNumber(argv[4], 0, 1, deterministic)) || argc > 5)
+        {
+            printUsage();
+            return 1;
+        }
+        int result = replaySession(argv[2], threads, deterministic != 0);
+        PROFILE_SAVE("drone_sim_profile.json");
+        return result;
+    }
+
+    // skip "--record <file>" so the other options are in the same place
+    std::string recordPath;
+    if (mode == "--record")
+    {
+        recordPath = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+
+    // every option has to be a number in its range, otherwise the averages below make no sense
+    int matches = 100;
+    float maxSeconds = 300.0f;
+    int drones = Simulation::MAX_DRONES;
+    int threads = 0;
+    int deterministic = 0;
+    unsigned int seed = randomSeed();
+    bool valid = argc <= 7;
+    valid = valid && (argc <= 1 || parseNumber(argv[1], 1, 1000000, matches));
+    valid = valid && (argc <= 2 || (parseNumber(argv[2], 0.0f, 1.0e6f, maxSeconds) && maxSeconds > 0.0f));
+    valid = valid && (argc <= 3 || parseNumber(argv[3], 1, 1000000, drones));
+    valid = valid && (argc <= 4 || parseNumber(argv[4], 0, 1024, threads));
+    valid = valid && (argc <= 5 || parseNumber(argv[5], 0, 1, deterministic));
+    valid = valid && (argc <= 6 || parseNumber(argv[6], 0u, 4294967295u, seed));
+    if (!valid)
+    {
+        printUsage();
+        return 1;
+    }
+
+    JobSystem jobs(threads, deterministic != 0);
+    Simulation sim(drones, drones > Simulation::MAX_DRONES ? 0.0f : Simulation::SPAWN_INTERVAL);
+    sim.setJobSystem(&jobs);
+    unsigned long long totalTicks = 0;
+    long long totalKills = 0;
+    float totalSurvival = 0.0f;
+
+    InputRecorder recorder;
+    std::chrono::duration<double> stepTime(0); // time spent in the simulation itself (without the bot)
+    auto start = std::chrono::steady_clock::now();
+    for (int match = 0; match < matches; match++)
+    {
+        sim.setSeed(seed + match);
+        if (match == 0 && !recordPath.empty())
+        {
+            SessionInfo info;
+            info.seed = sim.getSeed();
+            info.maxDrones = sim.maxDrones;
+            info.spawnInterval = sim.spawnInterval;
+            info.ticksPerSecond = static_cast<int>(std::lround(1.0f / Simulation::TIMESTEP));
+            recorder.open(recordPath, info);
+        }
+
+        Bot bot;
+        while (sim.player.isAlive && sim.time < maxSeconds)
+        {
+            PlayerInput input = botInput(bot, sim);
+            recorder.record(input);
+            auto stepStart = std::chrono::steady_clock::now();
+            sim.step(input);
+            stepTime += std::chrono::steady_clock::now() - stepStart;
+            sim.clearEvents();
+        }
+        if (match == 0 && recorder.isOpen())
+        {
+            std::cout << "recorded " << recorder.getTicks() << " ticks to " << recordPath
+                      << " (checksum " << std::hex << stateChecksum(sim) << std::dec << ")\n";
+            recorder.close();
+        }
+        totalTicks += sim.tick;
+        totalKills += sim.player.kills;
+        totalSurvival += sim.time;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "matches:          " << matches << "\n";
+    std::cout << "drones:           " << drones << "\n";
+    std::cout << "threads:          " << jobs.getThreadCount() << (jobs.isDeterministic() ? " (deterministic)" : "") << "\n";
+    std::cout << "seed:             " << seed << "\n";
+    std::cout << "avg kills:        " << static_cast<double>(totalKills) / matches << "\n";
+    std::cout << "avg survival (s): " << totalSurvival / matches << "\n";
+    std::cout << "ticks simulated:  " << totalTicks << "\n";
+    std::cout << "wall time (s):    " << elapsed.count() << "\n";
+    std::cout << "ticks per second: " << totalTicks / elapsed.count() << "\n";
+    std::cout << "step time (ms):   " << stepTime.count() * 1000.0 / totalTicks << " per tick" << std::endl;
+    PROFILE_SAVE("drone_sim_profile.json");
+    return 0;
+}
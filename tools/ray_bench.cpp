@@ -0,0 +1,92 @@
+/// === Ray vs bounding box micro-benchmark === ///
+/// Casts random rays against random boxes and finds the nearest hit per ray in three ways:
+/// AABBox::intersect on an array of boxes (the original scalar path), the batched kernel without SIMD
+/// and the batched kernel with SIMD (see ray_batch.h). Checks that all three agree and prints the timings.
+/// Usage: ray-bench [boxes] [rays]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "box.h"
+#include "ray_batch.h"
+#include "ray_scene.h"
+
+/**
+ * @brief Runs a nearest hit function for every ray and measures how long it takes.
+ *
+ * @param name name shown in the output.
+ * @param rays rays to cast.
+ * @param length max distance per ray.
+ * @param boxCount number of boxes per ray.
+ * @param hits set to the nearest box per ray (-1 if none).
+ * @param nearest function (ray, length, distance) returning the nearest box.
+ * @return double nanoseconds per ray vs box test.
+ */
+template <typename Function>
+static double run(const char *name, const std::vector<Ray> &rays, float length, int boxCount, std::vector<int> &hits, Function nearest)
+{
+    hits.assign(rays.size(), -1);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rays.size(); r++)
+    {
+        float distance;
+        hits[r] = nearest(rays[r], length, distance);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double ns = seconds * 1e9 / (static_cast<double>(rays.size()) * boxCount);
+    std::cout << name << ": " << seconds * 1000.0 << " ms (" << ns << " ns per test)" << std::endl;
+    return ns;
+}
+
+int main(int argc, char *argv[])
+{
+    int boxCount = argc > 1 ? std::max(1, atoi(argv[1])) : 4096;
+    int rayCount = argc > 2 ? std::max(1, atoi(argv[2])) : 4096;
+    const float length = 40.0f;
+
+    // boxes the size of drones scattered over the map, rays from random points in random directions
+    std::vector<AABBox> boxes;
+    std::vector<float> bounds;
+    std::vector<Ray> rays;
+    createBoxesAndRays(boxCount, rayCount, boxes, bounds, rays);
+    const BoxArrays arrays = {&bounds[0], &bounds[boxCount], &bounds[2 * boxCount],
+                              &bounds[3 * boxCount], &bounds[4 * boxCount], &bounds[5 * boxCount]};
+
+    std::cout << boxCount << " boxes, " << rayCount << " rays, SIMD: " << rayBatchInstructionSet() << std::endl;
+
+    std::vector<int> aosHits, scalarHits, simdHits;
+    double aos = run("AABBox::intersect  ", rays, length, boxCount, aosHits, [&](const Ray &ray, float maxDistance, float &distance)
+                     {
+                         int best = -1;
+                         float t;
+                         for (int i = 0; i < boxCount; i++)
+                         {
+                             if (boxes[i].intersect(ray, maxDistance, t) && (best < 0 || t < maxDistance))
+                             {
+                                 best = i;
+                                 maxDistance = t;
+                                 distance = t;
+                             }
+                         }
+                         return best; });
+    double scalar = run("batch (scalar)     ", rays, length, boxCount, scalarHits, [&](const Ray &ray, float maxDistance, float &distance)
+                        { return nearestRayHitScalar(ray, arrays, 0, boxCount, maxDistance, distance); });
+    double simd = run("batch (SIMD)       ", rays, length, boxCount, simdHits, [&](const Ray &ray, float maxDistance, float &distance)
+                      { return nearestRayHit(ray, arrays, 0, boxCount, maxDistance, distance); });
+
+    // the batch kernels must agree exactly, the branchy original may differ on boxes that are hit at the same distance
+    int mismatches = 0;
+    int aosMismatches = 0;
+    for (int r = 0; r < rayCount; r++)
+    {
+        mismatches += scalarHits[r] != simdHits[r];
+        aosMismatches += aosHits[r] != scalarHits[r];
+    }
+    std::cout << "speedup vs AABBox::intersect: " << aos / simd << "x (scalar batch: " << aos / scalar << "x)" << std::endl;
+    std::cout << "mismatches: " << mismatches << " SIMD vs scalar, " << aosMismatches << " batch vs AABBox::intersect" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}